@@ -32,10 +32,13 @@
 
 
 
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <strings.h>
 #include <time.h>
+#include <unistd.h>
 #ifdef WITH_XDIALOG
 # include <math.h>
 #endif
@@ -44,15 +47,52 @@
 #include <gdk/gdkkeysyms.h>
 #include "callbacks.h"
 #include "common.h"
+#include "exec.h"
+#include "feed.h"
+#include "gaugeparser.h"
+#include "gaugepipe.h"
+#include "gaugeshm.h"
+#include "gaugewatch.h"
 #include "builders.h"
+#include "menuindex.h"
+#include "menumodel.h"
+#include "output.h"
+#include "reader.h"
+#include "textmap.h"
 
 #ifndef MIN
 # define MIN(a, b) ((a) <= (b) ? (a) : (b))
 #endif
 
+/* rows inserted or deleted at most while filtering, before detaching the view */
+#define MENU_FILTER_CHANGES	65536
+/* lists with at least this many items are always in large-list mode */
+#define MENU_LARGE_LIST		10000
+/* number of rows sampled to size the columns in large-list mode */
+#define MENU_LARGE_SAMPLE	256
+/* fields read at once from a memory-mapped list of items */
+#define MENU_STREAM_FIELDS	4096
+/* minimum size of the buffers for lists of items read from pipes */
+#define MENU_STREAM_BLOCK	65536
+/* rate of the updates without a frame clock */
+#define FRAME_RATE		60
+/* regular files from this size are mapped and shown partially */
+#define TEXTBOX_MAP_SIZE	(4 * 1024 * 1024)
+/* lines in the buffer, and added or removed at once when scrolling */
+#define TEXTBOX_MAP_LINES	1024
+#define TEXTBOX_MAP_SHIFT	256
+
 
 /* builders */
 /* types */
+struct checklist_data
+{
+	MenuModel * model;
+	GtkWidget * view;
+	GtkWidget * menu;
+	int anchor;		/* the last item toggled */
+};
+
 struct confopt_data
 {
 	struct bsddialog_conf const * conf;
@@ -66,6 +106,12 @@ struct datebox_data
 	GtkWidget * year;
 };
 
+struct frame_data
+{
+	GSourceFunc callback;
+	gpointer data;
+};
+
 struct gauge_data
 {
 	struct options const * opt;
@@ -73,9 +119,17 @@ struct gauge_data
 	GtkWidget * label;
 	GtkWidget * widget;	/* progress bar */
 	guint id;
-	int state;		/* -1 uninitialized, 0 initialized,
-				    1 percentage read, 2 text,
-				    3 text (continued) */
+	GaugeParser * parser;
+	unsigned int changes;	/* not rendered yet */
+	guint frame;
+	struct gaugeshm * shm;
+	uint32_t sequence;	/* last rendered from shm */
+	GaugePipe * pipe;
+	GaugeWatch * watch;
+	Exec * exec;
+	gboolean eof;		/* the command completed */
+	GIOChannel * channel;
+	GIOChannel * output;	/* only with pipe */
 };
 
 struct infobox_data
@@ -84,6 +138,70 @@ struct infobox_data
 	guint id;
 };
 
+struct menubatch_data
+{
+	int selected;
+	GList * expanded;	/* the paths of the rows expanded */
+};
+
+struct menufilter_data
+{
+	struct options const * opt;
+	MenuModel * model;
+	GtkWidget * view;
+	GtkWidget * entry;
+	MenuIndex * index;
+};
+
+struct menustream_data
+{
+	struct options const * opt;
+	MenuModel * model;
+	GtkWidget * view;
+	struct menufilter_data * filter;
+
+	/* records */
+	int j;
+	gboolean set;
+	gboolean treeview;
+	char const ** fields;
+	int nfields;
+	int delimiter;		/* -1 until known */
+
+	int fd;
+	gboolean close;
+	guint id;
+
+	/* regular files */
+	char * map;
+	size_t mapsize;
+	size_t pos;
+	GStringChunk * strings;
+
+	/* pipes */
+	GIOChannel * channel;
+	GPtrArray * blocks;
+	char * block;
+	size_t blocksize;
+	size_t blocklen;
+	size_t blockpos;
+};
+
+struct mixedgauge_data
+{
+	struct options const * opt;
+	GtkWidget * dialog;
+	GtkWidget * items;
+	GPtrArray * labels;
+	GPtrArray * bars;
+	GtkWidget * label;
+	GtkWidget * widget;	/* main progress bar */
+	guint id;
+	GaugeParser * parser;
+	unsigned int changes;	/* not rendered yet */
+	guint frame;
+};
+
 struct pause_data
 {
 	GtkWidget * dialog;
@@ -93,14 +211,6 @@ struct pause_data
 	guint id;
 };
 
-struct radiolist_data
-{
-	int depth;
-	GtkTreeIter * parent;
-	GtkTreeIter * pparent;
-	char const * name;
-};
-
 struct textbox_data
 {
 	struct options const * opt;
@@ -112,13 +222,25 @@ struct textbox_data
 #endif
 
 	char const * filename;
-	int fd;
+	Exec * exec;
+	gboolean eof;		/* the command completed */
 	GtkWidget * dialog;
 	GtkWidget * view;
 	GtkTextBuffer * buffer;
 	GtkTextIter iter;
 	guint id;
-	GIOChannel * channel;
+	Reader * reader;
+	gboolean done;		/* everything was read */
+	Feed * feed;		/* read but not inserted yet */
+	guint frame;
+
+	/* mapped files */
+	TextMap * map;
+	size_t first;		/* lines in the buffer */
+	size_t last;
+	GtkTextMark * top;
+	int jump;		/* to either end of the file */
+	gboolean truncated;
 
 #ifdef WITH_XDIALOG
 	/* printing */
@@ -138,43 +260,6 @@ struct timebox_data
 };
 
 
-/* constants */
-enum CHECKLIST_TREE_STORE
-{
-	CTS_PREFIX = 0,
-	CTS_SET,
-	CTS_DEPTH,
-	CTS_NAME,
-	CTS_DESCRIPTION,
-	CTS_TOOLTIP
-};
-# define CTS_LAST CTS_TOOLTIP
-# define CTS_COUNT (CTS_LAST + 1)
-
-enum MENU_TREE_STORE
-{
-	MTS_PREFIX = 0,
-	MTS_DEPTH,
-	MTS_NAME,
-	MTS_DESCRIPTION,
-	MTS_TOOLTIP
-};
-# define MTS_LAST MTS_TOOLTIP
-# define MTS_COUNT (MTS_LAST + 1)
-
-enum RADIOLIST_TREE_STORE
-{
-	RTS_PREFIX = 0,
-	RTS_SET,
-	RTS_DEPTH,
-	RTS_NAME,
-	RTS_DESCRIPTION,
-	RTS_TOOLTIP
-};
-# define RTS_LAST RTS_TOOLTIP
-# define RTS_COUNT (RTS_LAST + 1)
-
-
 /* prototypes */
 static GtkWidget * _builder_dialog(struct bsddialog_conf const * conf,
 		struct options const * opt, char const * text,
@@ -185,12 +270,47 @@ static void _builder_dialog_buttons(GtkWidget * dialog,
 static int _builder_dialog_error(GtkWidget * parent,
 		struct bsddialog_conf const * conf, struct options const * opt,
 		char const * error);
+static Exec * _builder_dialog_exec(char const * command, gboolean errors,
+		struct options const * opt, GError ** error);
+static int _builder_dialog_exec_wait(Exec * exec, gboolean eof, int ret);
+static guint _builder_dialog_frame(GtkWidget * widget, GSourceFunc callback,
+		gpointer data);
+static void _builder_dialog_frame_cancel(GtkWidget * widget, guint id);
 static int _builder_dialog_help(GtkWidget * parent,
 		struct bsddialog_conf const * conf,
 		struct options const * opt);
+static void _builder_dialog_menu_batch(GtkWidget * view, MenuModel * model,
+		struct menubatch_data * mb);
+static void _builder_dialog_menu_batch_end(GtkWidget * view, MenuModel * model,
+		struct menubatch_data * mb);
+static void _builder_dialog_menu_expand(GtkWidget * view, MenuModel * model,
+		struct options const * opt, int selected);
+static struct menufilter_data * _builder_dialog_menu_filter(
+		GtkWidget * container, GtkWidget * view, MenuModel * model,
+		struct menustream_data * stream, struct options const * opt);
+static void _builder_dialog_menu_filter_delete(struct menufilter_data * mf);
+static void _builder_dialog_menu_focus(GtkTreeSelection * treesel,
+		MenuModel * model, int * focusitem);
+static void _builder_dialog_menu_item(struct options const * opt,
+		struct bsddialog_menuitem * item, char const ** argv,
+		gboolean set, gboolean treeview);
+static struct bsddialog_menuitem * _builder_dialog_menu_items_new(
+		struct options const * opt, int argc, char const ** argv,
+		int j, gboolean set, gboolean treeview);
+static void _builder_dialog_menu_large(GtkWidget * view, MenuModel * model,
+		struct options const * opt);
 static int _builder_dialog_menu_output(struct options const * opt,
-		GtkTreeSelection * treesel, GtkTreeModel * model,
-		unsigned int id, char const * prefix);
+		char const * name, char const * prefix);
+static struct menustream_data * _builder_dialog_menu_stream(
+		struct bsddialog_conf const * conf, struct options const * opt,
+		MenuModel * model, int j, gboolean set, gboolean treeview);
+static void _builder_dialog_menu_stream_delete(struct menustream_data * ms);
+static void _builder_dialog_menu_tooltip(GtkWidget * view);
+static void _builder_dialog_menu_view(GtkWidget * view, MenuModel * model,
+		struct menustream_data * stream, struct options const * opt,
+		int * focusitem);
+static void _builder_dialog_progress(GtkWidget * widget, gdouble fraction,
+		char const * text);
 static int _builder_dialog_run(struct bsddialog_conf const * conf,
 		GtkWidget * dialog);
 
@@ -204,10 +324,7 @@ int builder_calendar(struct bsddialog_conf const * conf,
 		int argc, char const ** argv, struct options const * opt)
 {
 	int ret;
-	GtkWidget * dialog;
-	GtkWidget * container;
-	GtkWidget * widget;
-	guint year, month, day;
+	unsigned int year = 0, month = 0, day = 0;
 	struct tm tm;
 	char buf[1024];
 	char const * fmt = "%d/%m/%Y";
@@ -224,6 +341,40 @@ int builder_calendar(struct bsddialog_conf const * conf,
 		error_args(opt->name, argc, argv);
 		return BSDDIALOG_ERROR;
 	}
+	ret = builder_calendar_values(conf, text, rows, cols, &year, &month,
+			&day, opt);
+	switch(ret)
+	{
+		case BSDDIALOG_EXTRA:
+		case BSDDIALOG_OK:
+			if(opt->date_fmt != NULL)
+				fmt = opt->date_fmt;
+			memset(&tm, 0, sizeof(tm));
+			tm.tm_mday = day;
+			tm.tm_mon = month - 1;
+			tm.tm_year = year - 1900;
+			len = strftime(buf, sizeof(buf) - 1, fmt, &tm);
+			buf[len] = '\0';
+			if(opt->result != NULL)
+				output_value(opt->result, buf);
+			else
+				output_dprintf(opt->output_fd, "%s\n", buf);
+			break;
+	}
+	return ret;
+}
+
+int builder_calendar_values(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int * yy, unsigned int * mm, unsigned int * dd,
+		struct options const * opt)
+{
+	int ret;
+	GtkWidget * dialog;
+	GtkWidget * container;
+	GtkWidget * widget;
+	guint year, month, day;
+
 	dialog = _builder_dialog(conf, opt, text, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	container = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
@@ -231,11 +382,10 @@ int builder_calendar(struct bsddialog_conf const * conf,
 	container = dialog->vbox;
 #endif
 	widget = gtk_calendar_new();
-	if(argc == 3 && day <= 31 && month >= 1 && month <= 12 && year != 0)
+	if(*dd <= 31 && *mm >= 1 && *mm <= 12 && *yy != 0)
 	{
-		gtk_calendar_select_day(GTK_CALENDAR(widget), day);
-		gtk_calendar_select_month(GTK_CALENDAR(widget), month - 1,
-				year);
+		gtk_calendar_select_day(GTK_CALENDAR(widget), *dd);
+		gtk_calendar_select_month(GTK_CALENDAR(widget), *mm - 1, *yy);
 	}
 	if(conf->button.always_active == true)
 		g_signal_connect_swapped(widget, "day-selected-double-click",
@@ -247,21 +397,9 @@ int builder_calendar(struct bsddialog_conf const * conf,
 	ret = _builder_dialog_run(conf, dialog);
 	gtk_calendar_get_date(GTK_CALENDAR(widget), &year, &month, &day);
 	gtk_widget_destroy(dialog);
-	switch(ret)
-	{
-		case BSDDIALOG_EXTRA:
-		case BSDDIALOG_OK:
-			if(opt->date_fmt != NULL)
-				fmt = opt->date_fmt;
-			memset(&tm, 0, sizeof(tm));
-			tm.tm_mday = day;
-			tm.tm_mon = month;
-			tm.tm_year = year - 1900;
-			len = strftime(buf, sizeof(buf) - 1, fmt, &tm);
-			buf[len] = '\n';
-			write(opt->output_fd, buf, len + 1);
-			return ret;
-	}
+	*yy = year;
+	*mm = month + 1;
+	*dd = day;
 	return ret;
 }
 
@@ -274,32 +412,41 @@ static void _calendar_on_day_activated(gpointer data)
 
 
 /* builder_checklist */
-static GtkTreeIter * _checklist_get_parent(GtkTreeModel * model,
-		GtkTreeIter * iter, int depth);
+static int _builder_checklist_model(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, MenuModel * model,
+		struct menustream_data * stream, int * focusitem,
+		struct options const * opt);
+static gboolean _checklist_on_button_press(GtkWidget * widget,
+		GdkEventButton * event, gpointer data);
+static void _checklist_on_invert(gpointer data);
+static gboolean _checklist_on_key_press(GtkWidget * widget,
+		GdkEventKey * event, gpointer data);
+static gboolean _checklist_on_popup_menu(gpointer data);
 static void _checklist_on_row_activated(GtkWidget * widget, GtkTreePath * path,
 		GtkTreeViewColumn * column, gpointer data);
 static void _checklist_on_row_toggled(GtkCellRenderer * renderer, char * path,
 		gpointer data);
+static void _checklist_on_select_all(gpointer data);
+static void _checklist_on_select_none(gpointer data);
+static void _checklist_popup(struct checklist_data * cd,
+		GdkEventButton * event);
+static void _checklist_set(struct checklist_data * cd, MenuModelSet set);
+static void _checklist_toggle(struct checklist_data * cd, GtkTreeIter * iter);
 
 int builder_checklist(struct bsddialog_conf const * conf,
 		char const * text, int rows, int cols,
 		int argc, char const ** argv, struct options const * opt)
 {
 	int ret;
-	GtkWidget * dialog;
-	GtkWidget * container;
-	GtkWidget * window;
-	GtkWidget * widget;
-	GtkTreeStore * store;
-	GtkTreeIter iter, parent, * pparent = NULL;
-	GtkCellRenderer * renderer;
-	GtkTreeViewColumn * column;
-	GtkTreeSelection * treesel;
-	int i, j, k, n, depth = 0;
-	gboolean b, set, toquote;
+	struct bsddialog_menuitem * items, * mitems;
+	MenuModel * model;
+	struct menustream_data * stream = NULL;
+	unsigned int i, nitems;
+	int j, n, focus = -1;
+	gboolean toquote;
 	char quotech;
-	char const * prefix = NULL, * name, * desc, * tooltip;
-	char * p, * sep = "";
+	Output * output;
+	char * sep = "";
 
 	j = opt->item_bottomdesc ? 4 : 3;
 	if(opt->item_prefix)
@@ -319,14 +466,117 @@ int builder_checklist(struct bsddialog_conf const * conf,
 	}
 	else if(n == 0)
 		n = (argc - 1) / j;
+	if((items = _builder_dialog_menu_items_new(opt, argc - 1, argv + 1,
+					j, TRUE, FALSE)) == NULL)
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
+	if((model = menumodel_new(items, (argc - 1) / j,
+					opt->items_from != NULL
+					&& opt->item_depth)) == NULL)
+	{
+		free(items);
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
+	}
+	if(opt->items_from != NULL && (stream = _builder_dialog_menu_stream(
+					conf, opt, model, j, TRUE, FALSE))
+					== NULL)
+		ret = BSDDIALOG_ERROR;
+	else
+		ret = _builder_checklist_model(conf, text, rows, cols, model,
+				stream, &focus, opt);
+	mitems = menumodel_get_items(model);
+	nitems = menumodel_get_count(model);
+	quotech = opt->item_singlequote ? '\'' : '"';
+	switch(ret)
+	{
+		case BSDDIALOG_HELP:
+			if(focus >= 0)
+				_builder_dialog_menu_output(opt,
+						mitems[focus].name, "HELP ");
+			break;
+		case BSDDIALOG_EXTRA:
+		case BSDDIALOG_OK:
+			if(opt->result != NULL)
+			{
+				for(i = 0; i < nitems; i++)
+					if(mitems[i].on)
+						output_value(opt->result,
+								mitems[i].name);
+				break;
+			}
+			/* the result is written at once */
+			output = output_new(opt->output_fd);
+			for(i = 0; i < nitems; i++)
+			{
+				if(mitems[i].on)
+				{
+					if(opt->item_output_sepnl == FALSE)
+						toquote = TRUE;
+					else if(string_needs_quoting(
+								mitems[i].name))
+						toquote = opt->item_always_quote;
+					else
+						toquote = FALSE;
+					output_string(output, sep);
+					if(toquote)
+						output_quoted(output,
+								mitems[i].name,
+								quotech);
+					else
+						output_string(output,
+								mitems[i].name);
+				}
+				sep = (opt->item_output_sep != NULL)
+					? opt->item_output_sep
+					: (opt->item_output_sepnl ? "\n" : " ");
+			}
+			output_string(output, "\n");
+			output_delete(output);
+			break;
+	}
+	_builder_dialog_menu_stream_delete(stream);
+	g_object_unref(model);
+	free(items);
+	return ret;
+}
+
+int builder_checklist_items(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int nitems, struct bsddialog_menuitem * items,
+		int * focusitem, struct options const * opt)
+{
+	int ret;
+	MenuModel * model;
+
+	if((model = menumodel_new(items, nitems, FALSE)) == NULL)
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
+	ret = _builder_checklist_model(conf, text, rows, cols, model, NULL,
+			focusitem, opt);
+	g_object_unref(model);
+	return ret;
+}
+
+static int _builder_checklist_model(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, MenuModel * model,
+		struct menustream_data * stream, int * focusitem,
+		struct options const * opt)
+{
+	int ret;
+	GtkWidget * dialog;
+	GtkWidget * container;
+	GtkWidget * window;
+	GtkWidget * widget;
+	GtkCellRenderer * renderer;
+	GtkTreeViewColumn * column;
+	GtkTreeSelection * treesel;
+	struct menufilter_data * filter;
+	struct checklist_data cd;
+
 	dialog = _builder_dialog(conf, opt, text, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	container = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
 #else
 	container = dialog->vbox;
 #endif
-	store = gtk_tree_store_new(CTS_COUNT, G_TYPE_STRING, G_TYPE_BOOLEAN,
-			G_TYPE_INT, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
 	window = gtk_scrolled_window_new(NULL, NULL);
 	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(window),
 			GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
@@ -335,60 +585,34 @@ int builder_checklist(struct bsddialog_conf const * conf,
 				GTK_SHADOW_NONE);
 	widget = gtk_tree_view_new();
 	gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(widget), FALSE);
-	gtk_tree_view_set_model(GTK_TREE_VIEW(widget), GTK_TREE_MODEL(store));
 	if(opt->item_bottomdesc)
-		gtk_tree_view_set_tooltip_column(GTK_TREE_VIEW(widget),
-				CTS_TOOLTIP);
+		_builder_dialog_menu_tooltip(widget);
 	treesel = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
 	gtk_tree_selection_set_mode(treesel, GTK_SELECTION_BROWSE);
-	for(i = 0; (i + 1) * j < argc; i++)
-	{
-		k = i * j + 1;
-		if(opt->item_prefix)
-			prefix = argv[k++];
-		if(opt->item_depth)
-		{
-			depth = strtol(argv[k++], NULL, 10);
-#ifdef DEBUG
-			fprintf(stderr, "DEBUG: %s() depth=%d\n", __func__,
-					depth);
-#endif
-			pparent = _checklist_get_parent(GTK_TREE_MODEL(store),
-					&parent, depth);
-		}
-		name = argv[k++];
-		desc = argv[k++];
-		set = (strcasecmp(argv[k++], "on") == 0) ? TRUE : FALSE;
-		tooltip = (k < j) ? argv[k++] : NULL;
-		gtk_tree_store_append(store, &iter, pparent);
-		gtk_tree_store_set(store, &iter, CTS_PREFIX, prefix,
-				CTS_SET, set, CTS_DEPTH, depth,
-				CTS_NAME, name, CTS_DESCRIPTION, desc,
-				(tooltip != NULL) ? CTS_TOOLTIP : -1,
-				(tooltip != NULL) ? tooltip : NULL, -1);
-		if(opt->item_default != NULL
-				&& strcmp(name, opt->item_default) == 0)
-			gtk_tree_selection_select_iter(treesel, &iter);
-	}
+	_builder_dialog_menu_view(widget, model, stream, opt, focusitem);
+	cd.model = model;
+	cd.view = widget;
+	cd.menu = NULL;
+	cd.anchor = -1;
 	if(opt->item_prefix == true)
 	{
 		column = gtk_tree_view_column_new_with_attributes(NULL,
 				gtk_cell_renderer_text_new(),
-				"text", CTS_PREFIX, NULL);
+				"text", MMC_PREFIX, NULL);
 		gtk_tree_view_column_set_expand(column, FALSE);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
 	}
 	renderer = gtk_cell_renderer_toggle_new();
 	g_signal_connect(renderer, "toggled",
-			G_CALLBACK(_checklist_on_row_toggled), store);
+			G_CALLBACK(_checklist_on_row_toggled), &cd);
 	column = gtk_tree_view_column_new_with_attributes(NULL, renderer,
-			"active", CTS_SET, NULL);
+			"active", MMC_SET, NULL);
 	gtk_tree_view_column_set_expand(column, FALSE);
 	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
 	if(conf->menu.no_name == false)
 	{
 		column = gtk_tree_view_column_new_with_attributes(NULL,
-				gtk_cell_renderer_text_new(), "text", CTS_NAME,
+				gtk_cell_renderer_text_new(), "text", MMC_NAME,
 				NULL);
 		gtk_tree_view_column_set_expand(column, FALSE);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
@@ -397,125 +621,190 @@ int builder_checklist(struct bsddialog_conf const * conf,
 	{
 		column = gtk_tree_view_column_new_with_attributes(NULL,
 				gtk_cell_renderer_text_new(), "text",
-				CTS_DESCRIPTION, NULL);
+				MMC_DESCRIPTION, NULL);
 		gtk_tree_view_column_set_expand(column, TRUE);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
 	}
-	if(opt->item_depth)
-		gtk_tree_view_expand_all(GTK_TREE_VIEW(widget));
+	_builder_dialog_menu_large(widget, model, opt);
 	g_signal_connect(widget, "row-activated",
-			G_CALLBACK(_checklist_on_row_activated), NULL);
+			G_CALLBACK(_checklist_on_row_activated), &cd);
+	/* the items can be set all at once */
+	g_signal_connect(widget, "button-press-event",
+			G_CALLBACK(_checklist_on_button_press), &cd);
+	g_signal_connect(widget, "key-press-event",
+			G_CALLBACK(_checklist_on_key_press), &cd);
+	g_signal_connect_swapped(widget, "popup-menu",
+			G_CALLBACK(_checklist_on_popup_menu), &cd);
+	filter = _builder_dialog_menu_filter(container, widget, model, stream,
+			opt);
 	gtk_container_add(GTK_CONTAINER(window), widget);
 	gtk_box_pack_start(GTK_BOX(container), window, TRUE, TRUE, 0);
 	gtk_widget_show_all(window);
 	_builder_dialog_buttons(dialog, conf, opt);
 	ret = _builder_dialog_run(conf, dialog);
-	quotech = opt->item_singlequote ? '\'' : '"';
-	switch(ret)
-	{
-		case BSDDIALOG_HELP:
-			_builder_dialog_menu_output(opt, treesel,
-					GTK_TREE_MODEL(store), CTS_NAME,
-					"HELP ");
-			break;
-		case BSDDIALOG_EXTRA:
-		case BSDDIALOG_OK:
-			for(b = gtk_tree_model_get_iter_first(
-						GTK_TREE_MODEL(store), &iter);
-					b != FALSE;
-					b = gtk_tree_model_iter_next(
-						GTK_TREE_MODEL(store), &iter))
-			{
-				gtk_tree_model_get(GTK_TREE_MODEL(store), &iter,
-						CTS_SET, &set, CTS_NAME, &p,
-						-1);
-				if(set)
-				{
-					if(opt->item_output_sepnl == FALSE)
-						toquote = TRUE;
-					else if(string_needs_quoting(p))
-						toquote = opt->item_always_quote;
-					else
-						toquote = FALSE;
-					if(toquote)
-						dprintf(opt->output_fd,
-								"%s%c%s%c", sep,
-								quotech, p,
-								quotech);
-					else
-						dprintf(opt->output_fd, "%s%s",
-								sep, p);
-				}
-				free(p);
-				sep = (opt->item_output_sep != NULL)
-					? opt->item_output_sep
-					: (opt->item_output_sepnl ? "\n" : " ");
-			}
-			dprintf(opt->output_fd, "\n");
-			break;
-	}
+	_builder_dialog_menu_focus(treesel, model, focusitem);
+	_builder_dialog_menu_filter_delete(filter);
 	gtk_widget_destroy(dialog);
 	return ret;
 }
 
-static GtkTreeIter * _checklist_get_parent(GtkTreeModel * model,
-		GtkTreeIter * parent, int depth)
+static gboolean _checklist_on_button_press(GtkWidget * widget,
+		GdkEventButton * event, gpointer data)
 {
-	GtkTreeIter * ret = NULL;
-	GtkTreeIter iter;
-	gboolean b;
-	int d;
+	struct checklist_data * cd = data;
+	(void) widget;
 
-	if(depth <= 0)
-		return NULL;
-	for(b = gtk_tree_model_get_iter_first(model, &iter); b == TRUE;
-			b = gtk_tree_model_iter_next(model, &iter))
+	if(event->type != GDK_BUTTON_PRESS || event->button != 3)
+		return FALSE;
+	_checklist_popup(cd, event);
+	return TRUE;
+}
+
+static void _checklist_on_invert(gpointer data)
+{
+	struct checklist_data * cd = data;
+
+	_checklist_set(cd, MMS_INVERT);
+}
+
+static gboolean _checklist_on_key_press(GtkWidget * widget,
+		GdkEventKey * event, gpointer data)
+{
+	struct checklist_data * cd = data;
+	(void) widget;
+
+	if((event->state & GDK_CONTROL_MASK) == 0)
+		return FALSE;
+	switch(event->keyval)
 	{
-		gtk_tree_model_get(model, &iter, CTS_DEPTH, &d, -1);
-		if(d < depth)
-		{
-			*parent = iter;
-			ret = parent;
-		}
+		case GDK_KEY_a:
+			_checklist_set(cd, MMS_SET);
+			return TRUE;
+		case GDK_KEY_A:
+			_checklist_set(cd, MMS_UNSET);
+			return TRUE;
+		case GDK_KEY_i:
+			_checklist_set(cd, MMS_INVERT);
+			return TRUE;
 	}
-	return ret;
+	return FALSE;
+}
+
+static gboolean _checklist_on_popup_menu(gpointer data)
+{
+	struct checklist_data * cd = data;
+
+	_checklist_popup(cd, NULL);
+	return TRUE;
 }
 
 static void _checklist_on_row_activated(GtkWidget * widget, GtkTreePath * path,
 		GtkTreeViewColumn * column, gpointer data)
 {
-	GtkTreeModel * model;
+	struct checklist_data * cd = data;
 	GtkTreeIter iter;
-	gboolean set;
+	(void) widget;
 	(void) column;
-	(void) data;
 
-	model = gtk_tree_view_get_model(GTK_TREE_VIEW(widget));
-	if(gtk_tree_model_get_iter(model, &iter, path) == FALSE)
-		return;
-	gtk_tree_model_get(model, &iter, CTS_SET, &set, -1);
-	gtk_tree_store_set(GTK_TREE_STORE(model), &iter,
-			CTS_SET, set ? FALSE : TRUE, -1);
+	if(gtk_tree_model_get_iter(GTK_TREE_MODEL(cd->model), &iter, path))
+		_checklist_toggle(cd, &iter);
 }
 
 static void _checklist_on_row_toggled(GtkCellRenderer * renderer, char * path,
 		gpointer data)
 {
-	GtkTreeStore * store = data;
+	struct checklist_data * cd = data;
 	GtkTreePath * tp;
 	GtkTreeIter iter;
 	gboolean b;
+	(void) renderer;
 
 	if((tp = gtk_tree_path_new_from_string(path)) == NULL)
 		return;
-	b = gtk_tree_model_get_iter(GTK_TREE_MODEL(store), &iter, tp);
+	b = gtk_tree_model_get_iter(GTK_TREE_MODEL(cd->model), &iter, tp);
 	gtk_tree_path_free(tp);
 	if(b == FALSE)
 		return;
-	gtk_tree_store_set(store, &iter, CTS_SET,
-			gtk_cell_renderer_toggle_get_active(
-				GTK_CELL_RENDERER_TOGGLE(renderer))
-			? FALSE : TRUE, -1);
+	_checklist_toggle(cd, &iter);
+}
+
+static void _checklist_on_select_all(gpointer data)
+{
+	struct checklist_data * cd = data;
+
+	_checklist_set(cd, MMS_SET);
+}
+
+static void _checklist_on_select_none(gpointer data)
+{
+	struct checklist_data * cd = data;
+
+	_checklist_set(cd, MMS_UNSET);
+}
+
+static void _checklist_popup(struct checklist_data * cd,
+		GdkEventButton * event)
+{
+	GtkWidget * widget;
+
+	if(cd->menu == NULL)
+	{
+		cd->menu = gtk_menu_new();
+		widget = gtk_menu_item_new_with_mnemonic("Select _all");
+		g_signal_connect_swapped(widget, "activate",
+				G_CALLBACK(_checklist_on_select_all), cd);
+		gtk_menu_shell_append(GTK_MENU_SHELL(cd->menu), widget);
+		widget = gtk_menu_item_new_with_mnemonic("Select _none");
+		g_signal_connect_swapped(widget, "activate",
+				G_CALLBACK(_checklist_on_select_none), cd);
+		gtk_menu_shell_append(GTK_MENU_SHELL(cd->menu), widget);
+		widget = gtk_menu_item_new_with_mnemonic("_Invert selection");
+		g_signal_connect_swapped(widget, "activate",
+				G_CALLBACK(_checklist_on_invert), cd);
+		gtk_menu_shell_append(GTK_MENU_SHELL(cd->menu), widget);
+		gtk_widget_show_all(cd->menu);
+		/* the menu is destroyed along with the view */
+		gtk_menu_attach_to_widget(GTK_MENU(cd->menu), cd->view, NULL);
+	}
+#if GTK_CHECK_VERSION(3, 22, 0)
+	gtk_menu_popup_at_pointer(GTK_MENU(cd->menu), (GdkEvent *)event);
+#else
+	gtk_menu_popup(GTK_MENU(cd->menu), NULL, NULL, NULL, NULL,
+			(event != NULL) ? event->button : 0,
+			gtk_get_current_event_time());
+#endif
+}
+
+static void _checklist_set(struct checklist_data * cd, MenuModelSet set)
+{
+	struct menubatch_data mb;
+
+	_builder_dialog_menu_batch(cd->view, cd->model, &mb);
+	menumodel_set_range(cd->model, NULL, NULL, set);
+	_builder_dialog_menu_batch_end(cd->view, cd->model, &mb);
+}
+
+static void _checklist_toggle(struct checklist_data * cd, GtkTreeIter * iter)
+{
+	GdkModifierType state;
+	GtkTreeIter anchor;
+	gboolean set;
+	struct menubatch_data mb;
+
+	set = menumodel_get_set(cd->model, iter) ? FALSE : TRUE;
+	/* with shift, the items from the last one toggled are set alike */
+	if(gtk_get_current_event_state(&state) && (state & GDK_SHIFT_MASK)
+			&& cd->anchor >= 0
+			&& menumodel_get_iter(cd->model, &anchor, cd->anchor))
+	{
+		_builder_dialog_menu_batch(cd->view, cd->model, &mb);
+		menumodel_set_range(cd->model, &anchor, iter,
+				set ? MMS_SET : MMS_UNSET);
+		_builder_dialog_menu_batch_end(cd->view, cd->model, &mb);
+	}
+	else
+		menumodel_set(cd->model, iter, set);
+	cd->anchor = menumodel_get_index(cd->model, iter);
 }
 
 
@@ -527,14 +816,7 @@ int builder_datebox(struct bsddialog_conf const * conf,
 		int argc, char const ** argv, struct options const * opt)
 {
 	int ret;
-	struct datebox_data dd = { NULL, NULL, NULL };
-	GtkWidget * dialog;
-	GtkWidget * container;
-	GtkWidget * box;
-	GtkListStore * months;
-	GtkCellRenderer * renderer;
-	GtkTreeIter iter;
-	guint i, year, month, day;
+	unsigned int year, month, day;
 	time_t t;
 	struct tm tm;
 	char buf[1024];
@@ -563,7 +845,47 @@ int builder_datebox(struct bsddialog_conf const * conf,
 		month = tm.tm_mon + 1;
 		year = tm.tm_year + 1900;
 	}
-	dialog = _builder_dialog(conf, opt, text, rows, cols);
+	ret = builder_datebox_values(conf, text, rows, cols, &year, &month,
+			&day, opt);
+	switch(ret)
+	{
+		case BSDDIALOG_EXTRA:
+		case BSDDIALOG_OK:
+			if(opt->date_fmt != NULL)
+				fmt = opt->date_fmt;
+			memset(&tm, 0, sizeof(tm));
+			tm.tm_mday = day;
+			tm.tm_mon = month - 1;
+			tm.tm_year = year - 1900;
+			len = strftime(buf, sizeof(buf) - 1, fmt, &tm);
+			buf[len] = '\0';
+			if(opt->result != NULL)
+				output_value(opt->result, buf);
+			else
+				output_dprintf(opt->output_fd, "%s\n", buf);
+			break;
+	}
+	return ret;
+}
+
+int builder_datebox_values(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int * yy, unsigned int * mm, unsigned int * dd,
+		struct options const * opt)
+{
+	int ret;
+	struct datebox_data data = { NULL, NULL, NULL };
+	GtkWidget * dialog;
+	GtkWidget * container;
+	GtkWidget * box;
+	GtkListStore * months;
+	GtkCellRenderer * renderer;
+	GtkTreeIter iter;
+	guint i;
+	struct tm tm;
+	char buf[1024];
+
+	dialog = _builder_dialog(conf, opt, text, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	container = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
 #else
@@ -576,15 +898,16 @@ int builder_datebox(struct bsddialog_conf const * conf,
 #endif
 	gtk_box_pack_start(GTK_BOX(box),
 			gtk_label_new("Day: "), FALSE, TRUE, 0);
-	dd.day = gtk_spin_button_new_with_range(1.0, 31.0, 1.0);
-	gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(dd.day), TRUE);
-	gtk_spin_button_set_value(GTK_SPIN_BUTTON(dd.day), (gdouble)day);
+	data.day = gtk_spin_button_new_with_range(1.0, 31.0, 1.0);
+	gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(data.day), TRUE);
+	gtk_spin_button_set_value(GTK_SPIN_BUTTON(data.day), (gdouble)*dd);
 	if(conf->button.always_active == true)
-		gtk_entry_set_activates_default(GTK_ENTRY(dd.day), TRUE);
-	gtk_box_pack_start(GTK_BOX(box), dd.day, TRUE, TRUE, 0);
+		gtk_entry_set_activates_default(GTK_ENTRY(data.day), TRUE);
+	gtk_box_pack_start(GTK_BOX(box), data.day, TRUE, TRUE, 0);
 	gtk_box_pack_start(GTK_BOX(box),
 			gtk_label_new("Month: "), FALSE, TRUE, 0);
 	months = gtk_list_store_new(2, G_TYPE_LONG, G_TYPE_STRING);
+	memset(&tm, 0, sizeof(tm));
 	for(i = 0; i < 12; i++)
 	{
 		tm.tm_mon = i;
@@ -592,45 +915,30 @@ int builder_datebox(struct bsddialog_conf const * conf,
 		gtk_list_store_append(months, &iter);
 		gtk_list_store_set(months, &iter, 0, i, 1, buf, -1);
 	}
-	dd.month = gtk_combo_box_new_with_model(GTK_TREE_MODEL(months));
+	data.month = gtk_combo_box_new_with_model(GTK_TREE_MODEL(months));
 	renderer = gtk_cell_renderer_text_new();
-	gtk_cell_layout_pack_start(GTK_CELL_LAYOUT(dd.month), renderer, TRUE);
-	gtk_cell_layout_set_attributes(GTK_CELL_LAYOUT(dd.month), renderer,
+	gtk_cell_layout_pack_start(GTK_CELL_LAYOUT(data.month), renderer, TRUE);
+	gtk_cell_layout_set_attributes(GTK_CELL_LAYOUT(data.month), renderer,
 			"text", 1, NULL);
-	gtk_combo_box_set_active(GTK_COMBO_BOX(dd.month), month - 1);
-	gtk_box_pack_start(GTK_BOX(box), dd.month, TRUE, TRUE, 0);
+	gtk_combo_box_set_active(GTK_COMBO_BOX(data.month), *mm - 1);
+	gtk_box_pack_start(GTK_BOX(box), data.month, TRUE, TRUE, 0);
 	gtk_box_pack_start(GTK_BOX(box),
 			gtk_label_new("Year: "), FALSE, TRUE, 0);
-	dd.year = gtk_spin_button_new_with_range(-9999.0, 9999.0, 1.0);
-	gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(dd.year), TRUE);
-	gtk_spin_button_set_value(GTK_SPIN_BUTTON(dd.year), (gdouble)year);
+	data.year = gtk_spin_button_new_with_range(-9999.0, 9999.0, 1.0);
+	gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(data.year), TRUE);
+	gtk_spin_button_set_value(GTK_SPIN_BUTTON(data.year), (gdouble)*yy);
 	if(conf->button.always_active == true)
-		gtk_entry_set_activates_default(GTK_ENTRY(dd.year), TRUE);
-	g_signal_connect(dd.year, "value-changed",
+		gtk_entry_set_activates_default(GTK_ENTRY(data.year), TRUE);
+	g_signal_connect(data.year, "value-changed",
 			G_CALLBACK(_datebox_on_year_value_changed), NULL);
-	gtk_box_pack_start(GTK_BOX(box), dd.year, TRUE, TRUE, 0);
+	gtk_box_pack_start(GTK_BOX(box), data.year, TRUE, TRUE, 0);
 	gtk_widget_show_all(box);
 	gtk_container_add(GTK_CONTAINER(container), box);
 	_builder_dialog_buttons(dialog, conf, opt);
 	ret = _builder_dialog_run(conf, dialog);
-	switch(ret)
-	{
-		case BSDDIALOG_EXTRA:
-		case BSDDIALOG_OK:
-			if(opt->date_fmt != NULL)
-				fmt = opt->date_fmt;
-			memset(&tm, 0, sizeof(tm));
-			tm.tm_mday = gtk_spin_button_get_value_as_int(
-					GTK_SPIN_BUTTON(dd.day));
-			tm.tm_mon = gtk_combo_box_get_active(GTK_COMBO_BOX(
-						dd.month));
-			tm.tm_year = gtk_spin_button_get_value_as_int(
-					GTK_SPIN_BUTTON(dd.year)) - 1900;
-			len = strftime(buf, sizeof(buf) - 1, fmt, &tm);
-			buf[len] = '\n';
-			write(opt->output_fd, buf, len + 1);
-			break;
-	}
+	*dd = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(data.day));
+	*mm = gtk_combo_box_get_active(GTK_COMBO_BOX(data.month)) + 1;
+	*yy = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(data.year));
 	gtk_widget_destroy(dialog);
 	return ret;
 }
@@ -645,34 +953,54 @@ static void _datebox_on_year_value_changed(GtkWidget * widget)
 
 
 /* builder_form */
-static void _form_foreach_buffer(gpointer e, gpointer data);
+static struct bsddialog_formitem * _form_items_new(int argc,
+		char const ** argv, int j);
+static void _form_output(struct options const * opt, int ret,
+		unsigned int nitems, struct bsddialog_formitem * items);
 
 int builder_form(struct bsddialog_conf const * conf,
 		char const * text, int rows, int cols,
 		int argc, char const ** argv, struct options const * opt)
 {
 	int ret;
-	GtkWidget * dialog;
-	GtkWidget * container;
-	GtkWidget * box;
-	GtkWidget * widget;
-	GtkEntryBuffer * buffer;
-	GtkSizeGroup * group;
-	int i, k, n, fieldlen, maxletters;
-	GSList * l = NULL;
+	struct bsddialog_formitem * items;
 	const int j = 8;
 
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s(%d)\n", __func__, argc);
 #endif
-	if(argc < 1 || (n = strtol(argv[0], NULL, 10)) < 0
+	if(argc < 1 || strtol(argv[0], NULL, 10) < 0
 			|| ((argc - 1) % j) != 0)
 	{
 		error_args(opt->name, argc, argv);
 		return BSDDIALOG_ERROR;
 	}
-	else if(n == 0)
-		n = (argc - 1) / j;
+	if((items = _form_items_new(argc - 1, argv + 1, j)) == NULL)
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
+	ret = builder_form_items(conf, text, rows, cols, (argc - 1) / j, items,
+			opt);
+	_form_output(opt, ret, (argc - 1) / j, items);
+	free(items);
+	return ret;
+}
+
+int builder_form_items(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int nitems, struct bsddialog_formitem * items,
+		struct options const * opt)
+{
+	int ret;
+	GtkWidget * dialog;
+	GtkWidget * container;
+	GtkWidget * box;
+	GtkWidget * widget;
+	GtkEntryBuffer ** buffers;
+	GtkSizeGroup * group;
+	unsigned int i, maxletters;
+	char const * p;
+
+	if((buffers = malloc(sizeof(*buffers) * (nitems + 1))) == NULL)
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
 	group = gtk_size_group_new(GTK_SIZE_GROUP_BOTH);
 	dialog = _builder_dialog(conf, opt, text, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
@@ -681,15 +1009,16 @@ int builder_form(struct bsddialog_conf const * conf,
 	container = dialog->vbox;
 #endif
 	gtk_box_set_spacing(GTK_BOX(container), BORDER_WIDTH);
-	for(i = 0; (i + 1) * j < argc; i++)
+	for(i = 0; i < nitems; i++)
 	{
-		k = i * j + 1;
 #if GTK_CHECK_VERSION(3, 0, 0)
 		box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, BORDER_WIDTH);
 #else
 		box = gtk_hbox_new(FALSE, BORDER_WIDTH);
 #endif
-		widget = gtk_label_new(argv[k]);
+		gtk_container_add(GTK_CONTAINER(container), box);
+		/* label */
+		widget = gtk_label_new(items[i].label);
 #if GTK_CHECK_VERSION(3, 14, 0)
 		gtk_widget_set_halign(widget, opt->halign);
 #else
@@ -700,70 +1029,131 @@ int builder_form(struct bsddialog_conf const * conf,
 #endif
 		gtk_size_group_add_widget(group, widget);
 		gtk_box_pack_start(GTK_BOX(box), widget, FALSE, TRUE, 0);
-		buffer = gtk_entry_buffer_new(argv[k + 3], -1);
-		l = g_slist_append(l, buffer);
-		widget = gtk_entry_new_with_buffer(buffer);
+		/* entry */
+		buffers[i] = gtk_entry_buffer_new(items[i].init, -1);
+		/* XXX do not create an entry if irrelevant */
+		if((items[i].flags & BSDDIALOG_FIELDREADONLY)
+				&& items[i].label != NULL
+				&& items[i].init != NULL
+				&& strcmp(items[i].label, items[i].init) == 0)
+			continue;
+		widget = gtk_entry_new_with_buffer(buffers[i]);
 		if(conf->button.always_active == true)
 			gtk_entry_set_activates_default(GTK_ENTRY(widget),
 					TRUE);
 		if(conf->form.securech != '\0')
 			gtk_entry_set_visibility(GTK_ENTRY(widget), FALSE);
-		fieldlen = strtol(argv[k + 6], NULL, 10);
-		maxletters = strtol(argv[k + 7], NULL, 10);
-		if(fieldlen != 0)
+		if(items[i].fieldlen != 0)
 			gtk_entry_set_width_chars(GTK_ENTRY(widget),
-					abs(fieldlen));
-		if(fieldlen < 0)
-			gtk_editable_set_editable(GTK_EDITABLE(widget), FALSE);
-		if(maxletters == 0)
-			maxletters = abs(fieldlen);
+					items[i].fieldlen);
+		if((maxletters = items[i].maxvaluelen) == 0)
+			maxletters = items[i].fieldlen;
 		if(maxletters > 0)
 			gtk_entry_set_max_length(GTK_ENTRY(widget), maxletters);
+		if(items[i].flags & BSDDIALOG_FIELDHIDDEN)
+			gtk_entry_set_visibility(GTK_ENTRY(widget), FALSE);
+		if(items[i].flags & BSDDIALOG_FIELDREADONLY)
+			gtk_editable_set_editable(GTK_EDITABLE(widget), FALSE);
 		gtk_box_pack_start(GTK_BOX(box), widget,
 				(maxletters != 0) ? FALSE : TRUE, TRUE, 0);
-		gtk_container_add(GTK_CONTAINER(container), box);
 	}
 	gtk_widget_show_all(container);
 	_builder_dialog_buttons(dialog, conf, opt);
 	ret = _builder_dialog_run(conf, dialog);
 	gtk_widget_destroy(dialog);
-	switch(ret)
+	for(i = 0; i < nitems; i++)
 	{
-		case BSDDIALOG_EXTRA:
-		case BSDDIALOG_OK:
-			g_slist_foreach(l, _form_foreach_buffer, (void *)opt);
-			break;
+		p = gtk_entry_buffer_get_text(buffers[i]);
+		items[i].value = strdup((p != NULL) ? p : "");
+		g_object_unref(buffers[i]);
 	}
-	g_slist_foreach(l, (GFunc)g_object_unref, NULL);
-	g_slist_free(l);
+	free(buffers);
 	return ret;
 }
 
-static void _form_foreach_buffer(gpointer e, gpointer data)
+static struct bsddialog_formitem * _form_items_new(int argc,
+		char const ** argv, int j)
+{
+	struct bsddialog_formitem * items;
+	int i, k, fieldlen;
+
+	if((items = malloc(sizeof(*items) * (argc / j + 1))) == NULL)
+		return NULL;
+	memset(items, 0, sizeof(*items) * (argc / j + 1));
+	for(i = 0; (i + 1) * j <= argc; i++)
+	{
+		k = i * j;
+		items[i].label = argv[k];
+		items[i].ylabel = strtoul(argv[k + 1], NULL, 10);
+		items[i].xlabel = strtoul(argv[k + 2], NULL, 10);
+		items[i].init = argv[k + 3];
+		items[i].yfield = strtoul(argv[k + 4], NULL, 10);
+		items[i].xfield = strtoul(argv[k + 5], NULL, 10);
+		fieldlen = strtol(argv[k + 6], NULL, 10);
+		items[i].fieldlen = abs(fieldlen);
+		items[i].maxvaluelen = strtoul(argv[k + 7], NULL, 10);
+		items[i].flags = (j > 8) ? strtoul(argv[k + 8], NULL, 10) : 0;
+		if(fieldlen < 0)
+			items[i].flags |= BSDDIALOG_FIELDREADONLY;
+	}
+	return items;
+}
+
+static void _form_output(struct options const * opt, int ret,
+		unsigned int nitems, struct bsddialog_formitem * items)
 {
-	GtkEntryBuffer * buffer = e;
-	struct options const * opt = data;
+	Output * output;
+	unsigned int i;
 
-	dprintf(opt->output_fd, "%s\n", gtk_entry_buffer_get_text(buffer));
+	output = output_new(opt->output_fd);
+	for(i = 0; i < nitems; i++)
+	{
+		switch(ret)
+		{
+			case BSDDIALOG_EXTRA:
+			case BSDDIALOG_OK:
+				if(items[i].value == NULL)
+					break;
+				if(opt->result != NULL)
+					output_value(opt->result,
+							items[i].value);
+				else
+					output_printf(output, "%s\n",
+							items[i].value);
+				break;
+		}
+		free(items[i].value);
+		items[i].value = NULL;
+	}
+	output_delete(output);
 }
 
 
 /* builder_gauge */
+static int _gauge_error(struct gauge_data * gd,
+		struct bsddialog_conf const * conf, int fd,
+		char const * message);
 static gboolean _gauge_on_can_read(GIOChannel * channel,
 		GIOCondition condition, gpointer data);
 static gboolean _gauge_on_can_read_eof(gpointer data);
+static gboolean _gauge_on_can_transfer(GIOChannel * channel,
+		GIOCondition condition, gpointer data);
+static gboolean _gauge_on_frame(gpointer data);
+static gboolean _gauge_on_shm(gpointer data);
+static gboolean _gauge_on_watch(gpointer data);
+static GIOStatus _gauge_read_exec(struct gauge_data * gd,
+		GIOChannel * channel, unsigned int * changes, GError ** error);
+static void _gauge_set_amount(struct gauge_data * gd, int perc,
+		guint64 count);
 static void _gauge_set_percentage(struct gauge_data * gd, unsigned int perc);
+static void _gauge_set_shm(struct gauge_data * gd,
+		struct gaugeshm const * state);
 
 int builder_gauge(struct bsddialog_conf const * conf,
 		char const * text, int rows, int cols,
 		int argc, char const ** argv, struct options const * opt)
 {
-	int ret;
-	struct gauge_data gd = { NULL, NULL, NULL, NULL, 0, -1 };
 	unsigned int perc = 0;
-	GtkWidget * container;
-	GtkWidget * box;
-	GIOChannel * channel;
 
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s(%d)\n", __func__, argc);
@@ -775,7 +1165,66 @@ int builder_gauge(struct bsddialog_conf const * conf,
 	}
 	else if(argc == 1)
 		perc = strtoul(argv[0], NULL, 10);
+	return builder_gauge_fd(conf, text, rows, cols, perc, STDIN_FILENO,
+			NULL, opt);
+}
+
+int builder_gauge_fd(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, unsigned int perc,
+		int fd, char const * sep, struct options const * opt)
+{
+	int ret;
+	struct gauge_data gd = { NULL, NULL, NULL, NULL, 0, NULL, 0, 0, NULL,
+		0, NULL, NULL, NULL, FALSE, NULL, NULL };
+	GtkWidget * container;
+	GtkWidget * box;
+	GError * error = NULL;
+	struct gaugeshm state;
+
 	gd.opt = opt;
+	/* the input is read from the command instead */
+	if(opt->gauge_exec != NULL)
+	{
+		if((gd.exec = _builder_dialog_exec(opt->gauge_exec, FALSE, opt,
+						&error)) == NULL)
+		{
+			ret = _builder_dialog_error(NULL, conf, opt,
+					error->message);
+			g_error_free(error);
+			return ret;
+		}
+		fd = exec_get_fd(gd.exec);
+	}
+	if(opt->gauge_shm != NULL
+			&& (gd.shm = gaugeshm_attach(opt->gauge_shm)) == NULL)
+		return _gauge_error(&gd, conf, fd, strerror(errno));
+	if(gd.shm != NULL)
+		/* never a consistent sequence: the first frame checks it */
+		gd.sequence = 0x1;
+	/* the input is copied to the standard output */
+	else if(opt->gauge_pipe)
+	{
+		if((gd.pipe = gaugepipe_new(fd, STDOUT_FILENO,
+						opt->gauge_size)) == NULL)
+			return _gauge_error(&gd, conf, fd, strerror(errno));
+	}
+	/* the progress is observed instead */
+	else if(opt->gauge_file != NULL || opt->gauge_process != NULL)
+	{
+		gd.watch = (opt->gauge_file != NULL)
+			? gaugewatch_new_file(opt->gauge_file, opt->gauge_size,
+					&error)
+			: gaugewatch_new_process(opt->gauge_process,
+					opt->gauge_size, &error);
+		if(gd.watch == NULL)
+		{
+			ret = _gauge_error(&gd, conf, fd, error->message);
+			g_error_free(error);
+			return ret;
+		}
+	}
+	gd.parser = gaugeparser_new(opt->gauge_compact ? GPM_GAUGE_COMPACT
+			: GPM_GAUGE, sep, 0);
 	gd.dialog = _builder_dialog(conf, opt, NULL, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	container = gtk_dialog_get_content_area(GTK_DIALOG(gd.dialog));
@@ -809,7 +1258,15 @@ int builder_gauge(struct bsddialog_conf const * conf,
 #if GTK_CHECK_VERSION(3, 0, 0)
 	gtk_progress_bar_set_show_text(GTK_PROGRESS_BAR(gd.widget), TRUE);
 #endif
-	_gauge_set_percentage(&gd, perc);
+	if(gd.pipe != NULL)
+		_gauge_set_amount(&gd, gaugepipe_get_percentage(gd.pipe), 0);
+	else if(gd.watch != NULL)
+		_gauge_set_amount(&gd, gaugewatch_get_percentage(gd.watch), 0);
+	else if(gd.shm != NULL && gaugeshm_read(gd.shm, &state) == 0)
+		/* rendered before the first frame */
+		_gauge_set_shm(&gd, &state);
+	else
+		_gauge_set_percentage(&gd, perc);
 #if GTK_CHECK_VERSION(3, 0, 0)
 	box = gtk_box_new(GTK_ORIENTATION_VERTICAL, BORDER_WIDTH);
 #else
@@ -818,16 +1275,73 @@ int builder_gauge(struct bsddialog_conf const * conf,
 	gtk_box_pack_start(GTK_BOX(box), gd.widget, FALSE, TRUE, 0);
 	gtk_widget_show_all(box);
 	gtk_container_add(GTK_CONTAINER(container), box);
-	channel = g_io_channel_unix_new(STDIN_FILENO);
-	g_io_channel_set_encoding(channel, NULL, NULL);
-	/* XXX ignore errors */
-	g_io_channel_set_flags(channel, g_io_channel_get_flags(channel)
-			| G_IO_FLAG_NONBLOCK, NULL);
-	gd.id = g_io_add_watch(channel, G_IO_IN, _gauge_on_can_read, &gd);
+	if(gd.shm != NULL)
+		/* polled on every frame instead */
+		gd.frame = _builder_dialog_frame(gd.widget, _gauge_on_shm,
+				&gd);
+	else if(gd.watch != NULL)
+		gd.frame = _builder_dialog_frame(gd.widget, _gauge_on_watch,
+				&gd);
+	else
+	{
+		gd.channel = g_io_channel_unix_new(fd);
+		g_io_channel_set_encoding(gd.channel, NULL, NULL);
+		/* XXX ignore errors */
+		g_io_channel_set_flags(gd.channel, g_io_channel_get_flags(
+					gd.channel) | G_IO_FLAG_NONBLOCK, NULL);
+		if(gd.pipe != NULL)
+		{
+			/* watched instead of the input while full */
+			gd.output = g_io_channel_unix_new(STDOUT_FILENO);
+			g_io_channel_set_encoding(gd.output, NULL, NULL);
+			gd.id = g_io_add_watch(gd.channel, G_IO_IN | G_IO_HUP,
+					_gauge_on_can_transfer, &gd);
+		}
+		else
+			gd.id = g_io_add_watch(gd.channel, G_IO_IN,
+					_gauge_on_can_read, &gd);
+	}
 	ret = _builder_dialog_run(conf, gd.dialog);
 	if(gd.id != 0)
 		g_source_remove(gd.id);
+	if(gd.frame != 0)
+		_builder_dialog_frame_cancel(gd.widget, gd.frame);
 	gtk_widget_destroy(gd.dialog);
+	gaugeparser_delete(gd.parser);
+	if(gd.shm != NULL)
+		gaugeshm_close(gd.shm);
+	if(gd.pipe != NULL)
+		gaugepipe_delete(gd.pipe);
+	if(gd.output != NULL)
+		g_io_channel_unref(gd.output);
+	if(gd.channel != NULL)
+		g_io_channel_unref(gd.channel);
+	if(gd.watch != NULL)
+		gaugewatch_delete(gd.watch);
+	if(gd.exec != NULL)
+	{
+		close(fd);
+		/* the gauge closes itself once the command completed */
+		if(gd.eof && ret == BSDDIALOG_ESC)
+			ret = BSDDIALOG_OK;
+		ret = _builder_dialog_exec_wait(gd.exec, gd.eof, ret);
+	}
+	return ret;
+}
+
+/* the command is terminated if already started */
+static int _gauge_error(struct gauge_data * gd,
+		struct bsddialog_conf const * conf, int fd,
+		char const * message)
+{
+	int ret;
+
+	ret = _builder_dialog_error(NULL, conf, gd->opt, message);
+	if(gd->exec != NULL)
+	{
+		close(fd);
+		ret = _builder_dialog_exec_wait(gd->exec, FALSE, ret);
+	}
 	return ret;
 }
 
@@ -835,15 +1349,9 @@ static gboolean _gauge_on_can_read(GIOChannel * channel,
 		GIOCondition condition, gpointer data)
 {
 	struct gauge_data * gd = data;
-	const char sep[] = "XXX\n";
-	const char end[] = "EOF\n";
 	GIOStatus status;
-	char buf[BUFSIZ + 1];
-	gsize r;
+	unsigned int changes = GPC_NONE;
 	GError * error = NULL;
-	char * p, * q, * s;
-	char const * l;
-	unsigned int perc;
 
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s()\n", __func__);
@@ -854,81 +1362,26 @@ static gboolean _gauge_on_can_read(GIOChannel * channel,
 				"Unexpected condition");
 		return _gauge_on_can_read_eof(gd);
 	}
-	if((status = g_io_channel_read_chars(channel, buf, sizeof(buf) - 1,
-					&r, &error)) == G_IO_STATUS_ERROR)
+	if(gd->exec != NULL)
+		status = _gauge_read_exec(gd, channel, &changes, &error);
+	else
+		status = gaugeparser_read(gd->parser, channel, &changes,
+				&error);
+	if(status == G_IO_STATUS_ERROR)
 	{
 		_builder_dialog_error(gd->dialog, NULL, NULL, error->message);
 		g_error_free(error);
 		return _gauge_on_can_read_eof(gd);
 	}
-	else if(status == G_IO_STATUS_AGAIN)
-		return TRUE;
-	else if(status == G_IO_STATUS_EOF)
+	/* the widgets are only updated once per frame */
+	gd->changes |= changes & (GPC_PERCENTAGE | GPC_TEXT);
+	if(gd->changes != GPC_NONE && gd->frame == 0)
+		gd->frame = _builder_dialog_frame(gd->widget, _gauge_on_frame,
+				gd);
+	if(status == G_IO_STATUS_EOF)
+		gd->eof = TRUE;
+	if(status == G_IO_STATUS_EOF || (changes & GPC_EOF))
 		return _gauge_on_can_read_eof(gd);
-	buf[r] = '\0';
-#ifdef DEBUG
-	fprintf(stderr, "DEBUG: %s() buf=\"%s\"\n", __func__, buf);
-#endif
-	for(p = buf; p[0] != '\0'; p++)
-	{
-#ifdef DEBUG
-		fprintf(stderr, "DEBUG: %s() %d \"%s\"\n",
-				__func__, gd->state, p);
-#endif
-		if(gd->state != 3 && strncmp(p, end, sizeof(end) - 1) == 0)
-			return _gauge_on_can_read_eof(gd);
-		if(gd->state != 3 && strncmp(p, sep, sizeof(sep) - 1) == 0)
-			/* found a separator */
-			gd->state = 0;
-		else if(gd->state == 0 && sscanf(p, "%u", &perc) == 1)
-		{
-			/* set the current percentage */
-			_gauge_set_percentage(gd, perc);
-			gtk_label_set_text(GTK_LABEL(gd->label), NULL);
-			gd->state = 1;
-		}
-		else if(gd->state == 0 || gd->state == 1)
-		{
-			/* set the current text */
-			if((q = strchr(p, '\n')) != NULL)
-				*q = '\0';
-			gtk_label_set_text(GTK_LABEL(gd->label), p);
-			if(q == NULL)
-			{
-				gd->state = 3;
-				break;
-			}
-			gd->state = 2;
-			p = q;
-			continue;
-		}
-		else if(gd->state == 2 || gd->state == 3)
-		{
-			/* append to the current text */
-			if((q = strchr(p, '\n')) != NULL)
-				*q = '\0';
-			l = gtk_label_get_text(GTK_LABEL(gd->label));
-			r = strlen(l) + strlen(p) + 2;
-			if((s = malloc(r)) != NULL)
-			{
-				snprintf(s, r, "%s%s%s", l,
-						(gd->state == 2) ? "\n" : "",
-						p);
-				gtk_label_set_text(GTK_LABEL(gd->label), s);
-				free(s);
-			}
-			if(q == NULL)
-			{
-				gd->state = 3;
-				break;
-			}
-			gd->state = 2;
-			p = q;
-			continue;
-		}
-		if((p = strchr(p, '\n')) == NULL)
-			break;
-	}
 	return TRUE;
 }
 
@@ -945,16 +1398,176 @@ static gboolean _gauge_on_can_read_eof(gpointer data)
 	return FALSE;
 }
 
+static gboolean _gauge_on_can_transfer(GIOChannel * channel,
+		GIOCondition condition, gpointer data)
+{
+	struct gauge_data * gd = data;
+	GIOStatus status;
+	GError * error = NULL;
+	GIOCondition wait;
+	GIOChannel * next;
+
+	if((condition & (G_IO_IN | G_IO_OUT | G_IO_HUP)) == 0)
+	{
+		_builder_dialog_error(gd->dialog, NULL, NULL,
+				"Unexpected condition");
+		return _gauge_on_can_read_eof(gd);
+	}
+	if((status = gaugepipe_transfer(gd->pipe, &error))
+			== G_IO_STATUS_ERROR)
+	{
+		_builder_dialog_error(gd->dialog, NULL, NULL, error->message);
+		g_error_free(error);
+		return _gauge_on_can_read_eof(gd);
+	}
+	/* the widgets are only updated once per frame */
+	if(status == G_IO_STATUS_NORMAL)
+		gd->changes |= GPC_PERCENTAGE;
+	if(gd->changes != GPC_NONE && gd->frame == 0)
+		gd->frame = _builder_dialog_frame(gd->widget, _gauge_on_frame,
+				gd);
+	if(status == G_IO_STATUS_EOF)
+		return _gauge_on_can_read_eof(gd);
+	/* waits for the output to drain instead of the input, or back */
+	wait = gaugepipe_get_condition(gd->pipe);
+	if((next = (wait == G_IO_OUT) ? gd->output : gd->channel) == channel)
+		return TRUE;
+	gd->id = g_io_add_watch(next, wait | G_IO_HUP, _gauge_on_can_transfer,
+			gd);
+	return FALSE;
+}
+
+static gboolean _gauge_on_frame(gpointer data)
+{
+	struct gauge_data * gd = data;
+	char const * text;
+
+	if((gd->changes & GPC_PERCENTAGE) && gd->pipe != NULL)
+		_gauge_set_amount(gd, gaugepipe_get_percentage(gd->pipe),
+				gaugepipe_get_count(gd->pipe));
+	else if(gd->changes & GPC_PERCENTAGE)
+		_gauge_set_percentage(gd,
+				gaugeparser_get_percentage(gd->parser));
+	if((gd->changes & GPC_TEXT) && gd->label != NULL)
+	{
+		text = gaugeparser_get_text(gd->parser);
+		/* avoid a relayout if possible */
+		if(strcmp(gtk_label_get_text(GTK_LABEL(gd->label)), text) != 0)
+			gtk_label_set_text(GTK_LABEL(gd->label), text);
+	}
+	gd->changes = GPC_NONE;
+	gd->frame = 0;
+	return FALSE;
+}
+
+static gboolean _gauge_on_shm(gpointer data)
+{
+	struct gauge_data * gd = data;
+	struct gaugeshm state;
+
+	if(gaugeshm_read(gd->shm, &state) != 0
+			|| state.sequence == gd->sequence)
+		/* not ready or unchanged */
+		return TRUE;
+	gd->sequence = state.sequence;
+	_gauge_set_shm(gd, &state);
+	if((state.flags & GAUGESHM_DONE) == 0)
+		return TRUE;
+	if(!gd->opt->ignore_eof)
+		gtk_dialog_response(GTK_DIALOG(gd->dialog), GTK_RESPONSE_CLOSE);
+	gd->frame = 0;
+	return FALSE;
+}
+
+static gboolean _gauge_on_watch(gpointer data)
+{
+	struct gauge_data * gd = data;
+	GIOStatus status;
+	GError * error = NULL;
+
+	if((status = gaugewatch_sample(gd->watch, &error))
+			== G_IO_STATUS_ERROR)
+	{
+		_builder_dialog_error(gd->dialog, NULL, NULL, error->message);
+		g_error_free(error);
+	}
+	else if(status == G_IO_STATUS_AGAIN)
+		return TRUE;
+	else
+		_gauge_set_amount(gd, gaugewatch_get_percentage(gd->watch),
+				gaugewatch_get_count(gd->watch));
+	if(status == G_IO_STATUS_NORMAL)
+		return TRUE;
+	if(!gd->opt->ignore_eof)
+		gtk_dialog_response(GTK_DIALOG(gd->dialog), GTK_RESPONSE_CLOSE);
+	gd->frame = 0;
+	return FALSE;
+}
+
+static GIOStatus _gauge_read_exec(struct gauge_data * gd,
+		GIOChannel * channel, unsigned int * changes, GError ** error)
+{
+	GIOStatus status;
+	char buf[BUFSIZ];
+	gsize r;
+	char const * p;
+	size_t len;
+
+	status = g_io_channel_read_chars(channel, buf, sizeof(buf), &r, error);
+	if(status == G_IO_STATUS_NORMAL)
+	{
+		p = exec_filter(gd->exec, buf, r, &len);
+		*changes |= gaugeparser_feed(gd->parser, p, len);
+	}
+	else if(status == G_IO_STATUS_EOF)
+	{
+		/* the last line may be incomplete */
+		if((p = exec_filter(gd->exec, NULL, 0, &len)) != NULL)
+			*changes |= gaugeparser_feed(gd->parser, p, len);
+		*changes |= gaugeparser_flush(gd->parser);
+	}
+	return status;
+}
+
 static void _gauge_set_percentage(struct gauge_data * gd, unsigned int perc)
 {
-	gdouble fraction;
 	char buf[8];
 
 	perc = MIN(perc, 100);
-	fraction = (gdouble)perc / 100.0;
-	gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(gd->widget), fraction);
 	snprintf(buf, sizeof(buf), "%u %%", perc);
-	gtk_progress_bar_set_text(GTK_PROGRESS_BAR(gd->widget), buf);
+	_builder_dialog_progress(gd->widget, (gdouble)perc / 100.0, buf);
+}
+
+/* an empty text keeps the current one */
+static void _gauge_set_shm(struct gauge_data * gd,
+		struct gaugeshm const * state)
+{
+	_gauge_set_percentage(gd, state->percentage);
+	if(gd->label != NULL && state->text[0] != '\0'
+			&& strcmp(gtk_label_get_text(GTK_LABEL(gd->label)),
+				state->text) != 0)
+		gtk_label_set_text(GTK_LABEL(gd->label), state->text);
+}
+
+/* the percentage is -1 if the total is not known */
+static void _gauge_set_amount(struct gauge_data * gd, int perc,
+		guint64 count)
+{
+	gchar * size;
+
+	if(perc >= 0)
+	{
+		_gauge_set_percentage(gd, perc);
+		return;
+	}
+#if GLIB_CHECK_VERSION(2, 30, 0)
+	size = g_format_size(count);
+#else
+	size = g_format_size_for_display(count);
+#endif
+	gtk_progress_bar_pulse(GTK_PROGRESS_BAR(gd->widget));
+	gtk_progress_bar_set_text(GTK_PROGRESS_BAR(gd->widget), size);
+	g_free(size);
 }
 
 
@@ -1147,8 +1760,13 @@ int builder_inputbox(struct bsddialog_conf const * conf,
 	{
 		case BSDDIALOG_EXTRA:
 		case BSDDIALOG_OK:
-			dprintf(opt->output_fd, "%s\n",
-					gtk_entry_buffer_get_text(buffer));
+			if(opt->result != NULL)
+				output_value(opt->result,
+						gtk_entry_buffer_get_text(buffer));
+			else
+				output_dprintf(opt->output_fd, "%s\n",
+						gtk_entry_buffer_get_text(
+							buffer));
 			break;
 	}
 	g_object_unref(buffer);
@@ -1157,8 +1775,10 @@ int builder_inputbox(struct bsddialog_conf const * conf,
 
 
 /* builder_menu */
-static GtkTreeIter * _menu_get_parent(GtkTreeModel * model,
-		GtkTreeIter * iter, int depth);
+static int _builder_menu_model(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, MenuModel * model,
+		struct menustream_data * stream, int * focusitem,
+		struct options const * opt);
 static void _menu_on_row_activated(gpointer data);
 
 int builder_menu(struct bsddialog_conf const * conf,
@@ -1166,16 +1786,10 @@ int builder_menu(struct bsddialog_conf const * conf,
 		int argc, char const ** argv, struct options const * opt)
 {
 	int ret;
-	GtkWidget * dialog;
-	GtkWidget * container;
-	GtkWidget * window;
-	GtkWidget * widget;
-	GtkTreeStore * store;
-	GtkTreeIter iter, parent, * pparent = NULL;
-	GtkTreeViewColumn * column;
-	GtkTreeSelection * treesel;
-	int i, j, k, n, depth = 0;
-	char const * prefix = NULL, * name, * desc, * tooltip;
+	struct bsddialog_menuitem * items, * mitems;
+	MenuModel * model;
+	struct menustream_data * stream = NULL;
+	int j, n, focus = -1;
 
 	j = opt->item_bottomdesc ? 3 : 2;
 	if(opt->item_prefix)
@@ -1195,14 +1809,79 @@ int builder_menu(struct bsddialog_conf const * conf,
 	}
 	else if(n == 0)
 		n = (argc - 1) / j;
+	if((items = _builder_dialog_menu_items_new(opt, argc - 1, argv + 1,
+					j, FALSE, FALSE)) == NULL)
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
+	if((model = menumodel_new(items, (argc - 1) / j,
+					opt->items_from != NULL
+					&& opt->item_depth)) == NULL)
+	{
+		free(items);
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
+	}
+	if(opt->items_from != NULL && (stream = _builder_dialog_menu_stream(
+					conf, opt, model, j, FALSE, FALSE))
+					== NULL)
+		ret = BSDDIALOG_ERROR;
+	else
+		ret = _builder_menu_model(conf, text, rows, cols, model,
+				stream, &focus, opt);
+	mitems = menumodel_get_items(model);
+	if(focus >= 0)
+		switch(ret)
+		{
+			case BSDDIALOG_HELP:
+				_builder_dialog_menu_output(opt,
+						mitems[focus].name, "HELP ");
+				break;
+			case BSDDIALOG_EXTRA:
+			case BSDDIALOG_OK:
+				_builder_dialog_menu_output(opt,
+						mitems[focus].name, NULL);
+				break;
+		}
+	_builder_dialog_menu_stream_delete(stream);
+	g_object_unref(model);
+	free(items);
+	return ret;
+}
+
+int builder_menu_items(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int nitems, struct bsddialog_menuitem * items,
+		int * focusitem, struct options const * opt)
+{
+	int ret;
+	MenuModel * model;
+
+	if((model = menumodel_new(items, nitems, FALSE)) == NULL)
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
+	ret = _builder_menu_model(conf, text, rows, cols, model, NULL,
+			focusitem, opt);
+	g_object_unref(model);
+	return ret;
+}
+
+static int _builder_menu_model(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, MenuModel * model,
+		struct menustream_data * stream, int * focusitem,
+		struct options const * opt)
+{
+	int ret;
+	GtkWidget * dialog;
+	GtkWidget * container;
+	GtkWidget * window;
+	GtkWidget * widget;
+	GtkTreeViewColumn * column;
+	GtkTreeSelection * treesel;
+	struct menufilter_data * filter;
+
 	dialog = _builder_dialog(conf, opt, text, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	container = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
 #else
 	container = dialog->vbox;
 #endif
-	store = gtk_tree_store_new(MTS_COUNT, G_TYPE_STRING, G_TYPE_INT,
-			G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
 	window = gtk_scrolled_window_new(NULL, NULL);
 	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(window),
 			GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
@@ -1211,52 +1890,23 @@ int builder_menu(struct bsddialog_conf const * conf,
 				GTK_SHADOW_NONE);
 	widget = gtk_tree_view_new();
 	gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(widget), FALSE);
-	gtk_tree_view_set_model(GTK_TREE_VIEW(widget), GTK_TREE_MODEL(store));
 	if(opt->item_bottomdesc)
-		gtk_tree_view_set_tooltip_column(GTK_TREE_VIEW(widget),
-				MTS_TOOLTIP);
+		_builder_dialog_menu_tooltip(widget);
 	treesel = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
 	gtk_tree_selection_set_mode(treesel, GTK_SELECTION_BROWSE);
-	for(i = 0; (i + 1) * j < argc; i++)
-	{
-		k = i * j + 1;
-		if(opt->item_prefix)
-			prefix = argv[k++];
-		if(opt->item_depth)
-		{
-			depth = strtol(argv[k++], NULL, 10);
-#ifdef DEBUG
-			fprintf(stderr, "DEBUG: %s() depth=%d\n", __func__,
-					depth);
-#endif
-			pparent = _menu_get_parent(GTK_TREE_MODEL(store),
-					&parent, depth);
-		}
-		name = argv[k++];
-		desc = argv[k++];
-		tooltip = (k < j) ? argv[k++] : NULL;
-		gtk_tree_store_append(store, &iter, pparent);
-		gtk_tree_store_set(store, &iter, MTS_PREFIX, prefix,
-				MTS_DEPTH, depth,
-				MTS_NAME, name, MTS_DESCRIPTION, desc,
-				(tooltip != NULL) ? MTS_TOOLTIP : -1,
-				(tooltip != NULL) ? tooltip : NULL, -1);
-		if(opt->item_default != NULL
-				&& strcmp(name, opt->item_default) == 0)
-			gtk_tree_selection_select_iter(treesel, &iter);
-	}
+	_builder_dialog_menu_view(widget, model, stream, opt, focusitem);
 	if(opt->item_prefix == true)
 	{
 		column = gtk_tree_view_column_new_with_attributes(NULL,
 				gtk_cell_renderer_text_new(),
-				"text", MTS_PREFIX, NULL);
+				"text", MMC_PREFIX, NULL);
 		gtk_tree_view_column_set_expand(column, FALSE);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
 	}
 	if(conf->menu.no_name == false)
 	{
 		column = gtk_tree_view_column_new_with_attributes(NULL,
-				gtk_cell_renderer_text_new(), "text", MTS_NAME,
+				gtk_cell_renderer_text_new(), "text", MMC_NAME,
 				NULL);
 		gtk_tree_view_column_set_expand(column, FALSE);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
@@ -1265,59 +1915,26 @@ int builder_menu(struct bsddialog_conf const * conf,
 	{
 		column = gtk_tree_view_column_new_with_attributes(NULL,
 				gtk_cell_renderer_text_new(), "text",
-				MTS_DESCRIPTION, NULL);
+				MMC_DESCRIPTION, NULL);
 		gtk_tree_view_column_set_expand(column, TRUE);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
 	}
-	if(opt->item_depth)
-		gtk_tree_view_expand_all(GTK_TREE_VIEW(widget));
+	_builder_dialog_menu_large(widget, model, opt);
 	g_signal_connect_swapped(widget, "row-activated",
 			G_CALLBACK(_menu_on_row_activated), dialog);
+	filter = _builder_dialog_menu_filter(container, widget, model, stream,
+			opt);
 	gtk_container_add(GTK_CONTAINER(window), widget);
 	gtk_box_pack_start(GTK_BOX(container), window, TRUE, TRUE, 0);
 	gtk_widget_show_all(window);
 	_builder_dialog_buttons(dialog, conf, opt);
 	ret = _builder_dialog_run(conf, dialog);
-	switch(ret)
-	{
-		case BSDDIALOG_HELP:
-			_builder_dialog_menu_output(opt, treesel,
-					GTK_TREE_MODEL(store), MTS_NAME,
-					"HELP ");
-			break;
-		case BSDDIALOG_EXTRA:
-		case BSDDIALOG_OK:
-			_builder_dialog_menu_output(opt, treesel,
-					GTK_TREE_MODEL(store), MTS_NAME, NULL);
-			break;
-	}
+	_builder_dialog_menu_focus(treesel, model, focusitem);
+	_builder_dialog_menu_filter_delete(filter);
 	gtk_widget_destroy(dialog);
 	return ret;
 }
 
-static GtkTreeIter * _menu_get_parent(GtkTreeModel * model,
-		GtkTreeIter * parent, int depth)
-{
-	GtkTreeIter * ret = NULL;
-	GtkTreeIter iter;
-	gboolean b;
-	int d;
-
-	if(depth <= 0)
-		return NULL;
-	for(b = gtk_tree_model_get_iter_first(model, &iter); b == TRUE;
-			b = gtk_tree_model_iter_next(model, &iter))
-	{
-		gtk_tree_model_get(model, &iter, MTS_DEPTH, &d, -1);
-		if(d < depth)
-		{
-			*parent = iter;
-			ret = parent;
-		}
-	}
-	return ret;
-}
-
 static void _menu_on_row_activated(gpointer data)
 {
 	GtkWidget * dialog = data;
@@ -1327,119 +1944,39 @@ static void _menu_on_row_activated(gpointer data)
 
 
 /* builder_mixedform */
-static void _mixedform_foreach_buffer(gpointer e, gpointer data);
-
 int builder_mixedform(struct bsddialog_conf const * conf,
 		char const * text, int rows, int cols,
 		int argc, char const ** argv, struct options const * opt)
 {
 	int ret;
-	GtkWidget * dialog;
-	GtkWidget * container;
-	GtkWidget * box;
-	GtkWidget * widget;
-	GSList * l = NULL;
-	GtkEntryBuffer * buffer;
-	GtkSizeGroup * group;
-	int i, k, n, fieldlen, maxletters, flag;
+	struct bsddialog_formitem * items;
 	const int j = 9;
 
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s(%d)\n", __func__, argc);
 #endif
-	if(argc < 1 || (n = strtol(argv[0], NULL, 10)) < 0
+	if(argc < 1 || strtol(argv[0], NULL, 10) < 0
 			|| ((argc - 1) % j) != 0)
 	{
 		error_args(opt->name, argc, argv);
 		return BSDDIALOG_ERROR;
 	}
-	group = gtk_size_group_new(GTK_SIZE_GROUP_BOTH);
-	dialog = _builder_dialog(conf, opt, text, rows, cols);
-#if GTK_CHECK_VERSION(2, 14, 0)
-	container = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
-#else
-	container = dialog->vbox;
-#endif
-	gtk_box_set_spacing(GTK_BOX(container), BORDER_WIDTH);
-	for(i = 0; (i + 1) * j < argc; i++)
-	{
-		k = i * j + 1;
-#if GTK_CHECK_VERSION(3, 0, 0)
-		box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, BORDER_WIDTH);
-#else
-		box = gtk_hbox_new(FALSE, BORDER_WIDTH);
-#endif
-		gtk_container_add(GTK_CONTAINER(container), box);
-		/* label */
-		widget = gtk_label_new(argv[k]);
-#if GTK_CHECK_VERSION(3, 14, 0)
-		gtk_widget_set_halign(widget, opt->halign);
-#else
-		gtk_misc_set_alignment(GTK_MISC(widget), opt->halign, 0.5);
-#endif
-#ifdef WITH_XDIALOG
-		gtk_label_set_justify(GTK_LABEL(widget), opt->justify);
-#endif
-		gtk_size_group_add_widget(group, widget);
-		gtk_box_pack_start(GTK_BOX(box), widget, FALSE, TRUE, 0);
-		/* entry */
-		buffer = gtk_entry_buffer_new(argv[k + 3], -1);
-		l = g_slist_append(l, buffer);
-		fieldlen = strtol(argv[k + 6], NULL, 10);
-		maxletters = strtol(argv[k + 7], NULL, 10);
-		flag = strtol(argv[k + 8], NULL, 10);
-		/* XXX do not create an entry if irrelevant */
-		if(flag & 0x2 && strcmp(argv[k], argv[k + 3]) == 0)
-			continue;
-		widget = gtk_entry_new_with_buffer(buffer);
-		if(conf->button.always_active == true)
-			gtk_entry_set_activates_default(GTK_ENTRY(widget),
-					TRUE);
-		if(conf->form.securech != '\0')
-			gtk_entry_set_visibility(GTK_ENTRY(widget), FALSE);
-		if(fieldlen != 0)
-			gtk_entry_set_width_chars(GTK_ENTRY(widget),
-					abs(fieldlen));
-		if(fieldlen < 0)
-			gtk_editable_set_editable(GTK_EDITABLE(widget), FALSE);
-		if(maxletters == 0)
-			maxletters = abs(fieldlen);
-		if(maxletters > 0)
-			gtk_entry_set_max_length(GTK_ENTRY(widget), maxletters);
-		if(flag & 0x1)
-			gtk_entry_set_visibility(GTK_ENTRY(widget), FALSE);
-		if(flag & 0x2)
-			gtk_editable_set_editable(GTK_EDITABLE(widget), FALSE);
-		gtk_box_pack_start(GTK_BOX(box), widget,
-				(maxletters != 0) ? FALSE : TRUE, TRUE, 0);
-	}
-	gtk_widget_show_all(container);
-	_builder_dialog_buttons(dialog, conf, opt);
-	ret = _builder_dialog_run(conf, dialog);
-	gtk_widget_destroy(dialog);
-	switch(ret)
-	{
-		case BSDDIALOG_EXTRA:
-		case BSDDIALOG_OK:
-			g_slist_foreach(l, _mixedform_foreach_buffer,
-					(void *)opt);
-			break;
-	}
-	g_slist_foreach(l, (GFunc)g_object_unref, NULL);
-	g_slist_free(l);
+	if((items = _form_items_new(argc - 1, argv + 1, j)) == NULL)
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
+	ret = builder_form_items(conf, text, rows, cols, (argc - 1) / j, items,
+			opt);
+	_form_output(opt, ret, (argc - 1) / j, items);
+	free(items);
 	return ret;
 }
 
-static void _mixedform_foreach_buffer(gpointer e, gpointer data)
-{
-	GtkEntryBuffer * buffer = e;
-	struct options const * opt = data;
-
-	dprintf(opt->output_fd, "%s\n", gtk_entry_buffer_get_text(buffer));
-}
-
 
 /* builder_mixedgauge */
+static void _mixedgauge_add(struct mixedgauge_data * md, char const * label,
+		int perc);
+static gboolean _mixedgauge_on_can_read(GIOChannel * channel,
+		GIOCondition condition, gpointer data);
+static gboolean _mixedgauge_on_frame(gpointer data);
 static void _mixedgauge_set_percentage(GtkWidget * widget, int perc);
 
 int builder_mixedgauge(struct bsddialog_conf const * conf,
@@ -1447,11 +1984,9 @@ int builder_mixedgauge(struct bsddialog_conf const * conf,
 		int argc, char const ** argv, struct options const * opt)
 {
 	int ret;
-	GtkWidget * dialog;
-	GtkWidget * container;
-	GtkWidget * box;
-	GtkWidget * widget;
-	int i, perc;
+	char const ** labels;
+	int * percs;
+	unsigned int i, n;
 	const int j = 2;
 
 #ifdef DEBUG
@@ -1462,44 +1997,63 @@ int builder_mixedgauge(struct bsddialog_conf const * conf,
 		error_args(opt->name, argc - 1, argv + 1);
 		return BSDDIALOG_ERROR;
 	}
-	dialog = _builder_dialog(conf, opt, NULL, rows, cols);
+	n = (argc >= 1) ? (argc - 1) / j : 0;
+	labels = malloc(sizeof(*labels) * (n + 1));
+	percs = malloc(sizeof(*percs) * (n + 1));
+	if(labels == NULL || percs == NULL)
+	{
+		free(labels);
+		free(percs);
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
+	}
+	for(i = 0; i < n; i++)
+	{
+		labels[i] = argv[i * j + 1];
+		percs[i] = strtol(argv[i * j + 2], NULL, 10);
+	}
+	ret = builder_mixedgauge_bars(conf, text, rows, cols,
+			(argc >= 1) ? strtol(argv[0], NULL, 10) : 0,
+			n, labels, percs, opt);
+	free(labels);
+	free(percs);
+	return ret;
+}
+
+int builder_mixedgauge_bars(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, unsigned int mainperc,
+		unsigned int nminibars, char const ** minilabels,
+		int * minipercs, struct options const * opt)
+{
+	int ret;
+	struct mixedgauge_data md = { NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+		0, NULL, 0, 0 };
+	GtkWidget * container;
+	GtkWidget * widget;
+	GIOChannel * channel;
+	unsigned int i;
+
+	md.opt = opt;
+	md.dialog = _builder_dialog(conf, opt, NULL, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
-	container = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
+	container = gtk_dialog_get_content_area(GTK_DIALOG(md.dialog));
 #else
-	container = dialog->vbox;
+	container = md.dialog->vbox;
 #endif
 	/* items */
-	for(i = 0; (i + 1) * j < argc; i++)
-	{
 #if GTK_CHECK_VERSION(3, 0, 0)
-		box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, BORDER_WIDTH);
+	md.items = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
 #else
-		box = gtk_hbox_new(FALSE, BORDER_WIDTH);
-#endif
-		widget = gtk_label_new(argv[i * j + 1]);
-		gtk_label_set_single_line_mode(GTK_LABEL(widget), TRUE);
-#if GTK_CHECK_VERSION(3, 14, 0)
-		gtk_widget_set_halign(widget, opt->halign);
-#else
-		gtk_misc_set_alignment(GTK_MISC(widget), opt->halign, 0.5);
-#endif
-#ifdef WITH_XDIALOG
-		gtk_label_set_justify(GTK_LABEL(widget), opt->justify);
-#endif
-		gtk_box_pack_start(GTK_BOX(box), widget, TRUE, TRUE, 0);
-		widget = gtk_progress_bar_new();
-#if GTK_CHECK_VERSION(3, 0, 0)
-		gtk_progress_bar_set_show_text(GTK_PROGRESS_BAR(widget), TRUE);
+	md.items = gtk_vbox_new(FALSE, 0);
 #endif
-		_mixedgauge_set_percentage(widget,
-				strtol(argv[i * j + 2], NULL, 10));
-		gtk_box_pack_start(GTK_BOX(box), widget, FALSE, TRUE, 0);
-		gtk_container_add(GTK_CONTAINER(container), box);
-	}
+	md.labels = g_ptr_array_new();
+	md.bars = g_ptr_array_new();
+	for(i = 0; i < nminibars; i++)
+		_mixedgauge_add(&md, minilabels[i], minipercs[i]);
+	gtk_container_add(GTK_CONTAINER(container), md.items);
 	/* text */
 	if(text != NULL)
 	{
-		widget = gtk_label_new(text);
+		md.label = widget = gtk_label_new(text);
 		gtk_label_set_line_wrap(GTK_LABEL(widget), TRUE);
 		gtk_label_set_line_wrap_mode(GTK_LABEL(widget),
 				PANGO_WRAP_WORD_CHAR);
@@ -1520,19 +2074,166 @@ int builder_mixedgauge(struct bsddialog_conf const * conf,
 				BORDER_WIDTH);
 	}
 	/* global progress bar */
+	md.widget = gtk_progress_bar_new();
+#if GTK_CHECK_VERSION(3, 0, 0)
+	gtk_progress_bar_set_show_text(GTK_PROGRESS_BAR(md.widget), TRUE);
+#endif
+	_mixedgauge_set_percentage(md.widget, mainperc);
+	gtk_box_pack_start(GTK_BOX(container), md.widget, FALSE, TRUE, 0);
+	gtk_widget_show_all(container);
+	if(opt->mixedgauge_stdin)
+	{
+		/* the dialog is updated from the standard input */
+		md.parser = gaugeparser_new(GPM_MIXEDGAUGE, NULL, 0);
+		for(i = 0; i < nminibars; i++)
+			gaugeparser_set_item(md.parser, minilabels[i],
+					minipercs[i]);
+		/* the items are already shown */
+		gaugeparser_feed(md.parser, NULL, 0);
+		channel = g_io_channel_unix_new(STDIN_FILENO);
+		g_io_channel_set_encoding(channel, NULL, NULL);
+		/* XXX ignore errors */
+		g_io_channel_set_flags(channel, g_io_channel_get_flags(channel)
+				| G_IO_FLAG_NONBLOCK, NULL);
+		md.id = g_io_add_watch(channel, G_IO_IN,
+				_mixedgauge_on_can_read, &md);
+		g_io_channel_unref(channel);
+	}
+	ret = _builder_dialog_run(conf, md.dialog);
+	if(md.id != 0)
+		g_source_remove(md.id);
+	if(md.frame != 0)
+		_builder_dialog_frame_cancel(md.widget, md.frame);
+	gtk_widget_destroy(md.dialog);
+	if(md.parser != NULL)
+		gaugeparser_delete(md.parser);
+	g_ptr_array_free(md.labels, TRUE);
+	g_ptr_array_free(md.bars, TRUE);
+	return ret;
+}
+
+static void _mixedgauge_add(struct mixedgauge_data * md, char const * label,
+		int perc)
+{
+	struct options const * opt = md->opt;
+	GtkWidget * box;
+	GtkWidget * widget;
+
+#if GTK_CHECK_VERSION(3, 0, 0)
+	box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, BORDER_WIDTH);
+#else
+	box = gtk_hbox_new(FALSE, BORDER_WIDTH);
+#endif
+	widget = gtk_label_new(label);
+	gtk_label_set_single_line_mode(GTK_LABEL(widget), TRUE);
+#if GTK_CHECK_VERSION(3, 14, 0)
+	gtk_widget_set_halign(widget, opt->halign);
+#else
+	gtk_misc_set_alignment(GTK_MISC(widget), opt->halign, 0.5);
+#endif
+#ifdef WITH_XDIALOG
+	gtk_label_set_justify(GTK_LABEL(widget), opt->justify);
+#endif
+	gtk_box_pack_start(GTK_BOX(box), widget, TRUE, TRUE, 0);
+	g_ptr_array_add(md->labels, widget);
 	widget = gtk_progress_bar_new();
 #if GTK_CHECK_VERSION(3, 0, 0)
 	gtk_progress_bar_set_show_text(GTK_PROGRESS_BAR(widget), TRUE);
 #endif
-	perc = (argc >= 1) ? strtol(argv[0], NULL, 10) : 0;
 	_mixedgauge_set_percentage(widget, perc);
-	gtk_box_pack_start(GTK_BOX(container), widget, FALSE, TRUE, 0);
-	gtk_widget_show_all(container);
-	ret = _builder_dialog_run(conf, dialog);
-	gtk_widget_destroy(dialog);
-	return ret;
+	gtk_box_pack_start(GTK_BOX(box), widget, FALSE, TRUE, 0);
+	g_ptr_array_add(md->bars, widget);
+	gtk_widget_show_all(box);
+	gtk_box_pack_start(GTK_BOX(md->items), box, TRUE, TRUE, 0);
+}
+
+static gboolean _mixedgauge_on_can_read(GIOChannel * channel,
+		GIOCondition condition, gpointer data)
+{
+	struct mixedgauge_data * md = data;
+	GIOStatus status;
+	unsigned int changes = GPC_NONE;
+	GError * error = NULL;
+
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s()\n", __func__);
+#endif
+	if(condition != G_IO_IN)
+		_builder_dialog_error(md->dialog, NULL, NULL,
+				"Unexpected condition");
+	else if((status = gaugeparser_read(md->parser, channel, &changes,
+					&error)) == G_IO_STATUS_ERROR)
+	{
+		_builder_dialog_error(md->dialog, NULL, NULL, error->message);
+		g_error_free(error);
+	}
+	else
+	{
+		/* the widgets are only updated once per frame */
+		md->changes |= changes & ~GPC_EOF;
+		if(md->changes != GPC_NONE && md->frame == 0)
+			md->frame = _builder_dialog_frame(md->widget,
+					_mixedgauge_on_frame, md);
+		if(status != G_IO_STATUS_EOF && !(changes & GPC_EOF))
+			return TRUE;
+	}
+	if(!md->opt->ignore_eof)
+		gtk_dialog_response(GTK_DIALOG(md->dialog), GTK_RESPONSE_CLOSE);
+	md->id = 0;
+	return FALSE;
+}
+
+static gboolean _mixedgauge_on_frame(gpointer data)
+{
+	struct mixedgauge_data * md = data;
+	char const * label;
+	char const * text;
+	int perc;
+	guint i;
+	GtkWidget * widget;
+
+	if(md->changes & GPC_PERCENTAGE)
+		_mixedgauge_set_percentage(md->widget,
+				gaugeparser_get_percentage(md->parser));
+	if((md->changes & GPC_TEXT) && md->label != NULL)
+	{
+		text = gaugeparser_get_text(md->parser);
+		if(strcmp(gtk_label_get_text(GTK_LABEL(md->label)), text) != 0)
+			gtk_label_set_text(GTK_LABEL(md->label), text);
+	}
+	if(md->changes & GPC_ITEMS)
+	{
+		/* the widgets are re-used in place */
+		for(i = 0; (label = gaugeparser_get_item(md->parser, i, &perc))
+				!= NULL; i++)
+		{
+			if(i == md->labels->len)
+			{
+				_mixedgauge_add(md, label, perc);
+				continue;
+			}
+			widget = g_ptr_array_index(md->labels, i);
+			if(strcmp(gtk_label_get_text(GTK_LABEL(widget)), label)
+					!= 0)
+				gtk_label_set_text(GTK_LABEL(widget), label);
+			_mixedgauge_set_percentage(g_ptr_array_index(md->bars,
+						i), perc);
+		}
+		while(md->labels->len > i)
+		{
+			widget = g_ptr_array_index(md->labels,
+					md->labels->len - 1);
+			gtk_widget_destroy(gtk_widget_get_parent(widget));
+			g_ptr_array_set_size(md->labels, md->labels->len - 1);
+			g_ptr_array_set_size(md->bars, md->bars->len - 1);
+		}
+	}
+	md->changes = GPC_NONE;
+	md->frame = 0;
+	return FALSE;
 }
 
+
 static void _mixedgauge_set_percentage(GtkWidget * widget, int perc)
 {
 	gdouble fraction = 0.0;
@@ -1591,38 +2292,195 @@ static void _mixedgauge_set_percentage(GtkWidget * widget, int perc)
 		snprintf(buf, sizeof(buf), "%d %%", perc);
 	}
 	if(fraction < 0.0 || fraction > 1.0)
+	{
 		/* FIXME keep pulsing until closing */
 		gtk_progress_bar_pulse(GTK_PROGRESS_BAR(widget));
+		gtk_progress_bar_set_text(GTK_PROGRESS_BAR(widget), buf);
+	}
 	else
-		gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(widget),
-				fraction);
-	gtk_progress_bar_set_text(GTK_PROGRESS_BAR(widget), buf);
+		_builder_dialog_progress(widget, fraction, buf);
 }
 
 
-/* builder_msgbox */
-static void _msgbox_dialog_buttons(GtkWidget * dialog,
-		struct bsddialog_conf const * conf,
-		struct options const * opt);
+/* builder_mixedlist */
+static GtkWidget * _mixedlist_item(struct bsddialog_conf const * conf,
+		struct options const * opt, struct bsddialog_menuitem * item,
+		enum bsddialog_menutype type, GSList ** group);
 
-int builder_msgbox(struct bsddialog_conf const * conf,
+int builder_mixedlist_groups(struct bsddialog_conf const * conf,
 		char const * text, int rows, int cols,
-		int argc, char const ** argv, struct options const * opt)
+		unsigned int ngroups, struct bsddialog_menugroup * groups,
+		int * focuslist, int * focusitem, struct options const * opt)
 {
 	int ret;
 	GtkWidget * dialog;
-
-	if(argc > 0)
-	{
-		error_args(opt->name, argc, argv);
-		return BSDDIALOG_ERROR;
-	}
+	GtkWidget * container;
+	GtkWidget * window;
+	GtkWidget * box;
+	GtkWidget * widget;
+	GtkWidget ** widgets;
+	GSList * group;
+	gboolean selected;
+	unsigned int i, j, k, n;
+
+	for(i = 0, n = 0; i < ngroups; i++)
+		n += groups[i].nitems;
+	if((widgets = malloc(sizeof(*widgets) * (n + 1))) == NULL)
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
 	dialog = _builder_dialog(conf, opt, text, rows, cols);
-	_msgbox_dialog_buttons(dialog, conf, NULL);
-	ret = _builder_dialog_run(conf, dialog);
-	gtk_widget_destroy(dialog);
-	return ret;
-}
+#if GTK_CHECK_VERSION(2, 14, 0)
+	container = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
+#else
+	container = dialog->vbox;
+#endif
+	window = gtk_scrolled_window_new(NULL, NULL);
+	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(window),
+			GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+	if(conf->shadow == false)
+		gtk_scrolled_window_set_shadow_type(GTK_SCROLLED_WINDOW(window),
+				GTK_SHADOW_NONE);
+#if GTK_CHECK_VERSION(3, 0, 0)
+	box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+#else
+	box = gtk_vbox_new(FALSE, 0);
+#endif
+	gtk_container_set_border_width(GTK_CONTAINER(box), BORDER_WIDTH);
+	for(i = 0, k = 0; i < ngroups; i++)
+	{
+		group = NULL;
+		selected = FALSE;
+		if(groups[i].type == BSDDIALOG_RADIOLIST)
+		{
+			/* allows the group to have no item selected */
+			widget = gtk_radio_button_new(NULL);
+			group = gtk_radio_button_get_group(
+					GTK_RADIO_BUTTON(widget));
+			gtk_widget_set_no_show_all(widget, TRUE);
+			gtk_box_pack_start(GTK_BOX(box), widget, FALSE, TRUE,
+					0);
+		}
+		for(j = 0; j < groups[i].nitems; j++, k++)
+		{
+			widgets[k] = _mixedlist_item(conf, opt,
+					&groups[i].items[j], groups[i].type,
+					&group);
+			/* only the first item set is selected */
+			if(groups[i].type == BSDDIALOG_RADIOLIST
+					&& groups[i].items[j].on
+					&& selected == FALSE)
+			{
+				gtk_toggle_button_set_active(
+						GTK_TOGGLE_BUTTON(widgets[k]),
+						TRUE);
+				selected = TRUE;
+			}
+			gtk_box_pack_start(GTK_BOX(box), widgets[k], FALSE,
+					TRUE, 0);
+			if(focuslist != NULL && focusitem != NULL
+					&& *focuslist == (int)i
+					&& *focusitem == (int)j)
+				gtk_widget_grab_focus(widgets[k]);
+		}
+	}
+#if GTK_CHECK_VERSION(3, 8, 0)
+	gtk_container_add(GTK_CONTAINER(window), box);
+#else
+	gtk_scrolled_window_add_with_viewport(GTK_SCROLLED_WINDOW(window), box);
+#endif
+	gtk_box_pack_start(GTK_BOX(container), window, TRUE, TRUE, 0);
+	gtk_widget_show_all(window);
+	_builder_dialog_buttons(dialog, conf, opt);
+	ret = _builder_dialog_run(conf, dialog);
+	for(i = 0, k = 0; i < ngroups; i++)
+		for(j = 0; j < groups[i].nitems; j++, k++)
+		{
+			if(groups[i].type != BSDDIALOG_SEPARATOR)
+				groups[i].items[j].on
+					= gtk_toggle_button_get_active(
+							GTK_TOGGLE_BUTTON(
+								widgets[k]));
+			if(focuslist != NULL && focusitem != NULL
+					&& gtk_widget_has_focus(widgets[k]))
+			{
+				*focuslist = i;
+				*focusitem = j;
+			}
+		}
+	gtk_widget_destroy(dialog);
+	free(widgets);
+	return ret;
+}
+
+static GtkWidget * _mixedlist_item(struct bsddialog_conf const * conf,
+		struct options const * opt, struct bsddialog_menuitem * item,
+		enum bsddialog_menutype type, GSList ** group)
+{
+	GtkWidget * widget;
+	GString * label;
+
+	label = g_string_new(NULL);
+	if(opt->item_prefix && item->prefix != NULL)
+		g_string_append_printf(label, "%s ", item->prefix);
+	if(conf->menu.no_name == false && item->name != NULL)
+		g_string_append(label, item->name);
+	if(conf->menu.no_desc == false && item->desc != NULL)
+		g_string_append_printf(label, "%s%s",
+				(label->len > 0) ? "  " : "", item->desc);
+	switch(type)
+	{
+		case BSDDIALOG_CHECKLIST:
+			widget = gtk_check_button_new_with_label(label->str);
+			gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widget),
+					item->on);
+			break;
+		case BSDDIALOG_RADIOLIST:
+			widget = gtk_radio_button_new_with_label(*group,
+					label->str);
+			*group = gtk_radio_button_get_group(
+					GTK_RADIO_BUTTON(widget));
+			break;
+		case BSDDIALOG_SEPARATOR:
+		default:
+			widget = gtk_label_new(label->str);
+#if GTK_CHECK_VERSION(3, 14, 0)
+			gtk_widget_set_halign(widget, GTK_ALIGN_START);
+#else
+			gtk_misc_set_alignment(GTK_MISC(widget), 0.0, 0.5);
+#endif
+			break;
+	}
+#if GTK_CHECK_VERSION(2, 12, 0)
+	if(opt->item_bottomdesc && item->bottomdesc != NULL)
+		gtk_widget_set_tooltip_text(widget, item->bottomdesc);
+#endif
+	g_string_free(label, TRUE);
+	return widget;
+}
+
+
+/* builder_msgbox */
+static void _msgbox_dialog_buttons(GtkWidget * dialog,
+		struct bsddialog_conf const * conf,
+		struct options const * opt);
+
+int builder_msgbox(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		int argc, char const ** argv, struct options const * opt)
+{
+	int ret;
+	GtkWidget * dialog;
+
+	if(argc > 0)
+	{
+		error_args(opt->name, argc, argv);
+		return BSDDIALOG_ERROR;
+	}
+	dialog = _builder_dialog(conf, opt, text, rows, cols);
+	_msgbox_dialog_buttons(dialog, conf, NULL);
+	ret = _builder_dialog_run(conf, dialog);
+	gtk_widget_destroy(dialog);
+	return ret;
+}
 
 static void _msgbox_dialog_buttons(GtkWidget * dialog,
 		struct bsddialog_conf const * conf,
@@ -1723,8 +2581,13 @@ int builder_passwordbox(struct bsddialog_conf const * conf,
 	{
 		case BSDDIALOG_EXTRA:
 		case BSDDIALOG_OK:
-			dprintf(opt->output_fd, "%s\n",
-					gtk_entry_buffer_get_text(buffer));
+			if(opt->result != NULL)
+				output_value(opt->result,
+						gtk_entry_buffer_get_text(buffer));
+			else
+				output_dprintf(opt->output_fd, "%s\n",
+						gtk_entry_buffer_get_text(
+							buffer));
 			break;
 	}
 	g_object_unref(buffer);
@@ -1761,10 +2624,6 @@ int builder_pause(struct bsddialog_conf const * conf,
 		char const * text, int rows, int cols,
 		int argc, char const ** argv, struct options const * opt)
 {
-	int ret;
-	struct pause_data pd;
-	GtkWidget * container;
-
 	if(argc <= 0)
 	{
 		error_args(opt->name, argc, argv);
@@ -1775,7 +2634,20 @@ int builder_pause(struct bsddialog_conf const * conf,
 		error_args(opt->name, argc - 1, argv + 1);
 		return BSDDIALOG_ERROR;
 	}
-	pd.secs = strtoul(argv[0], NULL, 10);
+	return builder_pause_seconds(conf, text, rows, cols,
+			strtoul(argv[0], NULL, 10), opt);
+}
+
+int builder_pause_seconds(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, unsigned int seconds,
+		struct options const * opt)
+{
+	int ret;
+	struct pause_data pd;
+	GtkWidget * container;
+	char buf[16];
+
+	pd.secs = seconds;
 	pd.dialog = _builder_dialog(conf, opt, text, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	container = gtk_dialog_get_content_area(GTK_DIALOG(pd.dialog));
@@ -1786,7 +2658,8 @@ int builder_pause(struct bsddialog_conf const * conf,
 #if GTK_CHECK_VERSION(3, 0, 0)
 	gtk_progress_bar_set_show_text(GTK_PROGRESS_BAR(pd.widget), TRUE);
 #endif
-	gtk_progress_bar_set_text(GTK_PROGRESS_BAR(pd.widget), argv[0]);
+	snprintf(buf, sizeof(buf), "%u", pd.secs);
+	gtk_progress_bar_set_text(GTK_PROGRESS_BAR(pd.widget), buf);
 	gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(pd.widget), 1.0);
 	pd.step = (pd.secs > 0) ? 1.0 / (gdouble) pd.secs : 1.0;
 	gtk_progress_bar_set_pulse_step(GTK_PROGRESS_BAR(pd.widget), pd.step);
@@ -1829,36 +2702,26 @@ static gboolean _pause_on_timeout(gpointer data)
 
 
 /* builder_radiolist */
-static gboolean _radiolist_foreach_response(GtkTreeModel * model,
-		GtkTreePath * path, GtkTreeIter * iter, gpointer data);
-static GtkTreeIter * _radiolist_get_parent(GtkTreeModel * model,
-		GtkTreeIter * iter, int depth, char const * name);
-static gboolean _radiolist_get_parent_foreach(GtkTreeModel * model,
-		GtkTreePath * path, GtkTreeIter * iter, gpointer data);
+static int _builder_radiolist_model(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, MenuModel * model,
+		struct menustream_data * stream, int * focusitem,
+		struct options const * opt);
 static void _radiolist_on_row_activated(GtkWidget * widget, GtkTreePath * path,
 		GtkTreeViewColumn * column, gpointer data);
 static void _radiolist_on_row_toggled(GtkCellRenderer * renderer, char * path,
 		gpointer data);
-static gboolean _radiolist_on_row_toggled_foreach(GtkTreeModel * model,
-		GtkTreePath * path, GtkTreeIter * iter, gpointer data);
+static int _radiolist_output(struct options const * opt, int ret,
+		struct bsddialog_menuitem const * items, int radio, int focus);
 
 int builder_radiolist(struct bsddialog_conf const * conf,
 		char const * text, int rows, int cols,
 		int argc, char const ** argv, struct options const * opt)
 {
 	int ret;
-	GtkWidget * dialog;
-	GtkWidget * container;
-	GtkWidget * window;
-	GtkWidget * widget;
-	GtkTreeStore * store;
-	GtkTreeIter iter, parent, * pparent = NULL;
-	GtkCellRenderer * renderer;
-	GtkTreeViewColumn * column;
-	GtkTreeSelection * treesel;
-	int i, j, k, n, depth = 0;
-	gboolean set;
-	char const * prefix = NULL, * name, * desc, * tooltip;
+	struct bsddialog_menuitem * items;
+	MenuModel * model;
+	struct menustream_data * stream = NULL;
+	int j, n, focus = -1;
 
 	j = opt->item_bottomdesc ? 4 : 3;
 	if(opt->item_prefix)
@@ -1878,15 +2741,69 @@ int builder_radiolist(struct bsddialog_conf const * conf,
 	}
 	else if(n == 0)
 		n = (argc - 1) / j;
+	if((items = _builder_dialog_menu_items_new(opt, argc - 1, argv + 1,
+					j, TRUE, FALSE)) == NULL)
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
+	if((model = menumodel_new(items, (argc - 1) / j,
+					opt->items_from != NULL
+					&& opt->item_depth)) == NULL)
+	{
+		free(items);
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
+	}
+	if(opt->items_from != NULL && (stream = _builder_dialog_menu_stream(
+					conf, opt, model, j, TRUE, FALSE))
+					== NULL)
+		ret = BSDDIALOG_ERROR;
+	else
+		ret = _builder_radiolist_model(conf, text, rows, cols, model,
+				stream, &focus, opt);
+	_radiolist_output(opt, ret, menumodel_get_items(model),
+			menumodel_get_radio(model), focus);
+	_builder_dialog_menu_stream_delete(stream);
+	g_object_unref(model);
+	free(items);
+	return ret;
+}
+
+int builder_radiolist_items(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int nitems, struct bsddialog_menuitem * items,
+		int * focusitem, struct options const * opt)
+{
+	int ret;
+	MenuModel * model;
+
+	if((model = menumodel_new(items, nitems, FALSE)) == NULL)
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
+	ret = _builder_radiolist_model(conf, text, rows, cols, model, NULL,
+			focusitem, opt);
+	g_object_unref(model);
+	return ret;
+}
+
+static int _builder_radiolist_model(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, MenuModel * model,
+		struct menustream_data * stream, int * focusitem,
+		struct options const * opt)
+{
+	int ret;
+	GtkWidget * dialog;
+	GtkWidget * container;
+	GtkWidget * window;
+	GtkWidget * widget;
+	GtkCellRenderer * renderer;
+	GtkTreeViewColumn * column;
+	GtkTreeSelection * treesel;
+	struct menufilter_data * filter;
+
+	menumodel_set_radiolist(model);
 	dialog = _builder_dialog(conf, opt, text, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	container = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
 #else
 	container = dialog->vbox;
 #endif
-	store = gtk_tree_store_new(RTS_COUNT, G_TYPE_STRING, G_TYPE_BOOLEAN,
-			G_TYPE_INT, G_TYPE_STRING, G_TYPE_STRING,
-			G_TYPE_STRING);
 	window = gtk_scrolled_window_new(NULL, NULL);
 	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(window),
 			GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
@@ -1895,47 +2812,16 @@ int builder_radiolist(struct bsddialog_conf const * conf,
 				GTK_SHADOW_NONE);
 	widget = gtk_tree_view_new();
 	gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(widget), FALSE);
-	gtk_tree_view_set_model(GTK_TREE_VIEW(widget), GTK_TREE_MODEL(store));
 	if(opt->item_bottomdesc)
-		gtk_tree_view_set_tooltip_column(GTK_TREE_VIEW(widget),
-				RTS_TOOLTIP);
+		_builder_dialog_menu_tooltip(widget);
 	treesel = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
 	gtk_tree_selection_set_mode(treesel, GTK_SELECTION_BROWSE);
-	for(i = 0, set = FALSE; (i + 1) * j < argc; i++)
-	{
-		k = i * j + 1;
-		if(opt->item_prefix)
-			prefix = argv[k++];
-		if(opt->item_depth)
-		{
-			depth = strtol(argv[k++], NULL, 10);
-#ifdef DEBUG
-			fprintf(stderr, "DEBUG: %s() depth=%d\n", __func__,
-					depth);
-#endif
-			pparent = _radiolist_get_parent(GTK_TREE_MODEL(store),
-					&parent, depth, argv[k]);
-		}
-		name = argv[k++];
-		desc = argv[k++];
-		set = (set == FALSE && strcasecmp(argv[k], "on") == 0)
-			? TRUE : FALSE;
-		tooltip = (++k < j) ? argv[k] : NULL;
-		gtk_tree_store_append(store, &iter, pparent);
-		gtk_tree_store_set(store, &iter, RTS_PREFIX, prefix,
-				RTS_SET, set, RTS_DEPTH, depth,
-				RTS_NAME, name, RTS_DESCRIPTION, desc,
-				(tooltip != NULL) ? RTS_TOOLTIP : -1,
-				(tooltip != NULL) ? tooltip : NULL, -1);
-		if(opt->item_default != NULL
-				&& strcmp(name, opt->item_default) == 0)
-			gtk_tree_selection_select_iter(treesel, &iter);
-	}
+	_builder_dialog_menu_view(widget, model, stream, opt, focusitem);
 	if(opt->item_prefix == true)
 	{
 		column = gtk_tree_view_column_new_with_attributes(NULL,
 				gtk_cell_renderer_text_new(),
-				"text", RTS_PREFIX, NULL);
+				"text", MMC_PREFIX, NULL);
 		gtk_tree_view_column_set_expand(column, FALSE);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
 	}
@@ -1943,15 +2829,15 @@ int builder_radiolist(struct bsddialog_conf const * conf,
 	gtk_cell_renderer_toggle_set_radio(GTK_CELL_RENDERER_TOGGLE(renderer),
 			TRUE);
 	g_signal_connect(renderer, "toggled",
-			G_CALLBACK(_radiolist_on_row_toggled), store);
+			G_CALLBACK(_radiolist_on_row_toggled), model);
 	column = gtk_tree_view_column_new_with_attributes(NULL, renderer,
-			"active", RTS_SET, NULL);
+			"active", MMC_SET, NULL);
 	gtk_tree_view_column_set_expand(column, FALSE);
 	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
 	if(conf->menu.no_name == false)
 	{
 		column = gtk_tree_view_column_new_with_attributes(NULL,
-				gtk_cell_renderer_text_new(), "text", RTS_NAME,
+				gtk_cell_renderer_text_new(), "text", MMC_NAME,
 				NULL);
 		gtk_tree_view_column_set_expand(column, FALSE);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
@@ -1960,100 +2846,26 @@ int builder_radiolist(struct bsddialog_conf const * conf,
 	{
 		column = gtk_tree_view_column_new_with_attributes(NULL,
 				gtk_cell_renderer_text_new(), "text",
-				RTS_DESCRIPTION, NULL);
+				MMC_DESCRIPTION, NULL);
 		gtk_tree_view_column_set_expand(column, TRUE);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
 	}
-	if(opt->item_depth)
-		gtk_tree_view_expand_all(GTK_TREE_VIEW(widget));
+	_builder_dialog_menu_large(widget, model, opt);
 	g_signal_connect(widget, "row-activated",
 			G_CALLBACK(_radiolist_on_row_activated), NULL);
+	filter = _builder_dialog_menu_filter(container, widget, model, stream,
+			opt);
 	gtk_container_add(GTK_CONTAINER(window), widget);
 	gtk_box_pack_start(GTK_BOX(container), window, TRUE, TRUE, 0);
 	gtk_widget_show_all(window);
 	_builder_dialog_buttons(dialog, conf, opt);
 	ret = _builder_dialog_run(conf, dialog);
-	switch(ret)
-	{
-		case BSDDIALOG_HELP:
-			_builder_dialog_menu_output(opt, treesel,
-					GTK_TREE_MODEL(store), RTS_NAME,
-					"HELP ");
-			break;
-		case BSDDIALOG_EXTRA:
-		case BSDDIALOG_OK:
-			gtk_tree_model_foreach(GTK_TREE_MODEL(store),
-					_radiolist_foreach_response,
-					(gpointer)opt);
-			break;
-	}
+	_builder_dialog_menu_focus(treesel, model, focusitem);
+	_builder_dialog_menu_filter_delete(filter);
 	gtk_widget_destroy(dialog);
 	return ret;
 }
 
-static gboolean _radiolist_foreach_response(GtkTreeModel * model,
-		GtkTreePath * path, GtkTreeIter * iter, gpointer data)
-{
-	struct options const * opt = data;
-	gboolean set;
-	gchar * p;
-	gboolean toquote;
-	char quotech;
-	(void) path;
-
-	gtk_tree_model_get(model, iter, RTS_SET, &set, -1);
-	if(set == FALSE)
-		return FALSE;
-	gtk_tree_model_get(model, iter, RTS_NAME, &p, -1);
-	toquote = FALSE;
-	if(string_needs_quoting(p))
-		toquote = opt->item_always_quote;
-	if(toquote)
-	{
-		quotech = opt->item_singlequote ? '\'' : '"';
-		dprintf(opt->output_fd, "%c%s%c\n", quotech, p, quotech);
-	}
-	else
-		dprintf(opt->output_fd, "%s\n", p);
-	g_free(p);
-	return TRUE;
-}
-
-static GtkTreeIter * _radiolist_get_parent(GtkTreeModel * model,
-		GtkTreeIter * parent, int depth, char const * name)
-{
-	struct radiolist_data rd;
-
-	if(depth <= 0)
-		return NULL;
-	rd.depth = depth;
-	rd.parent = parent;
-	rd.pparent = NULL;
-	rd.name = name;
-	gtk_tree_model_foreach(model, _radiolist_get_parent_foreach, &rd);
-	return rd.pparent;
-}
-
-static gboolean _radiolist_get_parent_foreach(GtkTreeModel * model,
-		GtkTreePath * path, GtkTreeIter * iter, gpointer data)
-{
-	struct radiolist_data * rd = data;
-	int d;
-	(void) path;
-
-	gtk_tree_model_get(model, iter, RTS_DEPTH, &d, -1);
-	if(d < rd->depth)
-	{
-		*(rd->parent) = *iter;
-		rd->pparent = rd->parent;
-#ifdef DEBUG
-		fprintf(stderr, "DEBUG: %s(\"%s\") %d < %d\n", __func__,
-				rd->name, d, rd->depth);
-#endif
-	}
-	return FALSE;
-}
-
 static void _radiolist_on_row_activated(GtkWidget * widget, GtkTreePath * path,
 		GtkTreeViewColumn * column, gpointer data)
 {
@@ -2063,16 +2875,15 @@ static void _radiolist_on_row_activated(GtkWidget * widget, GtkTreePath * path,
 	(void) data;
 
 	model = gtk_tree_view_get_model(GTK_TREE_VIEW(widget));
-	gtk_tree_model_foreach(model, _radiolist_on_row_toggled_foreach, NULL);
 	if(gtk_tree_model_get_iter(model, &iter, path) == FALSE)
 		return;
-	gtk_tree_store_set(GTK_TREE_STORE(model), &iter, RTS_SET, TRUE, -1);
+	menumodel_set_radio(MENUMODEL(model), &iter);
 }
 
 static void _radiolist_on_row_toggled(GtkCellRenderer * renderer, char * path,
 		gpointer data)
 {
-	GtkTreeStore * store = data;
+	MenuModel * model = data;
 	GtkTreePath * tp;
 	GtkTreeIter iter;
 	gboolean b;
@@ -2080,31 +2891,31 @@ static void _radiolist_on_row_toggled(GtkCellRenderer * renderer, char * path,
 
 	if((tp = gtk_tree_path_new_from_string(path)) == NULL)
 		return;
-	gtk_tree_model_foreach(GTK_TREE_MODEL(store),
-			_radiolist_on_row_toggled_foreach, NULL);
-	b = gtk_tree_model_get_iter(GTK_TREE_MODEL(store), &iter, tp);
+	b = gtk_tree_model_get_iter(GTK_TREE_MODEL(model), &iter, tp);
 	gtk_tree_path_free(tp);
 	if(b == FALSE)
 		return;
-	gtk_tree_store_set(store, &iter, RTS_SET, TRUE, -1);
+	menumodel_set_radio(model, &iter);
 }
 
-static gboolean _radiolist_on_row_toggled_foreach(GtkTreeModel * model,
-		GtkTreePath * path, GtkTreeIter * iter, gpointer data)
+static int _radiolist_output(struct options const * opt, int ret,
+		struct bsddialog_menuitem const * items, int radio, int focus)
 {
-	gboolean set;
-	(void) path;
-	(void) data;
-
-	gtk_tree_model_get(model, iter, RTS_SET, &set, -1);
-	if(set)
+	switch(ret)
 	{
-		/* XXX assumes only one row is set */
-		gtk_tree_store_set(GTK_TREE_STORE(model), iter, RTS_SET, FALSE,
-				-1);
-		return TRUE;
+		case BSDDIALOG_HELP:
+			if(focus >= 0)
+				_builder_dialog_menu_output(opt,
+						items[focus].name, "HELP ");
+			break;
+		case BSDDIALOG_EXTRA:
+		case BSDDIALOG_OK:
+			if(radio >= 0)
+				_builder_dialog_menu_output(opt,
+						items[radio].name, NULL);
+			break;
 	}
-	return FALSE;
+	return ret;
 }
 
 
@@ -2114,15 +2925,9 @@ int builder_rangebox(struct bsddialog_conf const * conf,
 		int argc, char const ** argv, struct options const * opt)
 {
 	int ret;
-	GtkWidget * dialog;
-	GtkWidget * box;
-	GtkWidget * widget;
-	int value = 0, min, max;
+	int value, min, max;
 
-	if(argc == 3)
-		/* XXX detect and report errors */
-		value = strtol(argv[2], NULL, 10);
-	else if(argc < 2 || argc > 3)
+	if(argc < 2 || argc > 3)
 	{
 		error_args(opt->name, argc, argv);
 		return BSDDIALOG_ERROR;
@@ -2135,6 +2940,32 @@ int builder_rangebox(struct bsddialog_conf const * conf,
 		exit(EXITCODE(BSDDIALOG_ERROR));
 		return BSDDIALOG_ERROR;
 	}
+	/* XXX detect and report errors */
+	value = (argc == 3) ? strtol(argv[2], NULL, 10) : min;
+	ret = builder_rangebox_values(conf, text, rows, cols, min, max, &value,
+			opt);
+	switch(ret)
+	{
+		case BSDDIALOG_EXTRA:
+		case BSDDIALOG_OK:
+			if(opt->result != NULL)
+				output_value_printf(opt->result, "%d", value);
+			else
+				output_dprintf(opt->output_fd, "%d\n", value);
+			break;
+	}
+	return ret;
+}
+
+int builder_rangebox_values(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, int min, int max,
+		int * value, struct options const * opt)
+{
+	int ret;
+	GtkWidget * dialog;
+	GtkWidget * box;
+	GtkWidget * widget;
+
 	dialog = _builder_dialog(conf, opt, text, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	box = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
@@ -2147,33 +2978,37 @@ int builder_rangebox(struct bsddialog_conf const * conf,
 #else
 	widget = gtk_hscale_new_with_range((gdouble)min, (gdouble)max, 1.0);
 #endif
-	if(argc == 3)
-		gtk_range_set_value(GTK_RANGE(widget), (gdouble)value);
+	gtk_range_set_value(GTK_RANGE(widget), (gdouble)*value);
 	gtk_widget_show(widget);
 	gtk_box_pack_start(GTK_BOX(box), widget, FALSE, TRUE, BORDER_WIDTH);
 	_builder_dialog_buttons(dialog, conf, opt);
 	ret = _builder_dialog_run(conf, dialog);
-	value = gtk_range_get_value(GTK_RANGE(widget));
+	*value = gtk_range_get_value(GTK_RANGE(widget));
 	gtk_widget_destroy(dialog);
-	switch(ret)
-	{
-		case BSDDIALOG_EXTRA:
-		case BSDDIALOG_OK:
-			dprintf(opt->output_fd, "%d\n", value);
-			break;
-	}
 	return ret;
 }
 
 
 /* builder_textbox */
-static gboolean _textbox_on_can_read(GIOChannel * channel,
-		GIOCondition condition, gpointer data);
 static gboolean _textbox_on_can_read_eof(gpointer data);
-#ifdef WITH_XDIALOG
-static gboolean _textbox_on_can_read_scroll(gpointer data);
-#endif
+static size_t _textbox_on_feed(char const * buf, size_t len, gboolean last,
+		gpointer data);
+static gboolean _textbox_on_frame(gpointer data);
 static gboolean _textbox_on_idle(gpointer data);
+static gboolean _textbox_on_map_frame(gpointer data);
+static void _textbox_on_map_index(gpointer data);
+static gboolean _textbox_on_map_jump(GtkRange * range, GtkScrollType scroll,
+		gdouble value, gpointer data);
+static void _textbox_on_map_move(GtkTextView * view, GtkMovementStep step,
+		gint count, gboolean extend, gpointer data);
+static void _textbox_on_map_scroll(gpointer data);
+static gboolean _textbox_on_read(char const * buf, size_t len,
+		GError const * error, gpointer data);
+static void _textbox_insert(struct textbox_data * td, GtkTextIter * iter,
+		char const * text, size_t len);
+static void _textbox_map(struct textbox_data * td);
+static void _textbox_map_lines(struct textbox_data * td, size_t first,
+		size_t last);
 #if GTK_CHECK_VERSION(2, 10, 0)
 # ifdef WITH_XDIALOG
 static void _textbox_on_print(gpointer data);
@@ -2204,6 +3039,13 @@ int builder_textbox(struct bsddialog_conf const * conf,
 	td.button = NULL;
 #endif
 	td.filename = text;
+	td.exec = NULL;
+	td.eof = FALSE;
+	td.reader = NULL;
+	td.done = FALSE;
+	td.feed = NULL;
+	td.frame = 0;
+	td.map = NULL;
 	td.dialog = _builder_dialog(conf, opt, NULL, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	container = gtk_dialog_get_content_area(GTK_DIALOG(td.dialog));
@@ -2286,54 +3128,24 @@ int builder_textbox(struct bsddialog_conf const * conf,
 	ret = _builder_dialog_run(conf, td.dialog);
 	if(td.id != 0)
 		g_source_remove(td.id);
+	if(td.frame != 0)
+		_builder_dialog_frame_cancel(td.view, td.frame);
+	if(td.reader != NULL)
+		reader_delete(td.reader);
 	gtk_widget_destroy(td.dialog);
+	if(td.feed != NULL)
+		feed_delete(td.feed);
+	if(td.map != NULL)
+		textmap_delete(td.map);
 #ifdef WITH_XDIALOG
 	if(desc != NULL)
 		pango_font_description_free(desc);
 #endif
+	if(td.exec != NULL)
+		ret = _builder_dialog_exec_wait(td.exec, td.eof, ret);
 	return ret;
 }
 
-static gboolean _textbox_on_can_read(GIOChannel * channel,
-		GIOCondition condition, gpointer data)
-{
-	struct textbox_data * td = data;
-	GIOStatus status;
-	char buf[BUFSIZ];
-	gsize r;
-	GError * error = NULL;
-
-#ifdef DEBUG
-	fprintf(stderr, "DEBUG: %s()\n", __func__);
-#endif
-	if(condition != G_IO_IN)
-	{
-		_builder_dialog_error(td->dialog, NULL, NULL,
-				"Unexpected condition");
-		return _textbox_on_can_read_eof(td);
-	}
-	status = g_io_channel_read_chars(channel, buf, sizeof(buf), &r, &error);
-	if(status == G_IO_STATUS_ERROR)
-	{
-		_builder_dialog_error(td->dialog, NULL, NULL, error->message);
-		g_error_free(error);
-		return _textbox_on_can_read_eof(td);
-	}
-	else if(status == G_IO_STATUS_AGAIN)
-		return TRUE;
-	else if(status == G_IO_STATUS_EOF)
-		return _textbox_on_can_read_eof(td);
-	gtk_text_buffer_insert(td->buffer, &td->iter, buf, r);
-#ifdef WITH_XDIALOG
-	if(td->scroll)
-	{
-		td->id = g_idle_add(_textbox_on_can_read_scroll, td);
-		return FALSE;
-	}
-#endif
-	return TRUE;
-}
-
 static gboolean _textbox_on_can_read_eof(gpointer data)
 {
 	struct textbox_data * td = data;
@@ -2349,56 +3161,392 @@ static gboolean _textbox_on_can_read_eof(gpointer data)
 	return FALSE;
 }
 
-#ifdef WITH_XDIALOG
-static gboolean _textbox_on_can_read_scroll(gpointer data)
+static size_t _textbox_on_feed(char const * buf, size_t len, gboolean last,
+		gpointer data)
 {
 	struct textbox_data * td = data;
+	size_t i;
 
-	gtk_text_view_scroll_to_iter(GTK_TEXT_VIEW(td->view), &td->iter,
-			0.0, TRUE, 0.0, 1.0);
-	td->id = g_io_add_watch(td->channel, G_IO_IN, _textbox_on_can_read, td);
-	return FALSE;
+	/* only complete characters until the end */
+	for(i = len; !last && i > 0 && len - i < 4; i--)
+		if((buf[i - 1] & 0xc0) != 0x80)
+		{
+			if(g_utf8_get_char_validated(&buf[i - 1], len - i + 1)
+					== (gunichar)-2)
+				len = i - 1;
+			break;
+		}
+	if(len == 0)
+		return 0;
+	/* the buffer may have been edited meanwhile */
+	gtk_text_buffer_get_end_iter(td->buffer, &td->iter);
+	_textbox_insert(td, &td->iter, buf, len);
+	return len;
 }
-#endif
 
-static gboolean _textbox_on_idle(gpointer data)
+static gboolean _textbox_on_frame(gpointer data)
 {
 	struct textbox_data * td = data;
-	char buf[BUFSIZ];
-	gboolean close = TRUE;
+	gboolean more;
 
+	more = feed_flush(td->feed);
 #ifdef WITH_XDIALOG
-	if(strcmp(td->filename, "-") == 0)
-	{
-		td->fd = STDIN_FILENO;
-		close = FALSE;
+	if(td->scroll)
+		gtk_text_view_scroll_to_mark(GTK_TEXT_VIEW(td->view),
+				gtk_text_buffer_get_mark(td->buffer, "end"),
+				0.0, TRUE, 0.0, 1.0);
+#endif
+	if(!td->done && !feed_is_full(td->feed))
+		reader_resume(td->reader);
+	if(more)
+		return TRUE;
+	td->frame = 0;
+	/* everything was read and inserted */
+	if(td->done)
+		_textbox_on_can_read_eof(td);
+	return FALSE;
+}
+
+static gboolean _textbox_on_idle(gpointer data)
+{
+	struct textbox_data * td = data;
+	size_t map = TEXTBOX_MAP_SIZE;
+	GError * error = NULL;
+
+	td->id = 0;
+	gtk_text_buffer_get_start_iter(td->buffer, &td->iter);
+#ifdef WITH_XDIALOG
+	if(td->scroll)
+		gtk_text_buffer_create_mark(td->buffer, "end", &td->iter,
+				FALSE);
+#endif
+	td->feed = feed_new(_textbox_on_feed, td);
+	/* the file is a command to run instead */
+	if(td->opt->textbox_exec)
+	{
+		if((td->exec = _builder_dialog_exec(td->filename, TRUE, td->opt,
+						&error)) == NULL)
+		{
+			_builder_dialog_error(td->dialog, NULL, NULL,
+					error->message);
+			g_error_free(error);
+			gtk_dialog_response(GTK_DIALOG(td->dialog),
+					BSDDIALOG_ERROR);
+			return FALSE;
+		}
+		td->reader = reader_new_fd(exec_get_fd(td->exec), TRUE,
+				_textbox_on_read, td);
 	}
 	else
+#ifdef WITH_XDIALOG
+	if(strcmp(td->filename, "-") == 0)
+		td->reader = reader_new_fd(STDIN_FILENO, FALSE,
+				_textbox_on_read, td);
+	else
 #endif
-	if((td->fd = open(td->filename, O_RDONLY)) <= -1)
 	{
-		snprintf(buf, sizeof(buf), "%s: %s", td->filename,
-				strerror(errno));
-		_builder_dialog_error(td->dialog, NULL, NULL, buf);
-		gtk_dialog_response(GTK_DIALOG(td->dialog), BSDDIALOG_ERROR);
-		td->id = 0;
+		/* large files are shown as they are scrolled instead, unless
+		 * the whole text is needed */
+		if(td->editable
 #ifdef WITH_XDIALOG
-		if(td->button != NULL)
-			gtk_widget_set_sensitive(td->button, TRUE);
+				|| td->scroll || td->opt->print != NULL
 #endif
+				)
+			map = 0;
+		/* opened and read in a thread */
+		td->reader = reader_new_file(td->filename, map,
+				_textbox_on_read, _textbox_on_map_index, td);
+	}
+	if(td->reader == NULL)
+	{
+		_builder_dialog_error(td->dialog, NULL, NULL,
+				"Could not start reading");
+		gtk_dialog_response(GTK_DIALOG(td->dialog), BSDDIALOG_ERROR);
+	}
+	return FALSE;
+}
+
+static gboolean _textbox_on_map_frame(gpointer data)
+{
+	struct textbox_data * td = data;
+	GtkAdjustment * adjustment;
+	gdouble value;
+	gdouble page;
+	size_t lines;
+	size_t first;
+	size_t last;
+	int jump = td->jump;
+	GtkTextIter iter;
+
+	td->frame = 0;
+	td->jump = 0;
+	adjustment = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(
+				gtk_widget_get_parent(td->view)));
+	value = gtk_adjustment_get_value(adjustment);
+	page = gtk_adjustment_get_page_size(adjustment);
+	lines = textmap_get_lines(td->map);
+	/* directly to either end of the file */
+	if(jump != 0 && (jump > 0 ? td->last < lines : td->first > 0))
+	{
+		first = (jump > 0 && lines > TEXTBOX_MAP_LINES)
+			? lines - TEXTBOX_MAP_LINES : 0;
+		last = MIN(first + TEXTBOX_MAP_LINES, lines);
+		_textbox_map_lines(td, first, last);
+		if(jump > 0)
+			gtk_text_buffer_get_end_iter(td->buffer, &iter);
+		else
+			gtk_text_buffer_get_start_iter(td->buffer, &iter);
+		gtk_text_buffer_move_mark(td->buffer, td->top, &iter);
+		gtk_text_view_scroll_to_mark(GTK_TEXT_VIEW(td->view), td->top,
+				0.0, TRUE, 0.0, (jump > 0) ? 1.0 : 0.0);
 		return FALSE;
 	}
-	td->channel = g_io_channel_unix_new(td->fd);
-	g_io_channel_set_close_on_unref(td->channel, close);
-	g_io_channel_set_encoding(td->channel, NULL, NULL);
-	/* XXX ignore errors */
-	g_io_channel_set_flags(td->channel, g_io_channel_get_flags(td->channel)
-			| G_IO_FLAG_NONBLOCK, NULL);
-	td->id = g_io_add_watch(td->channel, G_IO_IN, _textbox_on_can_read, td);
-	gtk_text_buffer_get_start_iter(td->buffer, &td->iter);
+	/* within a page of either end of the buffer */
+	if(value < page && td->first > 0)
+	{
+		first = (td->first > TEXTBOX_MAP_SHIFT)
+			? td->first - TEXTBOX_MAP_SHIFT : 0;
+		last = MIN(td->last, first + TEXTBOX_MAP_LINES);
+	}
+	else if(value + page * 2 > gtk_adjustment_get_upper(adjustment)
+			&& td->last < lines)
+	{
+		last = MIN(td->last + TEXTBOX_MAP_SHIFT, lines);
+		first = (last - td->first > TEXTBOX_MAP_LINES)
+			? last - TEXTBOX_MAP_LINES : td->first;
+	}
+	else
+		return FALSE;
+	_textbox_map_lines(td, first, last);
+	/* keep the same line on top */
+	gtk_text_view_scroll_to_mark(GTK_TEXT_VIEW(td->view), td->top, 0.0,
+			TRUE, 0.0, 0.0);
+	return FALSE;
+}
+
+static void _textbox_on_map_index(gpointer data)
+{
+	struct textbox_data * td = data;
+	size_t lines;
+
+	/* indexed by the reader */
+	if(td->map == NULL)
+	{
+		if((td->map = reader_take_map(td->reader)) == NULL)
+			return;
+		_textbox_map(td);
+	}
+	/* fill the buffer as soon as possible */
+	lines = textmap_get_lines(td->map);
+	if(td->last - td->first < TEXTBOX_MAP_LINES && td->last < lines)
+		_textbox_map_lines(td, td->first, MIN(td->first
+					+ TEXTBOX_MAP_LINES, lines));
+}
+
+static gboolean _textbox_on_map_jump(GtkRange * range, GtkScrollType scroll,
+		gdouble value, gpointer data)
+{
+	struct textbox_data * td = data;
+	GtkAdjustment * adjustment;
+
+	/* only when dragged or sent to either end of the scrollbar */
+	if(scroll != GTK_SCROLL_JUMP && scroll != GTK_SCROLL_START
+			&& scroll != GTK_SCROLL_END)
+		return FALSE;
+	adjustment = gtk_range_get_adjustment(range);
+	if(value + gtk_adjustment_get_page_size(adjustment)
+			>= gtk_adjustment_get_upper(adjustment))
+		td->jump = 1;
+	else if(value <= gtk_adjustment_get_lower(adjustment))
+		td->jump = -1;
+	else
+		return FALSE;
+	_textbox_on_map_scroll(td);
 	return FALSE;
 }
 
+static void _textbox_on_map_move(GtkTextView * view, GtkMovementStep step,
+		gint count, gboolean extend, gpointer data)
+{
+	struct textbox_data * td = data;
+	(void) view;
+	(void) extend;
+
+	if(step != GTK_MOVEMENT_BUFFER_ENDS)
+		return;
+	td->jump = (count > 0) ? 1 : -1;
+	_textbox_on_map_scroll(td);
+}
+
+static void _textbox_on_map_scroll(gpointer data)
+{
+	struct textbox_data * td = data;
+
+	if(td->frame == 0)
+		td->frame = _builder_dialog_frame(td->view,
+				_textbox_on_map_frame, td);
+}
+
+static gboolean _textbox_on_read(char const * buf, size_t len,
+		GError const * error, gpointer data)
+{
+	struct textbox_data * td = data;
+	char const * p = buf;
+
+	if(buf == NULL)
+	{
+		td->done = TRUE;
+		if(error != NULL)
+		{
+			_builder_dialog_error(td->dialog, NULL, NULL,
+					error->message);
+			/* nothing could be read at all */
+			if(gtk_text_buffer_get_char_count(td->buffer) == 0
+					&& feed_get_pending(td->feed) == 0)
+				gtk_dialog_response(GTK_DIALOG(td->dialog),
+						BSDDIALOG_ERROR);
+		}
+		else if(td->exec != NULL)
+		{
+			/* the last line may be incomplete */
+			if((p = exec_filter(td->exec, NULL, 0, &len)) != NULL)
+				feed_append(td->feed, p, len);
+			td->eof = TRUE;
+		}
+		else if(td->map != NULL)
+		{
+			/* indexed entirely */
+			_textbox_on_can_read_eof(td);
+			return FALSE;
+		}
+		/* the rest is inserted by the next frames first */
+		feed_close(td->feed);
+	}
+	else
+	{
+		if(td->exec != NULL)
+			p = exec_filter(td->exec, buf, len, &len);
+		/* inserted within the time budget of the next frames */
+		feed_append(td->feed, p, len);
+	}
+	if(td->frame == 0)
+		td->frame = _builder_dialog_frame(td->view, _textbox_on_frame,
+				td);
+	/* paused until enough is inserted */
+	return feed_is_full(td->feed) ? FALSE : TRUE;
+}
+
+/* the text is made valid first if necessary */
+static void _textbox_insert(struct textbox_data * td, GtkTextIter * iter,
+		char const * text, size_t len)
+{
+#if GLIB_CHECK_VERSION(2, 52, 0)
+	gchar * valid;
+#else
+	char const * end;
+#endif
+
+	if(g_utf8_validate(text, len, NULL))
+	{
+		gtk_text_buffer_insert(td->buffer, iter, text, len);
+		return;
+	}
+#if GLIB_CHECK_VERSION(2, 52, 0)
+	valid = g_utf8_make_valid(text, len);
+	gtk_text_buffer_insert(td->buffer, iter, valid, -1);
+	g_free(valid);
+#else
+	/* every invalid byte is replaced, as with g_utf8_make_valid() */
+	for(; !g_utf8_validate(text, len, &end); len -= end + 1 - text,
+			text = end + 1)
+	{
+		gtk_text_buffer_insert(td->buffer, iter, text, end - text);
+		gtk_text_buffer_insert(td->buffer, iter, "\xef\xbf\xbd", 3);
+	}
+	gtk_text_buffer_insert(td->buffer, iter, text, len);
+#endif
+}
+
+static void _textbox_map(struct textbox_data * td)
+{
+	GtkAdjustment * adjustment;
+
+	td->first = 0;
+	td->last = 0;
+	td->jump = 0;
+	td->truncated = FALSE;
+	/* stays after the lines inserted before */
+	td->top = gtk_text_buffer_create_mark(td->buffer, NULL, &td->iter,
+			FALSE);
+	adjustment = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(
+				gtk_widget_get_parent(td->view)));
+	g_signal_connect_swapped(adjustment, "value-changed", G_CALLBACK(
+				_textbox_on_map_scroll), td);
+	/* the buffer only holds part of the file */
+	g_signal_connect(gtk_scrolled_window_get_vscrollbar(GTK_SCROLLED_WINDOW(
+					gtk_widget_get_parent(td->view))),
+			"change-value", G_CALLBACK(_textbox_on_map_jump), td);
+	g_signal_connect(td->view, "move-cursor", G_CALLBACK(
+				_textbox_on_map_move), td);
+}
+
+/* replaces the lines in the buffer, only adding or removing at the ends */
+static void _textbox_map_lines(struct textbox_data * td, size_t first,
+		size_t last)
+{
+	GtkTextIter start;
+	GtkTextIter end;
+	gint y;
+	char const * text;
+	size_t len;
+
+	if(td->truncated)
+		return;
+	if(textmap_is_truncated(td->map))
+	{
+		/* what is in the buffer already is kept */
+		td->truncated = TRUE;
+		_builder_dialog_error(td->dialog, NULL, NULL,
+				"The file was truncated");
+		return;
+	}
+	/* remember the line on top */
+	y = (gint)gtk_adjustment_get_value(gtk_scrolled_window_get_vadjustment(
+				GTK_SCROLLED_WINDOW(gtk_widget_get_parent(
+						td->view))));
+	gtk_text_view_get_line_at_y(GTK_TEXT_VIEW(td->view), &start, y, NULL);
+	gtk_text_buffer_move_mark(td->buffer, td->top, &start);
+	if(first > td->first)
+	{
+		gtk_text_buffer_get_start_iter(td->buffer, &start);
+		gtk_text_buffer_get_iter_at_line(td->buffer, &end,
+				MIN(first, td->last) - td->first);
+		gtk_text_buffer_delete(td->buffer, &start, &end);
+	}
+	else if(first < td->first)
+	{
+		text = textmap_get_text(td->map, first, td->first, &len);
+		gtk_text_buffer_get_start_iter(td->buffer, &start);
+		_textbox_insert(td, &start, text, len);
+	}
+	if(last < td->last)
+	{
+		gtk_text_buffer_get_iter_at_line(td->buffer, &start,
+				MAX(last, first) - first);
+		gtk_text_buffer_get_end_iter(td->buffer, &end);
+		gtk_text_buffer_delete(td->buffer, &start, &end);
+	}
+	else if(last > td->last)
+	{
+		text = textmap_get_text(td->map, MAX(td->last, first), last,
+				&len);
+		gtk_text_buffer_get_end_iter(td->buffer, &end);
+		_textbox_insert(td, &end, text, len);
+	}
+	td->first = first;
+	td->last = last;
+}
+
 #if GTK_CHECK_VERSION(2, 10, 0)
 # ifdef WITH_XDIALOG
 static void _print_dialog_on_begin_print(gpointer data);
@@ -2557,11 +3705,7 @@ int builder_timebox(struct bsddialog_conf const * conf,
 		int argc, char const ** argv, struct options const * opt)
 {
 	int ret;
-	struct timebox_data td = { NULL, NULL, NULL };
-	GtkWidget * dialog;
-	GtkWidget * container;
-	GtkWidget * box;
-	guint hour, minute, second;
+	unsigned int hour, minute, second;
 	time_t t;
 	struct tm tm;
 	char const * fmt = "%H:%M:%S";
@@ -2592,6 +3736,39 @@ int builder_timebox(struct bsddialog_conf const * conf,
 		minute = tm.tm_min;
 		second = tm.tm_sec;
 	}
+	ret = builder_timebox_values(conf, text, rows, cols, &hour, &minute,
+			&second, opt);
+	switch(ret)
+	{
+		case BSDDIALOG_EXTRA:
+		case BSDDIALOG_OK:
+			if(opt->time_fmt != NULL)
+				fmt = opt->time_fmt;
+			tm.tm_hour = hour;
+			tm.tm_min = minute;
+			tm.tm_sec = second;
+			len = strftime(buf, sizeof(buf) - 1, fmt, &tm);
+			buf[len] = '\0';
+			if(opt->result != NULL)
+				output_value(opt->result, buf);
+			else
+				output_dprintf(opt->output_fd, "%s\n", buf);
+			break;
+	}
+	return ret;
+}
+
+int builder_timebox_values(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int * hh, unsigned int * mm, unsigned int * ss,
+		struct options const * opt)
+{
+	int ret;
+	struct timebox_data td = { NULL, NULL, NULL };
+	GtkWidget * dialog;
+	GtkWidget * container;
+	GtkWidget * box;
+
 	dialog = _builder_dialog(conf, opt, text, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	container = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
@@ -2605,7 +3782,7 @@ int builder_timebox(struct bsddialog_conf const * conf,
 #endif
 	td.hour = gtk_spin_button_new_with_range(0.0, 23.0, 1.0);
 	gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(td.hour), TRUE);
-	gtk_spin_button_set_value(GTK_SPIN_BUTTON(td.hour), (gdouble)hour);
+	gtk_spin_button_set_value(GTK_SPIN_BUTTON(td.hour), (gdouble)*hh);
 	gtk_spin_button_set_wrap(GTK_SPIN_BUTTON(td.hour), TRUE);
 	if(conf->button.always_active == true)
 		gtk_entry_set_activates_default(GTK_ENTRY(td.hour), TRUE);
@@ -2616,7 +3793,7 @@ int builder_timebox(struct bsddialog_conf const * conf,
 			BORDER_WIDTH);
 	td.minute = gtk_spin_button_new_with_range(0.0, 59.0, 1.0);
 	gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(td.minute), TRUE);
-	gtk_spin_button_set_value(GTK_SPIN_BUTTON(td.minute), (gdouble)minute);
+	gtk_spin_button_set_value(GTK_SPIN_BUTTON(td.minute), (gdouble)*mm);
 	gtk_spin_button_set_wrap(GTK_SPIN_BUTTON(td.minute), TRUE);
 	if(conf->button.always_active == true)
 		gtk_entry_set_activates_default(GTK_ENTRY(td.minute), TRUE);
@@ -2627,7 +3804,7 @@ int builder_timebox(struct bsddialog_conf const * conf,
 			BORDER_WIDTH);
 	td.second = gtk_spin_button_new_with_range(0.0, 60.0, 1.0);
 	gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(td.second), TRUE);
-	gtk_spin_button_set_value(GTK_SPIN_BUTTON(td.second), (gdouble)second);
+	gtk_spin_button_set_value(GTK_SPIN_BUTTON(td.second), (gdouble)*ss);
 	gtk_spin_button_set_wrap(GTK_SPIN_BUTTON(td.second), TRUE);
 	if(conf->button.always_active == true)
 		gtk_entry_set_activates_default(GTK_ENTRY(td.second), TRUE);
@@ -2638,23 +3815,9 @@ int builder_timebox(struct bsddialog_conf const * conf,
 	gtk_container_add(GTK_CONTAINER(container), box);
 	_builder_dialog_buttons(dialog, conf, opt);
 	ret = _builder_dialog_run(conf, dialog);
-	switch(ret)
-	{
-		case BSDDIALOG_EXTRA:
-		case BSDDIALOG_OK:
-			if(opt->time_fmt != NULL)
-				fmt = opt->time_fmt;
-			tm.tm_hour = gtk_spin_button_get_value_as_int(
-					GTK_SPIN_BUTTON(td.hour));
-			tm.tm_min = gtk_spin_button_get_value_as_int(
-					GTK_SPIN_BUTTON(td.minute));
-			tm.tm_sec = gtk_spin_button_get_value_as_int(
-					GTK_SPIN_BUTTON(td.second));
-			len = strftime(buf, sizeof(buf) - 1, fmt, &tm);
-			buf[len] = '\n';
-			write(opt->output_fd, buf, len + 1);
-			break;
-	}
+	*hh = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(td.hour));
+	*mm = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(td.minute));
+	*ss = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(td.second));
 	gtk_widget_destroy(dialog);
 	return ret;
 }
@@ -2676,18 +3839,11 @@ int builder_treeview(struct bsddialog_conf const * conf,
 		int argc, char const ** argv, struct options const * opt)
 {
 	int ret;
-	GtkWidget * dialog;
-	GtkWidget * container;
-	GtkWidget * window;
-	GtkWidget * widget;
-	GtkTreeStore * store;
-	GtkTreeIter iter, parent, * pparent = NULL;
-	GtkCellRenderer * renderer;
-	GtkTreeViewColumn * column;
-	GtkTreeSelection * treesel;
-	int i, j, k, n, depth = 0;
-	gboolean set;
-	char const * prefix = NULL, * name, * desc, * tooltip;
+	struct bsddialog_conf conf2 = *conf;
+	struct bsddialog_menuitem * items;
+	MenuModel * model;
+	struct menustream_data * stream = NULL;
+	int j, n, focus = -1;
 
 	j = opt->item_bottomdesc ? 5 : 4;
 	if(opt->item_prefix)
@@ -2705,103 +3861,29 @@ int builder_treeview(struct bsddialog_conf const * conf,
 	}
 	else if(n == 0)
 		n = (argc - 1) / j;
-	dialog = _builder_dialog(conf, opt, text, rows, cols);
-#if GTK_CHECK_VERSION(2, 14, 0)
-	container = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
-#else
-	container = dialog->vbox;
-#endif
-	store = gtk_tree_store_new(RTS_COUNT, G_TYPE_STRING, G_TYPE_BOOLEAN,
-			G_TYPE_INT, G_TYPE_STRING, G_TYPE_STRING,
-			G_TYPE_STRING);
-	window = gtk_scrolled_window_new(NULL, NULL);
-	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(window),
-			GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
-	if(conf->shadow == false)
-		gtk_scrolled_window_set_shadow_type(GTK_SCROLLED_WINDOW(window),
-				GTK_SHADOW_NONE);
-	widget = gtk_tree_view_new();
-	gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(widget), FALSE);
-	gtk_tree_view_set_model(GTK_TREE_VIEW(widget), GTK_TREE_MODEL(store));
-	if(opt->item_bottomdesc)
-		gtk_tree_view_set_tooltip_column(GTK_TREE_VIEW(widget),
-				RTS_TOOLTIP);
-	treesel = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
-	gtk_tree_selection_set_mode(treesel, GTK_SELECTION_BROWSE);
-	for(i = 0, set = FALSE; (i + 1) * j < argc; i++)
-	{
-		k = i * j + 1;
-		if(opt->item_prefix)
-			prefix = argv[k++];
-		name = argv[k++];
-		desc = argv[k++];
-		set = (set == FALSE && strcasecmp(argv[k], "on") == 0)
-			? TRUE : FALSE;
-		depth = strtol(argv[++k], NULL, 10);
-#ifdef DEBUG
-		fprintf(stderr, "DEBUG: %s() depth=%d\n", __func__, depth);
-#endif
-		pparent = _radiolist_get_parent(GTK_TREE_MODEL(store), &parent,
-				depth, name);
-		tooltip = (++k < j) ? argv[k] : NULL;
-		gtk_tree_store_append(store, &iter, pparent);
-		gtk_tree_store_set(store, &iter, RTS_PREFIX, prefix,
-				RTS_SET, set, RTS_DEPTH, depth,
-				RTS_NAME, name, RTS_DESCRIPTION, desc,
-				(tooltip != NULL) ? RTS_TOOLTIP : -1,
-				(tooltip != NULL) ? tooltip : NULL, -1);
-		if(opt->item_default != NULL
-				&& strcmp(name, opt->item_default) == 0)
-			gtk_tree_selection_select_iter(treesel, &iter);
-	}
-	if(opt->item_prefix == true)
-	{
-		column = gtk_tree_view_column_new_with_attributes(NULL,
-				gtk_cell_renderer_text_new(),
-				"text", RTS_PREFIX, NULL);
-		gtk_tree_view_column_set_expand(column, FALSE);
-		gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
-	}
-	renderer = gtk_cell_renderer_toggle_new();
-	gtk_cell_renderer_toggle_set_radio(GTK_CELL_RENDERER_TOGGLE(renderer),
-			TRUE);
-	g_signal_connect(renderer, "toggled",
-			G_CALLBACK(_radiolist_on_row_toggled), store);
-	column = gtk_tree_view_column_new_with_attributes(NULL, renderer,
-			"active", RTS_SET, NULL);
-	gtk_tree_view_column_set_expand(column, FALSE);
-	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
-	if(conf->menu.no_desc == false)
-	{
-		column = gtk_tree_view_column_new_with_attributes(NULL,
-				gtk_cell_renderer_text_new(), "text",
-				RTS_DESCRIPTION, NULL);
-		gtk_tree_view_column_set_expand(column, TRUE);
-		gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
-	}
-	gtk_tree_view_expand_all(GTK_TREE_VIEW(widget));
-	g_signal_connect(widget, "row-activated",
-			G_CALLBACK(_radiolist_on_row_activated), NULL);
-	gtk_container_add(GTK_CONTAINER(window), widget);
-	gtk_box_pack_start(GTK_BOX(container), window, TRUE, TRUE, 0);
-	gtk_widget_show_all(window);
-	_builder_dialog_buttons(dialog, conf, opt);
-	ret = _builder_dialog_run(conf, dialog);
-	switch(ret)
+	if((items = _builder_dialog_menu_items_new(opt, argc - 1, argv + 1,
+					j, TRUE, TRUE)) == NULL)
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
+	if((model = menumodel_new(items, (argc - 1) / j,
+					opt->items_from != NULL)) == NULL)
 	{
-		case BSDDIALOG_HELP:
-			_builder_dialog_menu_output(opt, treesel,
-					GTK_TREE_MODEL(store), RTS_NAME,
-					"HELP ");
-			break;
-		case BSDDIALOG_EXTRA:
-		case BSDDIALOG_OK:
-			gtk_tree_model_foreach(GTK_TREE_MODEL(store),
-					_radiolist_foreach_response,
-					(gpointer)opt);
-			break;
+		free(items);
+		return _builder_dialog_error(NULL, conf, opt, strerror(errno));
 	}
-	gtk_widget_destroy(dialog);
+	/* the names are not displayed */
+	conf2.menu.no_name = true;
+	if(opt->items_from != NULL && (stream = _builder_dialog_menu_stream(
+					conf, opt, model, j, TRUE, TRUE))
+					== NULL)
+		ret = BSDDIALOG_ERROR;
+	else
+		ret = _builder_radiolist_model(&conf2, text, rows, cols, model,
+				stream, &focus, opt);
+	_radiolist_output(opt, ret, menumodel_get_items(model),
+			menumodel_get_radio(model), focus);
+	_builder_dialog_menu_stream_delete(stream);
+	g_object_unref(model);
+	free(items);
 	return ret;
 }
 
@@ -3085,32 +4167,116 @@ static int _builder_dialog_error(GtkWidget * parent,
 }
 
 
-/* builder_dialog_help */
-static int _builder_dialog_help(GtkWidget * parent,
-		struct bsddialog_conf const * conf,
-		struct options const * opt)
+/* builder_dialog_exec */
+static Exec * _builder_dialog_exec(char const * command, gboolean errors,
+		struct options const * opt, GError ** error)
 {
-	int ret;
-	struct bsddialog_conf conf2;
-	GtkWidget * dialog;
-	const GtkDialogFlags flags = 0;
-	GtkButtonsType buttons = GTK_BUTTONS_CLOSE;
-#ifndef WITH_XDIALOG
-	(void) opt;
-#endif
+	Exec * exec;
 
-	if(conf->key.f1_file != NULL)
-	{
-		memset(&conf2, 0, sizeof(conf2));
-		conf2.title = "Help";
-		return builder_textbox(&conf2, conf->key.f1_file, 0, 0, 0, NULL,
-				NULL);
-	}
-#ifdef WITH_XDIALOG
-	if(parent != NULL && opt->help != NULL && opt->help[0] == '\0')
+	if((exec = exec_new(command, errors, error)) == NULL)
+		return NULL;
+	if(opt->exec_filter != NULL
+			&& exec_set_filter(exec, opt->exec_filter, error) != 0)
 	{
-		gtk_dialog_response(GTK_DIALOG(parent), GTK_RESPONSE_HELP);
-		return 0;
+		exec_delete(exec);
+		return NULL;
+	}
+	return exec;
+}
+
+
+/* builder_dialog_exec_wait */
+/* a command that failed to complete is an error, otherwise terminate it */
+static int _builder_dialog_exec_wait(Exec * exec, gboolean eof, int ret)
+{
+	int status;
+
+	status = exec_wait(exec, !eof);
+	exec_delete(exec);
+	if(eof && status != 0)
+		return BSDDIALOG_ERROR;
+	return ret;
+}
+
+
+/* builder_dialog_frame */
+#if GTK_CHECK_VERSION(3, 8, 0)
+static gboolean _dialog_frame_on_tick(GtkWidget * widget,
+		GdkFrameClock * clock, gpointer data);
+#endif
+
+/* the callback is called when the next frame is drawn, and again for
+ * every frame as long as it returns TRUE */
+static guint _builder_dialog_frame(GtkWidget * widget, GSourceFunc callback,
+		gpointer data)
+{
+#if GTK_CHECK_VERSION(3, 8, 0)
+	struct frame_data * fd;
+
+	fd = g_new(struct frame_data, 1);
+	fd->callback = callback;
+	fd->data = data;
+	return gtk_widget_add_tick_callback(widget, _dialog_frame_on_tick, fd,
+			g_free);
+#else
+	(void) widget;
+
+	return g_timeout_add(1000 / FRAME_RATE, callback, data);
+#endif
+}
+
+#if GTK_CHECK_VERSION(3, 8, 0)
+static gboolean _dialog_frame_on_tick(GtkWidget * widget,
+		GdkFrameClock * clock, gpointer data)
+{
+	struct frame_data * fd = data;
+	(void) widget;
+	(void) clock;
+
+	return fd->callback(fd->data) ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+#endif
+
+
+/* builder_dialog_frame_cancel */
+static void _builder_dialog_frame_cancel(GtkWidget * widget, guint id)
+{
+#if GTK_CHECK_VERSION(3, 8, 0)
+	gtk_widget_remove_tick_callback(widget, id);
+#else
+	(void) widget;
+
+	g_source_remove(id);
+#endif
+}
+
+
+/* builder_dialog_help */
+static int _builder_dialog_help(GtkWidget * parent,
+		struct bsddialog_conf const * conf,
+		struct options const * opt)
+{
+	int ret;
+	struct bsddialog_conf conf2;
+	GtkWidget * dialog;
+	const GtkDialogFlags flags = 0;
+	GtkButtonsType buttons = GTK_BUTTONS_CLOSE;
+#ifndef WITH_XDIALOG
+	(void) opt;
+#endif
+
+	if(conf->key.f1_file != NULL)
+	{
+		memset(&conf2, 0, sizeof(conf2));
+		conf2.title = "Help";
+		return builder_textbox(&conf2, conf->key.f1_file, 0, 0, 0, NULL,
+				NULL);
+	}
+#ifdef WITH_XDIALOG
+	if(parent != NULL && opt->help != NULL && opt->help[0] == '\0')
+	{
+		gtk_dialog_response(GTK_DIALOG(parent), GTK_RESPONSE_HELP);
+		return 0;
 	}
 #endif
 	dialog = gtk_message_dialog_new((parent != NULL)
@@ -3128,34 +4294,802 @@ static int _builder_dialog_help(GtkWidget * parent,
 }
 
 
+/* builder_dialog_menu_batch */
+static void _menu_batch_on_expanded(GtkTreeView * view, GtkTreePath * path,
+		gpointer data);
+
+static void _builder_dialog_menu_batch(GtkWidget * view, MenuModel * model,
+		struct menubatch_data * mb)
+{
+	GtkTreeSelection * treesel;
+	GtkTreeIter iter;
+
+	mb->selected = -1;
+	mb->expanded = NULL;
+	treesel = gtk_tree_view_get_selection(GTK_TREE_VIEW(view));
+	if(gtk_tree_selection_get_selected(treesel, NULL, &iter))
+		mb->selected = menumodel_get_index(model, &iter);
+	/* the parents come first */
+	if(menumodel_is_tree(model))
+	{
+		gtk_tree_view_map_expanded_rows(GTK_TREE_VIEW(view),
+				_menu_batch_on_expanded, mb);
+		mb->expanded = g_list_reverse(mb->expanded);
+	}
+	/* the view is detached while the model changes */
+	g_object_ref(model);
+	gtk_tree_view_set_model(GTK_TREE_VIEW(view), NULL);
+}
+
+static void _menu_batch_on_expanded(GtkTreeView * view, GtkTreePath * path,
+		gpointer data)
+{
+	struct menubatch_data * mb = data;
+	(void) view;
+
+	mb->expanded = g_list_prepend(mb->expanded, gtk_tree_path_copy(path));
+}
+
+
+/* builder_dialog_menu_batch_end */
+static void _builder_dialog_menu_batch_end(GtkWidget * view, MenuModel * model,
+		struct menubatch_data * mb)
+{
+	GtkTreeSelection * treesel;
+	GtkTreeIter iter;
+	GtkTreePath * path;
+	GList * l;
+
+	gtk_tree_view_set_model(GTK_TREE_VIEW(view), GTK_TREE_MODEL(model));
+	g_object_unref(model);
+	for(l = mb->expanded; l != NULL; l = l->next)
+	{
+		gtk_tree_view_expand_row(GTK_TREE_VIEW(view), l->data, FALSE);
+		gtk_tree_path_free(l->data);
+	}
+	g_list_free(mb->expanded);
+	mb->expanded = NULL;
+	if(mb->selected < 0 || menumodel_get_iter(model, &iter, mb->selected)
+			== FALSE)
+		return;
+	treesel = gtk_tree_view_get_selection(GTK_TREE_VIEW(view));
+	gtk_tree_selection_select_iter(treesel, &iter);
+	path = gtk_tree_model_get_path(GTK_TREE_MODEL(model), &iter);
+	gtk_tree_view_set_cursor(GTK_TREE_VIEW(view), path, NULL, FALSE);
+	gtk_tree_view_scroll_to_cell(GTK_TREE_VIEW(view), path, NULL, FALSE,
+			0.0, 0.0);
+	gtk_tree_path_free(path);
+}
+
+
+/* builder_dialog_menu_expand */
+static void _builder_dialog_menu_expand(GtkWidget * view, MenuModel * model,
+		struct options const * opt, int selected)
+{
+	unsigned int nitems, i;
+	GtkTreeIter iter;
+	GtkTreePath * path;
+
+	if(menumodel_is_tree(model) == FALSE)
+		return;
+	if(opt->item_expand < 0)
+	{
+		gtk_tree_view_expand_all(GTK_TREE_VIEW(view));
+		return;
+	}
+	/* the rows of collapsed parents are only obtained once expanded */
+	nitems = menumodel_get_count(model);
+	for(i = 0; opt->item_expand > 0 && i < nitems; i++)
+	{
+		if(menumodel_get_iter(model, &iter, i) == FALSE
+				|| gtk_tree_model_iter_has_child(
+					GTK_TREE_MODEL(model), &iter) == FALSE)
+			continue;
+		path = gtk_tree_model_get_path(GTK_TREE_MODEL(model), &iter);
+		if(gtk_tree_path_get_depth(path) <= opt->item_expand)
+			gtk_tree_view_expand_row(GTK_TREE_VIEW(view), path,
+					FALSE);
+		gtk_tree_path_free(path);
+	}
+	/* the item selected is always visible */
+	if(selected < 0 || menumodel_get_iter(model, &iter, selected) == FALSE)
+		return;
+	path = gtk_tree_model_get_path(GTK_TREE_MODEL(model), &iter);
+	if(gtk_tree_path_up(path) && gtk_tree_path_get_depth(path) > 0)
+		gtk_tree_view_expand_to_path(GTK_TREE_VIEW(view), path);
+	gtk_tree_path_free(path);
+}
+
+
+/* builder_dialog_menu_filter */
+static void _menu_filter_apply(struct menufilter_data * mf);
+static gboolean _menu_filter_on_key_press(GtkWidget * widget,
+		GdkEventKey * event, gpointer data);
+static void _menu_filter_on_ready(MenuIndex * index, void * data);
+static void _menu_filter_start(gpointer data);
+
+static struct menufilter_data * _builder_dialog_menu_filter(
+		GtkWidget * container, GtkWidget * view, MenuModel * model,
+		struct menustream_data * stream, struct options const * opt)
+{
+	struct menufilter_data * mf;
+
+	if((opt->item_filter == false && opt->item_sort == false)
+			|| menumodel_is_tree(model)
+			|| (mf = malloc(sizeof(*mf))) == NULL)
+		return NULL;
+	mf->opt = opt;
+	mf->model = model;
+	mf->view = view;
+	mf->entry = NULL;
+	mf->index = NULL;
+	if(opt->item_filter)
+	{
+		mf->entry = gtk_entry_new();
+		/* the filter is enabled once the index is ready */
+		gtk_widget_set_sensitive(mf->entry, FALSE);
+		g_signal_connect_swapped(mf->entry, "activate",
+				G_CALLBACK(gtk_widget_grab_focus), view);
+		g_signal_connect_swapped(mf->entry, "changed",
+				G_CALLBACK(_menu_filter_apply), mf);
+		gtk_tree_view_set_enable_search(GTK_TREE_VIEW(view), FALSE);
+		g_signal_connect(view, "key-press-event",
+				G_CALLBACK(_menu_filter_on_key_press), mf);
+		gtk_widget_show(mf->entry);
+		gtk_box_pack_start(GTK_BOX(container), mf->entry, FALSE, TRUE,
+				0);
+	}
+	/* the items are indexed once they are all known */
+	if(stream != NULL)
+		stream->filter = mf;
+	else
+		g_signal_connect_swapped(view, "map",
+				G_CALLBACK(_menu_filter_start), mf);
+	return mf;
+}
+
+static void _menu_filter_apply(struct menufilter_data * mf)
+{
+	char const * text;
+	unsigned int const * rows;
+	unsigned int n;
+	struct menubatch_data mb;
+
+	if(mf->index == NULL)
+		return;
+	text = (mf->entry != NULL) ? gtk_entry_get_text(GTK_ENTRY(mf->entry))
+		: "";
+	n = menuindex_filter(mf->index, text, &rows);
+	/* the view remains attached unless too many rows change */
+	if(menumodel_update_rows(mf->model, rows, n, MENU_FILTER_CHANGES) == 0)
+		return;
+	_builder_dialog_menu_batch(mf->view, mf->model, &mb);
+	/* XXX ignore errors */
+	menumodel_set_rows(mf->model, rows, n);
+	_builder_dialog_menu_batch_end(mf->view, mf->model, &mb);
+}
+
+static gboolean _menu_filter_on_key_press(GtkWidget * widget,
+		GdkEventKey * event, gpointer data)
+{
+	struct menufilter_data * mf = data;
+	gunichar c;
+	gint position = -1;
+	char buf[6];
+	(void) widget;
+
+	/* the printable characters are typed into the filter */
+	if((event->state & (GDK_CONTROL_MASK | GDK_MOD1_MASK)) != 0
+			|| (c = gdk_keyval_to_unicode(event->keyval)) == 0
+			|| c == ' ' || g_unichar_isprint(c) == FALSE
+			|| gtk_widget_get_sensitive(mf->entry) == FALSE)
+		return FALSE;
+	gtk_editable_insert_text(GTK_EDITABLE(mf->entry), buf,
+			g_unichar_to_utf8(c, buf), &position);
+#if GTK_CHECK_VERSION(3, 16, 0)
+	gtk_entry_grab_focus_without_selecting(GTK_ENTRY(mf->entry));
+#else
+	gtk_widget_grab_focus(mf->entry);
+	gtk_editable_set_position(GTK_EDITABLE(mf->entry), -1);
+#endif
+	return TRUE;
+}
+
+static void _menu_filter_on_ready(MenuIndex * index, void * data)
+{
+	struct menufilter_data * mf = data;
+	(void) index;
+
+	if(mf->entry != NULL)
+		gtk_widget_set_sensitive(mf->entry, TRUE);
+	_menu_filter_apply(mf);
+}
+
+static void _menu_filter_start(gpointer data)
+{
+	struct menufilter_data * mf = data;
+
+	if(mf->index != NULL || menumodel_get_count(mf->model) == 0)
+		return;
+	/* the index is built in the background */
+	mf->index = menuindex_new(menumodel_get_items(mf->model),
+			menumodel_get_count(mf->model), mf->opt->item_sort,
+			_menu_filter_on_ready, mf);
+}
+
+
+/* builder_dialog_menu_filter_delete */
+static void _builder_dialog_menu_filter_delete(struct menufilter_data * mf)
+{
+	if(mf == NULL)
+		return;
+	if(mf->index != NULL)
+		menuindex_delete(mf->index);
+	free(mf);
+}
+
+
+/* builder_dialog_menu_focus */
+static void _builder_dialog_menu_focus(GtkTreeSelection * treesel,
+		MenuModel * model, int * focusitem)
+{
+	GtkTreeIter iter;
+
+	if(focusitem == NULL)
+		return;
+	*focusitem = gtk_tree_selection_get_selected(treesel, NULL, &iter)
+		? menumodel_get_index(model, &iter) : -1;
+}
+
+
+/* builder_dialog_menu_item */
+static void _builder_dialog_menu_item(struct options const * opt,
+		struct bsddialog_menuitem * item, char const ** argv,
+		gboolean set, gboolean treeview)
+{
+	int k = 0;
+	long depth;
+
+	item->prefix = opt->item_prefix ? argv[k++] : NULL;
+	depth = (opt->item_depth && !treeview)
+		? strtol(argv[k++], NULL, 10) : 0;
+	item->name = argv[k++];
+	item->desc = argv[k++];
+	item->on = (set && strcasecmp(argv[k++], "on") == 0) ? true : false;
+	if(treeview)
+		depth = strtol(argv[k++], NULL, 10);
+	item->depth = (depth > 0) ? depth : 0;
+	item->bottomdesc = opt->item_bottomdesc ? argv[k++] : NULL;
+}
+
+
+/* builder_dialog_menu_items_new */
+static struct bsddialog_menuitem * _builder_dialog_menu_items_new(
+		struct options const * opt, int argc, char const ** argv,
+		int j, gboolean set, gboolean treeview)
+{
+	struct bsddialog_menuitem * items;
+	int i;
+
+	if((items = malloc(sizeof(*items) * (argc / j + 1))) == NULL)
+		return NULL;
+	for(i = 0; (i + 1) * j <= argc; i++)
+		_builder_dialog_menu_item(opt, &items[i], &argv[i * j], set,
+				treeview);
+	return items;
+}
+
+
 /* builder_dialog_menu_output */
 static int _builder_dialog_menu_output(struct options const * opt,
-		GtkTreeSelection * treesel, GtkTreeModel * model,
-		unsigned int id, char const * prefix)
+		char const * name, char const * prefix)
 {
-	GtkTreeIter iter;
-	gchar * p;
+	Output * output;
 	gboolean toquote;
-	char quotech;
 
-	if(gtk_tree_selection_get_selected(treesel, NULL, &iter) == FALSE)
+	if(opt->result != NULL)
+	{
+		/* the button is already part of the record */
+		output_value(opt->result, name);
 		return BSDDIALOG_HELP;
-	gtk_tree_model_get(model, &iter, id, &p, -1);
+	}
+	output = output_new(opt->output_fd);
 	if(prefix != NULL)
-		dprintf(opt->output_fd, "%s", prefix);
-	toquote = string_needs_quoting(p) ? opt->item_always_quote : FALSE;
+		output_string(output, prefix);
+	toquote = string_needs_quoting(name) ? opt->item_always_quote : FALSE;
 	if(toquote)
-	{
-		quotech = opt->item_singlequote ? '\'' : '"';
-		dprintf(opt->output_fd, "%c%s%c\n", quotech, p, quotech);
-	}
+		output_quoted(output, name, opt->item_singlequote ? '\'' : '"');
 	else
-		dprintf(opt->output_fd, "%s\n", p);
-	free(p);
+		output_string(output, name);
+	output_string(output, "\n");
+	output_delete(output);
 	return BSDDIALOG_HELP;
 }
 
 
+/* builder_dialog_menu_large */
+static void _builder_dialog_menu_large(GtkWidget * view, MenuModel * model,
+		struct options const * opt)
+{
+	GList * columns, * l;
+	GtkTreeViewColumn * column;
+	GtkTreePath * path;
+	GtkTreeIter iter;
+	unsigned int nitems, i, step;
+	gint width, w, indent, expander = 0, separator = 0;
+
+	nitems = menumodel_get_count(model);
+	/* the columns are sized once some items are known */
+	if(nitems == 0 || (opt->large_list == false
+				&& nitems < MENU_LARGE_LIST))
+		return;
+	gtk_widget_style_get(view, "expander-size", &expander,
+			"horizontal-separator", &separator, NULL);
+	/* XXX assumes the padding of the expanders in GtkTreeView */
+	indent = expander + 4 + gtk_tree_view_get_level_indentation(
+			GTK_TREE_VIEW(view));
+	step = nitems / MENU_LARGE_SAMPLE + 1;
+	columns = gtk_tree_view_get_columns(GTK_TREE_VIEW(view));
+	for(l = columns; l != NULL; l = l->next)
+	{
+		column = l->data;
+		/* the last item is always sampled */
+		for(i = 0, width = 0; i < nitems + step - 1; i += step)
+		{
+			if(menumodel_get_iter(model, &iter, MIN(i, nitems - 1))
+					== FALSE)
+				continue;
+			gtk_tree_view_column_cell_set_cell_data(column,
+					GTK_TREE_MODEL(model), &iter,
+					FALSE, FALSE);
+			gtk_tree_view_column_cell_get_size(column, NULL,
+					NULL, NULL, &w, NULL);
+			/* the first column holds the expanders */
+			if(l == columns && menumodel_is_tree(model)
+					&& (path = gtk_tree_model_get_path(
+							GTK_TREE_MODEL(model),
+							&iter)) != NULL)
+			{
+				w += gtk_tree_path_get_depth(path) * indent;
+				gtk_tree_path_free(path);
+			}
+			width = MAX(width, w);
+		}
+		gtk_tree_view_column_set_sizing(column,
+				GTK_TREE_VIEW_COLUMN_FIXED);
+		gtk_tree_view_column_set_fixed_width(column,
+				width + separator);
+	}
+	g_list_free(columns);
+	gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(view), TRUE);
+}
+
+
+/* builder_dialog_menu_stream */
+static char const * _menu_stream_copy(struct menustream_data * ms,
+		char const * field, size_t len);
+static char * _menu_stream_delimiter(struct menustream_data * ms, char * buf,
+		size_t len);
+static gboolean _menu_stream_eof(struct menustream_data * ms);
+static void _menu_stream_field(struct menustream_data * ms,
+		char const * field);
+static void _menu_stream_large(struct menustream_data * ms);
+static gboolean _menu_stream_on_can_read(GIOChannel * channel,
+		GIOCondition condition, gpointer data);
+static gboolean _menu_stream_on_eof(gpointer data);
+static gboolean _menu_stream_on_idle(gpointer data);
+
+static struct menustream_data * _builder_dialog_menu_stream(
+		struct bsddialog_conf const * conf, struct options const * opt,
+		MenuModel * model, int j, gboolean set, gboolean treeview)
+{
+	struct menustream_data * ms;
+	struct stat st;
+	off_t offset;
+	long fd;
+	char * p;
+	char buf[BUFSIZ];
+
+	if((ms = malloc(sizeof(*ms))) == NULL)
+	{
+		_builder_dialog_error(NULL, conf, opt, strerror(errno));
+		return NULL;
+	}
+	ms->opt = opt;
+	ms->model = model;
+	ms->view = NULL;
+	ms->filter = NULL;
+	ms->j = j;
+	ms->set = set;
+	ms->treeview = treeview;
+	ms->fields = malloc(sizeof(*ms->fields) * j);
+	ms->nfields = 0;
+	ms->delimiter = -1;
+	ms->fd = -1;
+	ms->close = FALSE;
+	ms->id = 0;
+	ms->map = NULL;
+	ms->mapsize = 0;
+	ms->pos = 0;
+	ms->strings = NULL;
+	ms->channel = NULL;
+	ms->blocks = NULL;
+	ms->block = NULL;
+	ms->blocksize = 0;
+	ms->blocklen = 0;
+	ms->blockpos = 0;
+	/* the source is either a file or a file descriptor */
+	if(strcmp(opt->items_from, "-") == 0)
+		ms->fd = STDIN_FILENO;
+	else if(opt->items_from[0] != '\0'
+			&& (fd = strtol(opt->items_from, &p, 10)) >= 0
+			&& fd <= INT_MAX && *p == '\0')
+		ms->fd = fd;
+	else if((ms->fd = open(opt->items_from, O_RDONLY)) >= 0)
+		ms->close = TRUE;
+	if(ms->fields == NULL || ms->fd < 0 || fstat(ms->fd, &st) != 0)
+	{
+		snprintf(buf, sizeof(buf), "%s: %s", opt->items_from,
+				strerror(errno));
+		_builder_dialog_menu_stream_delete(ms);
+		_builder_dialog_error(NULL, conf, opt, buf);
+		return NULL;
+	}
+	if(S_ISREG(st.st_mode))
+	{
+		/* the fields are read in place from a read-only mapping */
+		if((offset = lseek(ms->fd, 0, SEEK_CUR)) < 0)
+			offset = 0;
+		if(st.st_size <= offset)
+		{
+			ms->id = g_idle_add(_menu_stream_on_eof, ms);
+			return ms;
+		}
+		ms->mapsize = st.st_size;
+		if((ms->map = mmap(NULL, ms->mapsize, PROT_READ, MAP_PRIVATE,
+						ms->fd, 0)) == MAP_FAILED)
+		{
+			ms->map = NULL;
+			snprintf(buf, sizeof(buf), "%s: %s", opt->items_from,
+					strerror(errno));
+			_builder_dialog_menu_stream_delete(ms);
+			_builder_dialog_error(NULL, conf, opt, buf);
+			return NULL;
+		}
+		ms->pos = offset;
+		ms->id = g_idle_add(_menu_stream_on_idle, ms);
+		return ms;
+	}
+	ms->blocks = g_ptr_array_new_with_free_func(g_free);
+	ms->channel = g_io_channel_unix_new(ms->fd);
+	g_io_channel_set_close_on_unref(ms->channel, ms->close);
+	g_io_channel_set_encoding(ms->channel, NULL, NULL);
+	g_io_channel_set_buffered(ms->channel, FALSE);
+	/* XXX ignore errors */
+	g_io_channel_set_flags(ms->channel, g_io_channel_get_flags(ms->channel)
+			| G_IO_FLAG_NONBLOCK, NULL);
+	ms->id = g_io_add_watch(ms->channel, G_IO_IN | G_IO_HUP,
+			_menu_stream_on_can_read, ms);
+	return ms;
+}
+
+static char const * _menu_stream_copy(struct menustream_data * ms,
+		char const * field, size_t len)
+{
+	if(ms->strings == NULL)
+		ms->strings = g_string_chunk_new(MENU_STREAM_BLOCK);
+	return g_string_chunk_insert_len(ms->strings, field, len);
+}
+
+static char * _menu_stream_delimiter(struct menustream_data * ms, char * buf,
+		size_t len)
+{
+	char * p, * q;
+
+	if(ms->delimiter >= 0)
+		return memchr(buf, ms->delimiter, len);
+	/* the first NUL or newline character found sets the delimiter */
+	p = memchr(buf, '\0', len);
+	if((q = memchr(buf, '\n', (p != NULL) ? (size_t)(p - buf) : len))
+			!= NULL)
+		p = q;
+	if(p != NULL)
+		ms->delimiter = *p;
+	return p;
+}
+
+static gboolean _menu_stream_eof(struct menustream_data * ms)
+{
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s()\n", __func__);
+#endif
+	/* the last field may not be terminated */
+	if(ms->map != NULL && ms->pos < ms->mapsize)
+	{
+		/* the end of the last page is filled with zeros */
+		if(ms->mapsize % sysconf(_SC_PAGESIZE) != 0)
+			_menu_stream_field(ms, ms->map + ms->pos);
+		else
+			_menu_stream_field(ms, _menu_stream_copy(ms,
+						ms->map + ms->pos,
+						ms->mapsize - ms->pos));
+		ms->pos = ms->mapsize;
+	}
+	else if(ms->block != NULL && ms->blockpos < ms->blocklen)
+	{
+		/* there is always room for the terminator */
+		ms->block[ms->blocklen] = '\0';
+		_menu_stream_field(ms, ms->block + ms->blockpos);
+		ms->blockpos = ms->blocklen;
+	}
+	if(ms->nfields != 0)
+		error(0, "%s: %s", ms->opt->items_from,
+				"Ignoring the last item (incomplete)");
+	if(ms->view != NULL)
+		_builder_dialog_menu_large(ms->view, ms->model, ms->opt);
+	if(ms->filter != NULL)
+		_menu_filter_start(ms->filter);
+	ms->id = 0;
+	return FALSE;
+}
+
+static void _menu_stream_field(struct menustream_data * ms,
+		char const * field)
+{
+	struct bsddialog_menuitem item;
+	GtkTreeSelection * treesel;
+	GtkTreePath * path;
+	GtkTreeIter iter;
+	gboolean selected;
+	int depth;
+
+	ms->fields[ms->nfields++] = field;
+	if(ms->nfields < ms->j)
+		return;
+	ms->nfields = 0;
+	_builder_dialog_menu_item(ms->opt, &item, ms->fields, ms->set,
+			ms->treeview);
+	/* XXX the item is lost if out of memory */
+	if(menumodel_append(ms->model, &item) != 0 || ms->view == NULL
+			|| menumodel_get_iter(ms->model, &iter,
+				menumodel_get_count(ms->model) - 1) == FALSE)
+		return;
+	selected = ms->opt->item_default != NULL
+		&& strcmp(item.name, ms->opt->item_default) == 0;
+	if(menumodel_is_tree(ms->model) && item.depth > 0)
+	{
+		/* the parents are expanded as configured */
+		path = gtk_tree_model_get_path(GTK_TREE_MODEL(ms->model),
+				&iter);
+		if(gtk_tree_path_up(path) && (depth = gtk_tree_path_get_depth(
+						path)) > 0
+				&& (selected || ms->opt->item_expand < 0
+					|| depth <= ms->opt->item_expand))
+			gtk_tree_view_expand_to_path(GTK_TREE_VIEW(ms->view),
+					path);
+		gtk_tree_path_free(path);
+	}
+	if(selected)
+	{
+		treesel = gtk_tree_view_get_selection(GTK_TREE_VIEW(ms->view));
+		gtk_tree_selection_select_iter(treesel, &iter);
+	}
+}
+
+static void _menu_stream_large(struct menustream_data * ms)
+{
+	/* with --large-list, the columns are sized from the first items */
+	if(ms->view != NULL && ms->opt->large_list
+			&& gtk_tree_view_get_fixed_height_mode(
+				GTK_TREE_VIEW(ms->view)) == FALSE)
+		_builder_dialog_menu_large(ms->view, ms->model, ms->opt);
+}
+
+static gboolean _menu_stream_on_can_read(GIOChannel * channel,
+		GIOCondition condition, gpointer data)
+{
+	struct menustream_data * ms = data;
+	GIOStatus status;
+	gsize r;
+	GError * error = NULL;
+	char * block, * p;
+	size_t len;
+
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s()\n", __func__);
+#endif
+	/* the end of the file is found when reading */
+	if((condition & (G_IO_IN | G_IO_HUP)) == 0)
+	{
+		_builder_dialog_error((ms->view != NULL)
+				? gtk_widget_get_toplevel(ms->view) : NULL,
+				NULL, NULL, "Unexpected condition");
+		return _menu_stream_eof(ms);
+	}
+	if(ms->blocklen + 1 >= ms->blocksize)
+	{
+		/* the fields read so far are kept in place, the partial field
+		 * is moved to a new block */
+		len = ms->blocklen - ms->blockpos;
+		block = g_malloc(MAX(MENU_STREAM_BLOCK, len * 2));
+		if(len > 0)
+			memcpy(block, ms->block + ms->blockpos, len);
+		if(ms->block != NULL && ms->blockpos == 0)
+			g_ptr_array_remove_index(ms->blocks,
+					ms->blocks->len - 1);
+		g_ptr_array_add(ms->blocks, block);
+		ms->block = block;
+		ms->blocksize = MAX(MENU_STREAM_BLOCK, len * 2);
+		ms->blocklen = len;
+		ms->blockpos = 0;
+	}
+	status = g_io_channel_read_chars(channel, ms->block + ms->blocklen,
+			ms->blocksize - ms->blocklen - 1, &r, &error);
+	if(status == G_IO_STATUS_ERROR)
+	{
+		_builder_dialog_error((ms->view != NULL)
+				? gtk_widget_get_toplevel(ms->view) : NULL,
+				NULL, NULL, error->message);
+		g_error_free(error);
+		return _menu_stream_eof(ms);
+	}
+	else if(status == G_IO_STATUS_AGAIN)
+		return TRUE;
+	else if(status == G_IO_STATUS_EOF)
+		return _menu_stream_eof(ms);
+	ms->blocklen += r;
+	while((p = _menu_stream_delimiter(ms, ms->block + ms->blockpos,
+					ms->blocklen - ms->blockpos)) != NULL)
+	{
+		*p = '\0';
+		_menu_stream_field(ms, ms->block + ms->blockpos);
+		ms->blockpos = p - ms->block + 1;
+	}
+	_menu_stream_large(ms);
+	return TRUE;
+}
+
+static gboolean _menu_stream_on_eof(gpointer data)
+{
+	struct menustream_data * ms = data;
+
+	return _menu_stream_eof(ms);
+}
+
+static gboolean _menu_stream_on_idle(gpointer data)
+{
+	struct menustream_data * ms = data;
+	char * p;
+	unsigned int i;
+
+	for(i = 0; i < MENU_STREAM_FIELDS; i++)
+	{
+		if((p = _menu_stream_delimiter(ms, ms->map + ms->pos,
+						ms->mapsize - ms->pos)) == NULL)
+			return _menu_stream_eof(ms);
+		/* only the fields not terminated with NUL are copied */
+		_menu_stream_field(ms, (*p == '\0') ? ms->map + ms->pos
+				: _menu_stream_copy(ms, ms->map + ms->pos,
+					p - (ms->map + ms->pos)));
+		ms->pos = p - ms->map + 1;
+	}
+	_menu_stream_large(ms);
+	return TRUE;
+}
+
+
+/* builder_dialog_menu_stream_delete */
+static void _builder_dialog_menu_stream_delete(struct menustream_data * ms)
+{
+	if(ms == NULL)
+		return;
+	if(ms->id != 0)
+		g_source_remove(ms->id);
+	if(ms->channel != NULL)
+		g_io_channel_unref(ms->channel);
+	else if(ms->close)
+		close(ms->fd);
+	if(ms->map != NULL)
+		munmap(ms->map, ms->mapsize);
+	if(ms->strings != NULL)
+		g_string_chunk_free(ms->strings);
+	if(ms->blocks != NULL)
+		g_ptr_array_free(ms->blocks, TRUE);
+	free(ms->fields);
+	free(ms);
+}
+
+
+/* builder_dialog_menu_tooltip */
+static gboolean _menu_tooltip_on_query_tooltip(GtkWidget * widget,
+		gint x, gint y, gboolean keyboard, GtkTooltip * tooltip,
+		gpointer data);
+
+static void _builder_dialog_menu_tooltip(GtkWidget * view)
+{
+	gtk_widget_set_has_tooltip(view, TRUE);
+	g_signal_connect(view, "query-tooltip",
+			G_CALLBACK(_menu_tooltip_on_query_tooltip), NULL);
+}
+
+static gboolean _menu_tooltip_on_query_tooltip(GtkWidget * widget,
+		gint x, gint y, gboolean keyboard, GtkTooltip * tooltip,
+		gpointer data)
+{
+	GtkTreeModel * model;
+	GtkTreePath * path;
+	GtkTreeIter iter;
+	gchar * p;
+	gboolean ret = FALSE;
+	(void) data;
+
+	/* only look up the item being hovered */
+	if(gtk_tree_view_get_tooltip_context(GTK_TREE_VIEW(widget), &x, &y,
+				keyboard, &model, &path, &iter) == FALSE)
+		return FALSE;
+	gtk_tree_model_get(model, &iter, MMC_TOOLTIP, &p, -1);
+	if(p != NULL && p[0] != '\0')
+	{
+		gtk_tooltip_set_text(tooltip, p);
+		gtk_tree_view_set_tooltip_row(GTK_TREE_VIEW(widget), tooltip,
+				path);
+		ret = TRUE;
+	}
+	g_free(p);
+	gtk_tree_path_free(path);
+	return ret;
+}
+
+
+/* builder_dialog_menu_view */
+static void _builder_dialog_menu_view(GtkWidget * view, MenuModel * model,
+		struct menustream_data * stream, struct options const * opt,
+		int * focusitem)
+{
+	GtkTreeSelection * treesel;
+	GtkTreeIter iter;
+	struct bsddialog_menuitem const * items;
+	unsigned int nitems, i;
+	int selected = -1;
+
+	/* the items streamed are added to this view */
+	if(stream != NULL)
+		stream->view = view;
+	items = menumodel_get_items(model);
+	nitems = menumodel_get_count(model);
+	gtk_tree_view_set_model(GTK_TREE_VIEW(view), GTK_TREE_MODEL(model));
+	for(i = 0; i < nitems; i++)
+		if((opt->item_default != NULL
+					&& strcmp(items[i].name,
+						opt->item_default) == 0)
+				|| (focusitem != NULL
+					&& *focusitem == (int)i))
+			selected = i;
+	_builder_dialog_menu_expand(view, model, opt, selected);
+	if(selected >= 0 && menumodel_get_iter(model, &iter, selected))
+	{
+		treesel = gtk_tree_view_get_selection(GTK_TREE_VIEW(view));
+		gtk_tree_selection_select_iter(treesel, &iter);
+	}
+}
+
+
+/* builder_dialog_progress */
+static void _builder_dialog_progress(GtkWidget * widget, gdouble fraction,
+		char const * text)
+{
+	GtkProgressBar * progress = GTK_PROGRESS_BAR(widget);
+	char const * p;
+
+	/* only redraw what changed */
+	if(gtk_progress_bar_get_fraction(progress) != fraction)
+		gtk_progress_bar_set_fraction(progress, fraction);
+	if((p = gtk_progress_bar_get_text(progress)) == NULL
+			|| strcmp(p, text) != 0)
+		gtk_progress_bar_set_text(progress, text);
+}
+
+
 /* builder_dialog_run */
 static int _builder_dialog_run(struct bsddialog_conf const * conf,
 		GtkWidget * dialog)
@@ -160,4 +160,51 @@ int builder_yesno(struct bsddialog_conf const * conf,
 		char const * text, int rows, int cols,
 		int argc, char const ** argv, struct options const * opt);
 
+/* builders (native arguments) */
+int builder_calendar_values(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int * yy, unsigned int * mm, unsigned int * dd,
+		struct options const * opt);
+int builder_checklist_items(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int nitems, struct bsddialog_menuitem * items,
+		int * focusitem, struct options const * opt);
+int builder_datebox_values(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int * yy, unsigned int * mm, unsigned int * dd,
+		struct options const * opt);
+int builder_form_items(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int nitems, struct bsddialog_formitem * items,
+		struct options const * opt);
+int builder_gauge_fd(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, unsigned int perc,
+		int fd, char const * sep, struct options const * opt);
+int builder_menu_items(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int nitems, struct bsddialog_menuitem * items,
+		int * focusitem, struct options const * opt);
+int builder_mixedgauge_bars(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, unsigned int mainperc,
+		unsigned int nminibars, char const ** minilabels,
+		int * minipercs, struct options const * opt);
+int builder_mixedlist_groups(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int ngroups, struct bsddialog_menugroup * groups,
+		int * focuslist, int * focusitem, struct options const * opt);
+int builder_pause_seconds(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, unsigned int seconds,
+		struct options const * opt);
+int builder_radiolist_items(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int nitems, struct bsddialog_menuitem * items,
+		int * focusitem, struct options const * opt);
+int builder_rangebox_values(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols, int min, int max,
+		int * value, struct options const * opt);
+int builder_timebox_values(struct bsddialog_conf const * conf,
+		char const * text, int rows, int cols,
+		unsigned int * hh, unsigned int * mm, unsigned int * ss,
+		struct options const * opt);
+
 #endif /* !GBSDDIALOG_BUILDERS_H */
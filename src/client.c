@@ -0,0 +1,281 @@
+/* gbsddialog */
+/* client.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "protocol.h"
+
+#ifndef PACKAGE
+# define PACKAGE		"gbsddialog"
+#endif
+#ifndef PROGNAME
+# define PROGNAME		PACKAGE "-client"
+#endif
+#ifndef PROGNAME_GBSDDIALOG
+# define PROGNAME_GBSDDIALOG	"gbsddialog"
+#endif
+
+/* matches the exit code for BSDDIALOG_ERROR */
+#define EXITCODE_ERROR		255
+
+
+/* variables */
+extern char ** environ;
+
+
+/* prototypes */
+static int _client(int argc, char * argv[]);
+static int _client_connect(void);
+static int _client_environ(char const * entry);
+static int _client_output_fd(int argc, char * argv[]);
+static int _client_request(int fd, int cwd, int argc, char * argv[]);
+
+static int _error(char const * message, int ret);
+
+
+/* functions */
+/* main */
+int main(int argc, char * argv[])
+{
+	int ret;
+
+	if((ret = _client(argc, argv)) >= 0)
+		return ret;
+	/* fallback to the full implementation */
+	argv[0] = PROGNAME_GBSDDIALOG;
+	execvp(PROGNAME_GBSDDIALOG, argv);
+	_exit(127);
+}
+
+
+/* client */
+static int _client(int argc, char * argv[])
+{
+	int fd, cwd, ret;
+	int i;
+
+	for(i = 1; i < argc; i++)
+		if(strcmp(argv[i], "--help") == 0
+				|| strcmp(argv[i], "--version") == 0)
+			/* handled by the full implementation */
+			return -1;
+	/* the daemon runs the request from the current directory */
+	if((cwd = open(".", O_RDONLY | O_DIRECTORY)) < 0)
+		return -1;
+	if((fd = _client_connect()) < 0)
+	{
+		close(cwd);
+		return -1;
+	}
+	ret = _client_request(fd, cwd, argc, argv);
+	close(fd);
+	close(cwd);
+	return ret;
+}
+
+
+/* client_connect */
+static int _client_connect(void)
+{
+	char const * display;
+	char const * tmpdir;
+	struct sockaddr_un addr;
+	int fd;
+
+	if((display = getenv("DISPLAY")) == NULL || strlen(display) == 0)
+		return -1;
+	if((tmpdir = getenv("TMPDIR")) == NULL || strlen(tmpdir) == 0)
+		tmpdir = "/tmp";
+	/* look for a running instance */
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if((size_t)snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/%s-%s",
+				tmpdir, display, PACKAGE)
+			>= sizeof(addr.sun_path))
+		return -1;
+	addr.sun_len = sizeof(addr) - sizeof(addr.sun_path)
+		+ strlen(addr.sun_path) + 1;
+	if(access(addr.sun_path, W_OK) != 0)
+		return -1;
+	if((fd = socket(addr.sun_family, SOCK_STREAM, 0)) < 0)
+		return -1;
+	if(connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+
+/* client_environ */
+static int _client_environ(char const * entry)
+{
+	char const * forward[] = { GBSDDIALOG_PROTOCOL_ENV };
+	size_t i;
+
+	for(i = 0; i < sizeof(forward) / sizeof(*forward); i++)
+		if(strncmp(entry, forward[i], strlen(forward[i])) == 0)
+			return 1;
+	return 0;
+}
+
+
+/* client_output_fd */
+static int _client_output_fd(int argc, char * argv[])
+{
+	int ret = -1;
+	int i;
+	char const * p = NULL;
+	char * q;
+
+	/* the last occurrence wins, as with getopt_long() */
+	for(i = 1; i < argc; i++)
+		if(strcmp(argv[i], "--output-fd") == 0 && i + 1 < argc)
+			p = argv[++i];
+		else if(strncmp(argv[i], "--output-fd=", 12) == 0)
+			p = &argv[i][12];
+	if(p != NULL)
+	{
+		ret = strtol(p, &q, 10);
+		if(p[0] == '\0' || *q != '\0' || ret <= STDERR_FILENO)
+			ret = -1;
+	}
+	return ret;
+}
+
+
+/* client_request */
+static int _client_request(int fd, int cwd, int argc, char * argv[])
+{
+	struct gbsddialog_request request;
+	struct msghdr msg;
+	struct iovec iov;
+	union
+	{
+		struct cmsghdr cmsg;
+		char buf[CMSG_SPACE(sizeof(int) * GBSDDIALOG_PROTOCOL_FDS)];
+	} control;
+	struct cmsghdr * cmsg;
+	int fds[GBSDDIALOG_PROTOCOL_FDS] = { STDIN_FILENO, STDOUT_FILENO,
+		STDERR_FILENO, cwd, -1 };
+	size_t fds_cnt = GBSDDIALOG_PROTOCOL_FDS - 1;
+	char * buf;
+	size_t size, len, envc;
+	ssize_t s;
+	int i;
+	int32_t ret;
+
+	/* serialize the arguments and the environment */
+	for(i = 0, size = 0; i < argc; i++)
+		size += strlen(argv[i]) + 1;
+	for(i = 0, envc = 0; environ[i] != NULL; i++)
+		if(_client_environ(environ[i]))
+		{
+			size += strlen(environ[i]) + 1;
+			envc++;
+		}
+	if(size > GBSDDIALOG_PROTOCOL_SIZE_MAX)
+		return -1;
+	memset(&request, 0, sizeof(request));
+	memcpy(request.magic, GBSDDIALOG_PROTOCOL_MAGIC,
+			GBSDDIALOG_PROTOCOL_MAGIC_SIZE);
+	request.argc = argc;
+	request.envc = envc;
+	request.size = size;
+	if((request.output_fd = _client_output_fd(argc, argv)) >= 0)
+		fds[fds_cnt++] = request.output_fd;
+	size += sizeof(request);
+	if((buf = malloc(size)) == NULL)
+		return _error(strerror(errno), EXITCODE_ERROR);
+	memcpy(buf, &request, sizeof(request));
+	for(i = 0, len = sizeof(request); i < argc; i++)
+	{
+		memcpy(&buf[len], argv[i], strlen(argv[i]) + 1);
+		len += strlen(argv[i]) + 1;
+	}
+	for(i = 0; environ[i] != NULL; i++)
+		if(_client_environ(environ[i]))
+		{
+			memcpy(&buf[len], environ[i], strlen(environ[i]) + 1);
+			len += strlen(environ[i]) + 1;
+		}
+	/* pass the descriptors along with the arguments */
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = buf;
+	iov.iov_len = size;
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	memset(&control, 0, sizeof(control));
+	msg.msg_control = control.buf;
+	msg.msg_controllen = CMSG_SPACE(sizeof(int) * fds_cnt);
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds_cnt);
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fds_cnt);
+	if((s = sendmsg(fd, &msg, 0)) < 0)
+	{
+		free(buf);
+		/* the daemon is not usable */
+		return -1;
+	}
+	/* send the rest of the arguments if necessary */
+	for(len = s; len < size; len += s)
+		if((s = send(fd, &buf[len], size - len, 0)) <= 0)
+		{
+			free(buf);
+			return _error(strerror(errno), EXITCODE_ERROR);
+		}
+	free(buf);
+	/* wait for the exit code */
+	if((s = recv(fd, &ret, sizeof(ret), MSG_WAITALL)) != sizeof(ret))
+		return _error((s < 0) ? strerror(errno)
+				: "Unexpected end of file", EXITCODE_ERROR);
+	return ret;
+}
+
+
+/* error */
+static int _error(char const * message, int ret)
+{
+	fprintf(stderr, "%s: %s\n", PROGNAME, message);
+	return ret;
+}
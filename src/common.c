@@ -42,7 +42,7 @@
 
 
 /* variables */
-struct exitcode exitcodes[] =
+struct exitcode exitcodes[EXITCODES_COUNT] =
 {
 	{ "BSDDIALOG_ERROR",    255 },
 	{ "BSDDIALOG_OK",         0 },
@@ -203,11 +203,21 @@ void init_entropy(void)
 /* init_exitcodes */
 void init_exitcodes(void)
 {
+	static struct exitcode defaults[EXITCODES_COUNT];
+	static int defaults_set = 0;
 	size_t i;
 	char const * p;
 	int v;
 
-	for(i = 0; i < sizeof(exitcodes) / sizeof(*exitcodes); i++)
+	/* start over from the defaults when called again */
+	if(defaults_set)
+		memcpy(exitcodes, defaults, sizeof(defaults));
+	else
+	{
+		memcpy(defaults, exitcodes, sizeof(defaults));
+		defaults_set = 1;
+	}
+	for(i = 0; i < EXITCODES_COUNT; i++)
 	{
 		if((p = getenv(exitcodes[i].name)) == NULL)
 			continue;
@@ -35,6 +35,7 @@
 # include <stdbool.h>
 # include <gtk/gtk.h>
 # include "bsddialog.h"
+# include "output.h"
 
 
 /* common */
@@ -63,6 +64,7 @@
 # define DEFAULT_COLS_PER_ROW	10
 
 # define EXITCODE(retval)	(exitcodes[retval + 1].value)
+# define EXITCODES_COUNT		14
 
 
 /* types */
@@ -85,10 +87,15 @@ struct options
 	bool item_always_quote;
 	char *item_default;
 	bool item_depth;
+	int item_expand;
+	bool item_filter;
+	char *items_from;
 	char *item_output_sep;
 	bool item_output_sepnl;
 	bool item_prefix;
 	bool item_singlequote;
+	bool item_sort;
+	bool large_list;
 	/* Menus and Forms options */
 	bool help_print_item_name;
 	bool help_print_items;
@@ -101,6 +108,18 @@ struct options
 	/* Help */
 	char * help;
 #endif
+	/* Gauge options */
+	bool gauge_compact;
+	char const * gauge_exec;
+	char const * gauge_file;
+	bool gauge_pipe;
+	char const * gauge_process;
+	char const * gauge_shm;
+	unsigned long long gauge_size;
+	bool mixedgauge_stdin;
+	/* Command options */
+	char const * exec_filter;
+	bool textbox_exec;
 	/* Date and Time options */
 	char *date_fmt;
 	char *time_fmt;
@@ -110,6 +129,8 @@ struct options
 	bool ignore;
 	bool ignore_eof;
 	int output_fd;
+	OutputFormat output_format;
+	Output * result;
 #ifdef WITH_XDIALOG
 	bool pixelsize;
 	bool wrap;
@@ -163,7 +184,7 @@ struct options
 
 
 /* variables */
-extern struct exitcode exitcodes[];
+extern struct exitcode exitcodes[EXITCODES_COUNT];
 
 
 /* functions */
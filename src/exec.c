@@ -0,0 +1,270 @@
+/* gbsddialog */
+/* exec.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include "exec.h"
+
+
+/* Exec */
+/* private */
+/* types */
+struct _Exec
+{
+	GPid pid;			/* 0 once reaped */
+	int status;
+	int fd;
+	guint timeout;
+
+	/* filter */
+	GRegex * regex;
+	GString * line;			/* incomplete line */
+	GString * output;
+};
+
+
+/* constants */
+#define EXEC_TERMINATE_TIMEOUT	2000	/* in milliseconds */
+
+
+/* prototypes */
+static void _exec_filter_line(Exec * exec, char const * line, size_t size);
+
+/* callbacks */
+static void _exec_on_child(GPid pid, gint status, gpointer data);
+static void _exec_on_child_setup(gpointer data);
+static gboolean _exec_on_timeout(gpointer data);
+
+
+/* public */
+/* functions */
+/* exec_new */
+Exec * exec_new(char const * command, gboolean errors, GError ** error)
+{
+	Exec * exec;
+	char * argv[] = { "/bin/sh", "-c", NULL, NULL };
+	const GSpawnFlags flags = G_SPAWN_DO_NOT_REAP_CHILD;
+
+	argv[2] = (char *)command;
+	exec = g_new(Exec, 1);
+	exec->pid = 0;
+	exec->status = -1;
+	exec->fd = -1;
+	exec->timeout = 0;
+	exec->regex = NULL;
+	exec->line = NULL;
+	exec->output = NULL;
+	if(g_spawn_async_with_pipes(NULL, argv, NULL, flags,
+				_exec_on_child_setup, GINT_TO_POINTER(errors),
+				&exec->pid, NULL, &exec->fd, NULL, error)
+			!= TRUE)
+	{
+		g_free(exec);
+		return NULL;
+	}
+	g_child_watch_add(exec->pid, _exec_on_child, exec);
+	return exec;
+}
+
+
+/* exec_delete */
+void exec_delete(Exec * exec)
+{
+	if(exec->pid != 0)
+		exec_wait(exec, TRUE);
+	if(exec->regex != NULL)
+		g_regex_unref(exec->regex);
+	if(exec->line != NULL)
+		g_string_free(exec->line, TRUE);
+	if(exec->output != NULL)
+		g_string_free(exec->output, TRUE);
+	g_free(exec);
+}
+
+
+/* accessors */
+/* exec_get_fd */
+int exec_get_fd(Exec * exec)
+{
+	return exec->fd;
+}
+
+
+/* exec_set_filter */
+int exec_set_filter(Exec * exec, char const * pattern, GError ** error)
+{
+	GRegex * regex;
+
+	/* the output is not necessarily valid UTF-8 */
+	if((regex = g_regex_new(pattern, G_REGEX_RAW | G_REGEX_OPTIMIZE, 0,
+					error)) == NULL)
+		return -1;
+	if(exec->regex != NULL)
+		g_regex_unref(exec->regex);
+	exec->regex = regex;
+	if(exec->line == NULL)
+		exec->line = g_string_new(NULL);
+	if(exec->output == NULL)
+		exec->output = g_string_new(NULL);
+	return 0;
+}
+
+
+/* useful */
+/* exec_filter */
+char const * exec_filter(Exec * exec, char const * buf, size_t size,
+		size_t * len)
+{
+	char const * p;
+	size_t l;
+
+	if(exec->regex == NULL)
+	{
+		*len = (buf != NULL) ? size : 0;
+		return buf;
+	}
+	g_string_truncate(exec->output, 0);
+	if(buf == NULL)
+	{
+		if(exec->line->len > 0)
+			_exec_filter_line(exec, exec->line->str,
+					exec->line->len);
+		g_string_truncate(exec->line, 0);
+	}
+	else
+		for(; size > 0; buf += l, size -= l)
+		{
+			if((p = memchr(buf, '\n', size)) == NULL)
+			{
+				/* kept until the end of the line */
+				g_string_append_len(exec->line, buf, size);
+				break;
+			}
+			l = p - buf + 1;
+			if(exec->line->len == 0)
+				_exec_filter_line(exec, buf, l - 1);
+			else
+			{
+				g_string_append_len(exec->line, buf, l - 1);
+				_exec_filter_line(exec, exec->line->str,
+						exec->line->len);
+				g_string_truncate(exec->line, 0);
+			}
+		}
+	*len = exec->output->len;
+	return exec->output->str;
+}
+
+
+/* exec_wait */
+int exec_wait(Exec * exec, gboolean terminate)
+{
+	if(exec->pid != 0 && terminate)
+	{
+		/* along with its own children */
+		kill(-exec->pid, SIGTERM);
+		/* bounded, in case SIGTERM is ignored or handled slowly */
+		exec->timeout = g_timeout_add(EXEC_TERMINATE_TIMEOUT,
+				_exec_on_timeout, exec);
+	}
+	/* the child is reaped by the main loop */
+	while(exec->pid != 0)
+		g_main_context_iteration(NULL, TRUE);
+	if(exec->timeout != 0)
+		g_source_remove(exec->timeout);
+	exec->timeout = 0;
+	return exec->status;
+}
+
+
+/* private */
+/* functions */
+/* exec_filter_line */
+static void _exec_filter_line(Exec * exec, char const * line, size_t size)
+{
+	GMatchInfo * match;
+	gint start;
+	gint end;
+
+	if(g_regex_match_full(exec->regex, line, size, 0, 0, &match, NULL)
+			== TRUE)
+	{
+		if(g_match_info_get_match_count(match) > 1
+				&& g_match_info_fetch_pos(match, 1, &start,
+					&end) == TRUE && start >= 0)
+			g_string_append_len(exec->output, &line[start],
+					end - start);
+		else
+			g_string_append_len(exec->output, line, size);
+		g_string_append_c(exec->output, '\n');
+	}
+	g_match_info_free(match);
+}
+
+
+/* callbacks */
+/* exec_on_child */
+static void _exec_on_child(GPid pid, gint status, gpointer data)
+{
+	Exec * exec = data;
+
+	g_spawn_close_pid(pid);
+	exec->status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+	exec->pid = 0;
+}
+
+
+/* exec_on_child_setup */
+static void _exec_on_child_setup(gpointer data)
+{
+	gboolean errors = GPOINTER_TO_INT(data);
+
+	/* terminated as a group */
+	setpgid(0, 0);
+	/* the errors are read along with the output */
+	if(errors)
+		dup2(STDOUT_FILENO, STDERR_FILENO);
+}
+
+
+/* exec_on_timeout */
+static gboolean _exec_on_timeout(gpointer data)
+{
+	Exec * exec = data;
+
+	exec->timeout = 0;
+	kill(-exec->pid, SIGKILL);
+	return FALSE;
+}
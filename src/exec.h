@@ -0,0 +1,68 @@
+/* gbsddialog */
+/* exec.h */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#ifndef GBSDDIALOG_EXEC_H
+# define GBSDDIALOG_EXEC_H
+
+# include <glib.h>
+
+
+/* Exec */
+/* types */
+typedef struct _Exec Exec;
+
+
+/* functions */
+/* runs the command with the shell, reading its output and optionally its
+ * errors */
+Exec * exec_new(char const * command, gboolean errors, GError ** error);
+/* terminates the command if still running */
+void exec_delete(Exec * exec);
+
+/* accessors */
+/* the caller is responsible for closing it */
+int exec_get_fd(Exec * exec);
+
+/* only keeps the lines matching, or their first group if any */
+int exec_set_filter(Exec * exec, char const * pattern, GError ** error);
+
+/* useful */
+/* returns what remains of the output read, the rest of the last line once
+ * buf is NULL (valid until the next call) */
+char const * exec_filter(Exec * exec, char const * buf, size_t size,
+		size_t * len);
+/* returns the exit status, or -1 if not exited normally; the command is
+ * terminated first if still running when asked to, and the main loop keeps
+ * running until it has exited */
+int exec_wait(Exec * exec, gboolean terminate);
+
+#endif /* !GBSDDIALOG_EXEC_H */
@@ -0,0 +1,205 @@
+/* gbsddialog */
+/* feed.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#include <string.h>
+#include "feed.h"
+
+
+/* Feed */
+/* private */
+/* types */
+struct _Feed
+{
+	FeedCallback callback;
+	gpointer data;
+
+	GByteArray * buffer;
+	size_t start;			/* committed already */
+	size_t chunk;			/* committed at once */
+	gboolean full;
+	gboolean closed;
+};
+
+
+/* constants */
+/* time spent committing data for every frame (in microseconds) */
+#define FEED_BUDGET		4000
+/* the budget is checked after every chunk, adapted to last this long */
+#define FEED_CHUNK_TIME		(FEED_BUDGET / 4)
+#define FEED_CHUNK_MIN		4096
+#define FEED_CHUNK_MAX		(1024 * 1024)
+/* reading is paused above this backlog, and resumed below half of it */
+#define FEED_FULL		(8 * 1024 * 1024)
+
+
+/* prototypes */
+static void _feed_adapt(Feed * feed, size_t len, gint64 elapsed);
+
+
+/* public */
+/* functions */
+/* feed_new */
+Feed * feed_new(FeedCallback callback, gpointer data)
+{
+	Feed * feed;
+
+	feed = g_new(Feed, 1);
+	feed->callback = callback;
+	feed->data = data;
+	feed->buffer = g_byte_array_new();
+	feed->start = 0;
+	feed->chunk = FEED_CHUNK_MIN * 4;
+	feed->full = FALSE;
+	feed->closed = FALSE;
+	return feed;
+}
+
+
+/* feed_delete */
+void feed_delete(Feed * feed)
+{
+	g_byte_array_free(feed->buffer, TRUE);
+	g_free(feed);
+}
+
+
+/* accessors */
+/* feed_get_pending */
+size_t feed_get_pending(Feed * feed)
+{
+	return feed->buffer->len - feed->start;
+}
+
+
+/* feed_is_full */
+gboolean feed_is_full(Feed * feed)
+{
+	return feed->full;
+}
+
+
+/* useful */
+/* feed_append */
+void feed_append(Feed * feed, char const * buf, size_t len)
+{
+	size_t pending;
+
+	if(len == 0)
+		return;
+	/* reclaim the data committed already */
+	if(feed->start > 0 && feed->start >= feed->buffer->len / 2)
+	{
+		pending = feed_get_pending(feed);
+		memmove(feed->buffer->data, &feed->buffer->data[feed->start],
+				pending);
+		g_byte_array_set_size(feed->buffer, pending);
+		feed->start = 0;
+	}
+	g_byte_array_append(feed->buffer, (guint8 const *)buf, len);
+	if(feed_get_pending(feed) >= FEED_FULL)
+		feed->full = TRUE;
+}
+
+
+/* feed_close */
+void feed_close(Feed * feed)
+{
+	feed->closed = TRUE;
+}
+
+
+/* feed_flush */
+gboolean feed_flush(Feed * feed)
+{
+	gint64 start;
+	gint64 then;
+	gint64 now;
+	size_t pending;
+	size_t len;
+	size_t n;
+	gboolean last;
+	gboolean ret = FALSE;
+
+	start = now = g_get_monotonic_time();
+	while((pending = feed_get_pending(feed)) > 0)
+	{
+		if(now - start >= FEED_BUDGET)
+		{
+			ret = TRUE;
+			break;
+		}
+		len = MIN(pending, feed->chunk);
+		/* a full backlog is committed even if incomplete, as reading
+		 * is paused meanwhile */
+		last = (feed->closed || feed->full) && len == pending;
+		then = now;
+		n = feed->callback((char const *)&feed->buffer->data[
+				feed->start], len, last, feed->data);
+		now = g_get_monotonic_time();
+		if(n == 0 && last)
+			/* cannot be committed anymore */
+			n = len;
+		else if(n == 0 && len < pending)
+		{
+			/* the chunk is too small for the callback */
+			feed->chunk = len * 2;
+			continue;
+		}
+		else if(n == 0)
+			/* waiting for more data */
+			break;
+		feed->start += n;
+		_feed_adapt(feed, n, now - then);
+	}
+	if(feed->start == feed->buffer->len)
+	{
+		g_byte_array_set_size(feed->buffer, 0);
+		feed->start = 0;
+	}
+	if(feed->full && feed_get_pending(feed) < FEED_FULL / 2)
+		feed->full = FALSE;
+	return ret;
+}
+
+
+/* private */
+/* functions */
+/* feed_adapt */
+static void _feed_adapt(Feed * feed, size_t len, gint64 elapsed)
+{
+	size_t chunk;
+
+	/* averaged with the previous size to absorb the variations */
+	chunk = len * FEED_CHUNK_TIME / MAX(elapsed, 1);
+	chunk = (feed->chunk + chunk) / 2;
+	feed->chunk = CLAMP(chunk, FEED_CHUNK_MIN, FEED_CHUNK_MAX);
+}
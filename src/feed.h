@@ -0,0 +1,66 @@
+/* gbsddialog */
+/* feed.h */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#ifndef GBSDDIALOG_FEED_H
+# define GBSDDIALOG_FEED_H
+
+# include <glib.h>
+
+
+/* Feed */
+/* types */
+typedef struct _Feed Feed;
+
+/* commits up to len bytes of buf, returns how many were committed; last is
+ * set when no more data follows, or none until this data is committed */
+typedef size_t (*FeedCallback)(char const * buf, size_t len, gboolean last,
+		gpointer data);
+
+
+/* functions */
+Feed * feed_new(FeedCallback callback, gpointer data);
+void feed_delete(Feed * feed);
+
+/* accessors */
+size_t feed_get_pending(Feed * feed);
+/* reading should be paused while the backlog is full */
+gboolean feed_is_full(Feed * feed);
+
+/* useful */
+void feed_append(Feed * feed, char const * buf, size_t len);
+/* no more data will be appended */
+void feed_close(Feed * feed);
+/* commits data within the time budget of a frame, returns TRUE if more
+ * can be committed already */
+gboolean feed_flush(Feed * feed);
+
+#endif /* !GBSDDIALOG_FEED_H */
@@ -0,0 +1,541 @@
+/* gbsddialog */
+/* gaugeparser.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include "gaugeparser.h"
+
+
+/* GaugeParser */
+/* private */
+/* types */
+typedef enum _GaugeParserState
+{
+	GPS_INIT = 0,			/* waiting for a separator */
+	GPS_SEPARATOR,			/* separator read */
+	GPS_PERCENTAGE,			/* percentage read */
+	GPS_TEXT			/* reading text */
+} GaugeParserState;
+
+typedef struct _GaugeParserItem
+{
+	gchar * label;
+	int percentage;
+} GaugeParserItem;
+
+struct _GaugeParser
+{
+	GaugeParserMode mode;
+	gchar * sep;
+	size_t seplen;
+	gboolean eof;
+
+	GString * line;			/* incomplete line */
+	GString * text;
+	unsigned int percentage;
+	unsigned int changes;
+
+	/* GPM_GAUGE */
+	GaugeParserState state;
+
+	/* GPM_MIXEDGAUGE */
+	GPtrArray * items;
+
+	/* GPM_PROGRESS */
+	int msglen;
+	gboolean linestart;
+	gboolean number;
+	unsigned int value;
+};
+
+
+/* constants */
+#define GAUGEPARSER_READS	16
+
+
+/* prototypes */
+static void _gaugeparser_feed_gauge(GaugeParser * parser, char const * buf,
+		size_t size);
+static void _gaugeparser_feed_progress(GaugeParser * parser,
+		char const * buf, size_t size);
+static void _gaugeparser_item_delete(GaugeParserItem * item);
+static void _gaugeparser_line(GaugeParser * parser, char const * line,
+		size_t size);
+static gboolean _gaugeparser_number(char const * line, size_t size,
+		size_t * pos, int * number);
+static void _gaugeparser_record(GaugeParser * parser, char const * line,
+		size_t size);
+
+
+/* public */
+/* functions */
+/* gaugeparser_new */
+GaugeParser * gaugeparser_new(GaugeParserMode mode, char const * sep,
+		int msglen)
+{
+	GaugeParser * parser;
+
+	parser = g_new(GaugeParser, 1);
+	parser->mode = mode;
+	parser->sep = g_strdup((sep != NULL) ? sep : "XXX");
+	parser->seplen = strlen(parser->sep);
+	parser->eof = FALSE;
+	parser->line = g_string_new(NULL);
+	parser->text = g_string_new(NULL);
+	parser->percentage = 0;
+	parser->changes = GPC_NONE;
+	parser->state = GPS_INIT;
+	parser->items = g_ptr_array_new_with_free_func(
+			(GDestroyNotify)_gaugeparser_item_delete);
+	parser->msglen = msglen;
+	parser->linestart = TRUE;
+	parser->number = FALSE;
+	parser->value = 0;
+	return parser;
+}
+
+
+/* gaugeparser_delete */
+void gaugeparser_delete(GaugeParser * parser)
+{
+	g_string_free(parser->line, TRUE);
+	g_string_free(parser->text, TRUE);
+	g_ptr_array_free(parser->items, TRUE);
+	g_free(parser->sep);
+	g_free(parser);
+}
+
+
+/* accessors */
+/* gaugeparser_get_percentage */
+unsigned int gaugeparser_get_percentage(GaugeParser * parser)
+{
+	return parser->percentage;
+}
+
+
+/* gaugeparser_get_text */
+char const * gaugeparser_get_text(GaugeParser * parser)
+{
+	return parser->text->str;
+}
+
+
+/* gaugeparser_get_item */
+char const * gaugeparser_get_item(GaugeParser * parser, unsigned int i,
+		int * percentage)
+{
+	GaugeParserItem * item;
+
+	if(i >= parser->items->len)
+		return NULL;
+	item = g_ptr_array_index(parser->items, i);
+	if(percentage != NULL)
+		*percentage = item->percentage;
+	return item->label;
+}
+
+
+/* gaugeparser_set_item */
+void gaugeparser_set_item(GaugeParser * parser, char const * label,
+		int percentage)
+{
+	GaugeParserItem * item;
+	guint i;
+
+	for(i = 0; i < parser->items->len; i++)
+	{
+		item = g_ptr_array_index(parser->items, i);
+		if(strcmp(item->label, label) == 0)
+		{
+			item->percentage = percentage;
+			parser->changes |= GPC_ITEMS;
+			return;
+		}
+	}
+	item = g_new(GaugeParserItem, 1);
+	item->label = g_strdup(label);
+	item->percentage = percentage;
+	g_ptr_array_add(parser->items, item);
+	parser->changes |= GPC_ITEMS;
+}
+
+
+/* useful */
+/* gaugeparser_feed */
+unsigned int gaugeparser_feed(GaugeParser * parser, char const * buf,
+		size_t size)
+{
+	unsigned int changes;
+
+	if(parser->eof == FALSE)
+		switch(parser->mode)
+		{
+			case GPM_GAUGE:
+			case GPM_GAUGE_COMPACT:
+			case GPM_MIXEDGAUGE:
+				_gaugeparser_feed_gauge(parser, buf, size);
+				break;
+			case GPM_PROGRESS:
+				_gaugeparser_feed_progress(parser, buf, size);
+				break;
+		}
+	changes = parser->changes;
+	parser->changes = GPC_NONE;
+	return changes;
+}
+
+
+/* gaugeparser_flush */
+unsigned int gaugeparser_flush(GaugeParser * parser)
+{
+	if(parser->mode != GPM_PROGRESS && parser->eof == FALSE
+			&& parser->line->len > 0)
+	{
+		_gaugeparser_line(parser, parser->line->str,
+				parser->line->len);
+		g_string_truncate(parser->line, 0);
+	}
+	else if(parser->mode == GPM_PROGRESS && parser->msglen == 0)
+		/* terminates a pending count */
+		_gaugeparser_feed_progress(parser, "\n", 1);
+	return gaugeparser_feed(parser, NULL, 0);
+}
+
+
+/* gaugeparser_read */
+GIOStatus gaugeparser_read(GaugeParser * parser, GIOChannel * channel,
+		unsigned int * changes, GError ** error)
+{
+	GIOStatus ret = G_IO_STATUS_AGAIN;
+	GIOStatus status;
+	char buf[BUFSIZ];
+	gsize r;
+	size_t i;
+
+	/* bounded so that a fast producer cannot starve the interface */
+	for(i = 0; i < GAUGEPARSER_READS; i++)
+	{
+		status = g_io_channel_read_chars(channel, buf, sizeof(buf),
+				&r, error);
+		if(status == G_IO_STATUS_ERROR)
+			return status;
+		else if(status == G_IO_STATUS_EOF)
+		{
+			*changes |= gaugeparser_flush(parser);
+			return status;
+		}
+		else if(status == G_IO_STATUS_AGAIN)
+			break;
+		ret = G_IO_STATUS_NORMAL;
+		*changes |= gaugeparser_feed(parser, buf, r);
+		if(*changes & GPC_EOF)
+			break;
+	}
+	return ret;
+}
+
+
+/* private */
+/* functions */
+/* gaugeparser_feed_gauge */
+static void _gaugeparser_feed_gauge(GaugeParser * parser, char const * buf,
+		size_t size)
+{
+	char const * p;
+	size_t len;
+
+	while(size > 0 && parser->eof == FALSE)
+	{
+		if((p = memchr(buf, '\n', size)) == NULL)
+		{
+			/* kept until the end of the line */
+			g_string_append_len(parser->line, buf, size);
+			return;
+		}
+		len = p - buf;
+		if(parser->line->len > 0)
+		{
+			g_string_append_len(parser->line, buf, len);
+			_gaugeparser_line(parser, parser->line->str,
+					parser->line->len);
+			g_string_truncate(parser->line, 0);
+		}
+		else
+			_gaugeparser_line(parser, buf, len);
+		buf += len + 1;
+		size -= len + 1;
+	}
+}
+
+
+/* gaugeparser_feed_progress */
+static void _gaugeparser_feed_progress(GaugeParser * parser,
+		char const * buf, size_t size)
+{
+	size_t len;
+	unsigned char c;
+
+	while(size > 0)
+	{
+		if(parser->msglen > 0)
+		{
+			/* the message */
+			len = MIN(size, (size_t)parser->msglen);
+			g_string_append_len(parser->text, buf, len);
+			parser->changes |= GPC_TEXT;
+			parser->msglen -= len;
+			buf += len;
+			size -= len;
+			continue;
+		}
+		else if(parser->msglen < 0)
+		{
+			/* skip the message */
+			len = MIN(size, (size_t)-parser->msglen);
+			parser->msglen += len;
+			buf += len;
+			size -= len;
+			continue;
+		}
+		c = *(buf++);
+		size--;
+		if(c == '\n')
+		{
+			if(parser->number)
+			{
+				/* set the current count */
+				parser->percentage = parser->value;
+				parser->changes |= GPC_PERCENTAGE;
+				parser->number = FALSE;
+			}
+			parser->linestart = TRUE;
+		}
+		else if(parser->linestart && (c == ' ' || c == '\t'))
+			continue;
+		else if(parser->linestart && isdigit(c))
+		{
+			parser->number = TRUE;
+			parser->value = c - '0';
+			parser->linestart = FALSE;
+		}
+		else if(parser->number)
+		{
+			/* ignore what follows the count */
+			if(isdigit(c) && parser->value < G_MAXUINT / 10)
+				parser->value = parser->value * 10 + c - '0';
+		}
+		else
+		{
+			/* count the dots */
+			if(parser->percentage < G_MAXUINT)
+				parser->percentage++;
+			parser->changes |= GPC_PERCENTAGE;
+			parser->linestart = FALSE;
+		}
+	}
+}
+
+
+/* gaugeparser_item_delete */
+static void _gaugeparser_item_delete(GaugeParserItem * item)
+{
+	g_free(item->label);
+	g_free(item);
+}
+
+
+/* gaugeparser_line */
+static void _gaugeparser_line(GaugeParser * parser, char const * line,
+		size_t size)
+{
+	size_t i;
+	unsigned int perc;
+
+	if(size == 3 && memcmp(line, "EOF", 3) == 0)
+	{
+		parser->eof = TRUE;
+		parser->changes |= GPC_EOF;
+		return;
+	}
+	if(parser->mode == GPM_GAUGE_COMPACT
+			|| parser->mode == GPM_MIXEDGAUGE)
+	{
+		_gaugeparser_record(parser, line, size);
+		return;
+	}
+	if(size == parser->seplen && memcmp(line, parser->sep, size) == 0)
+	{
+		/* found a separator */
+		parser->state = GPS_SEPARATOR;
+		return;
+	}
+	switch(parser->state)
+	{
+		case GPS_INIT:
+			break;
+		case GPS_SEPARATOR:
+			for(i = 0; i < size && isspace((unsigned char)line[i]);
+					i++);
+			if(i < size && isdigit((unsigned char)line[i]))
+			{
+				/* set the current percentage */
+				for(perc = 0; i < size && isdigit(
+							(unsigned char)line[i]);
+						i++)
+					if(perc <= 100)
+						perc = perc * 10 + line[i]
+							- '0';
+				parser->percentage = MIN(perc, 100);
+				g_string_truncate(parser->text, 0);
+				parser->changes |= GPC_PERCENTAGE | GPC_TEXT;
+				parser->state = GPS_PERCENTAGE;
+				break;
+			}
+			/* fallthrough */
+		case GPS_PERCENTAGE:
+			/* set the current text */
+			g_string_truncate(parser->text, 0);
+			g_string_append_len(parser->text, line, size);
+			parser->changes |= GPC_TEXT;
+			parser->state = GPS_TEXT;
+			break;
+		case GPS_TEXT:
+			/* append to the current text */
+			g_string_append_c(parser->text, '\n');
+			g_string_append_len(parser->text, line, size);
+			parser->changes |= GPC_TEXT;
+			break;
+	}
+}
+
+
+/* gaugeparser_number */
+static gboolean _gaugeparser_number(char const * line, size_t size,
+		size_t * pos, int * number)
+{
+	size_t i = *pos;
+	gboolean negative = FALSE;
+	int n;
+
+	for(; i < size && isspace((unsigned char)line[i]); i++);
+	if(i < size && line[i] == '-')
+	{
+		negative = TRUE;
+		i++;
+	}
+	if(i >= size || !isdigit((unsigned char)line[i]))
+		return FALSE;
+	for(n = 0; i < size && isdigit((unsigned char)line[i]); i++)
+		if(n < G_MAXINT / 10)
+			n = n * 10 + line[i] - '0';
+	*number = negative ? -n : n;
+	*pos = i;
+	return TRUE;
+}
+
+
+/* gaugeparser_record */
+/* P <perc>: sets the main percentage
+ * T <text>: sets the text
+ * A <text>: appends a line to the text
+ * I <perc> <label>: sets (or adds) an item (GPM_MIXEDGAUGE)
+ * R <label>: removes an item (GPM_MIXEDGAUGE)
+ * D: done */
+static void _gaugeparser_record(GaugeParser * parser, char const * line,
+		size_t size)
+{
+	size_t i = 1;
+	int perc;
+	GaugeParserItem * item;
+	gchar * label;
+	guint j;
+
+	if(size == 0 || (size > 1 && line[1] != ' '))
+		return;
+	switch(line[0])
+	{
+		case 'P':
+			if(_gaugeparser_number(line, size, &i, &perc) == FALSE)
+				break;
+			parser->percentage = CLAMP(perc, 0, 100);
+			parser->changes |= GPC_PERCENTAGE;
+			break;
+		case 'T':
+			g_string_truncate(parser->text, 0);
+			if(size > 2)
+				g_string_append_len(parser->text, &line[2],
+						size - 2);
+			parser->changes |= GPC_TEXT;
+			break;
+		case 'A':
+			if(parser->text->len > 0)
+				g_string_append_c(parser->text, '\n');
+			if(size > 2)
+				g_string_append_len(parser->text, &line[2],
+						size - 2);
+			parser->changes |= GPC_TEXT;
+			break;
+		case 'I':
+			if(parser->mode != GPM_MIXEDGAUGE
+					|| _gaugeparser_number(line, size, &i,
+						&perc) == FALSE
+					|| i + 1 >= size || line[i] != ' ')
+				break;
+			label = g_strndup(&line[i + 1], size - i - 1);
+			gaugeparser_set_item(parser, label, perc);
+			g_free(label);
+			break;
+		case 'R':
+			if(parser->mode != GPM_MIXEDGAUGE || size <= 2)
+				break;
+			for(j = 0; j < parser->items->len; j++)
+			{
+				item = g_ptr_array_index(parser->items, j);
+				if(strlen(item->label) == size - 2
+						&& memcmp(item->label, &line[2],
+							size - 2) == 0)
+				{
+					g_ptr_array_remove_index(parser->items,
+							j);
+					parser->changes |= GPC_ITEMS;
+					break;
+				}
+			}
+			break;
+		case 'D':
+			parser->eof = TRUE;
+			parser->changes |= GPC_EOF;
+			break;
+	}
+}
@@ -0,0 +1,89 @@
+/* gbsddialog */
+/* gaugeparser.h */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#ifndef GBSDDIALOG_GAUGEPARSER_H
+# define GBSDDIALOG_GAUGEPARSER_H
+
+# include <glib.h>
+
+
+/* GaugeParser */
+/* types */
+typedef struct _GaugeParser GaugeParser;
+
+typedef enum _GaugeParserMode
+{
+	GPM_GAUGE = 0,			/* percentages and XXX blocks */
+	GPM_GAUGE_COMPACT,		/* one record per line */
+	GPM_MIXEDGAUGE,			/* GPM_GAUGE_COMPACT and items */
+	GPM_PROGRESS			/* a message, then dots or counts */
+} GaugeParserMode;
+
+typedef enum _GaugeParserChange
+{
+	GPC_NONE = 0x0,
+	GPC_PERCENTAGE = 0x1,
+	GPC_TEXT = 0x2,
+	GPC_EOF = 0x4,
+	GPC_ITEMS = 0x8
+} GaugeParserChange;
+
+
+/* functions */
+/* the separator only applies to GPM_GAUGE, the message length to
+ * GPM_PROGRESS (skipped if negative) */
+GaugeParser * gaugeparser_new(GaugeParserMode mode, char const * sep,
+		int msglen);
+void gaugeparser_delete(GaugeParser * parser);
+
+/* accessors */
+/* a percentage with GPM_GAUGE, a count with GPM_PROGRESS */
+unsigned int gaugeparser_get_percentage(GaugeParser * parser);
+char const * gaugeparser_get_text(GaugeParser * parser);
+
+/* the items of GPM_MIXEDGAUGE, NULL past the last one */
+char const * gaugeparser_get_item(GaugeParser * parser, unsigned int i,
+		int * percentage);
+void gaugeparser_set_item(GaugeParser * parser, char const * label,
+		int percentage);
+
+/* useful */
+/* return the changes since the last call, as GaugeParserChange flags */
+unsigned int gaugeparser_feed(GaugeParser * parser, char const * buf,
+		size_t size);
+/* completes the last line at the end of the input */
+unsigned int gaugeparser_flush(GaugeParser * parser);
+/* reads what is available from the channel and feeds it */
+GIOStatus gaugeparser_read(GaugeParser * parser, GIOChannel * channel,
+		unsigned int * changes, GError ** error);
+
+#endif /* !GBSDDIALOG_GAUGEPARSER_H */
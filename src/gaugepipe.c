@@ -0,0 +1,312 @@
+/* gbsddialog */
+/* gaugepipe.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+# define _GNU_SOURCE			/* for splice() and copy_file_range() */
+#endif
+#include <sys/types.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include "gaugepipe.h"
+
+/* splice() is only declared with _GNU_SOURCE (and copy_file_range() as well
+ * with the GNU libc) */
+#if defined(SPLICE_F_MOVE)
+# define GAUGEPIPE_SPLICE
+# define GAUGEPIPE_COPY_FILE_RANGE
+#elif defined(__FreeBSD__) && __FreeBSD_version >= 1300000
+# define GAUGEPIPE_COPY_FILE_RANGE
+#endif
+
+
+/* GaugePipe */
+/* private */
+/* types */
+typedef enum _GaugePipeTransfer
+{
+	GPT_SPLICE = 0,			/* either side is a pipe */
+	GPT_COPY_FILE_RANGE,		/* both sides are regular files */
+	GPT_READ_WRITE			/* anything else */
+} GaugePipeTransfer;
+
+struct _GaugePipe
+{
+	int in;
+	int out;
+	guint64 total;
+	guint64 count;
+	gboolean fifo;			/* the output is a pipe */
+	gboolean stream;		/* writing to the output may block */
+	GaugePipeTransfer transfer;
+	GIOCondition condition;		/* waited for */
+	char * buf;			/* only for GPT_READ_WRITE */
+	size_t pos;			/* written so far */
+	size_t len;			/* read so far */
+};
+
+
+/* constants */
+#define GAUGEPIPE_CHUNK		65536
+#define GAUGEPIPE_TRANSFERS	16
+
+
+/* prototypes */
+static GIOCondition _gaugepipe_condition(GaugePipe * gp);
+static ssize_t _gaugepipe_read_write(GaugePipe * gp);
+static ssize_t _gaugepipe_transfer(GaugePipe * gp);
+
+
+/* public */
+/* functions */
+/* gaugepipe_new */
+GaugePipe * gaugepipe_new(int in, int out, guint64 total)
+{
+	GaugePipe * gp;
+	struct stat sti;
+	struct stat sto;
+	off_t offset;
+
+	if(fstat(in, &sti) != 0 || fstat(out, &sto) != 0)
+		return NULL;
+	gp = g_new(GaugePipe, 1);
+	gp->in = in;
+	gp->out = out;
+	/* a slow consumer must not block the interface: the output is shared,
+	 * so it is polled instead of being made non-blocking */
+	gp->fifo = S_ISFIFO(sto.st_mode);
+	gp->stream = !S_ISREG(sto.st_mode);
+	gp->total = total;
+	gp->count = 0;
+	if(S_ISFIFO(sti.st_mode) || S_ISFIFO(sto.st_mode))
+		gp->transfer = GPT_SPLICE;
+	else if(S_ISREG(sti.st_mode) && S_ISREG(sto.st_mode))
+		gp->transfer = GPT_COPY_FILE_RANGE;
+	else
+		gp->transfer = GPT_READ_WRITE;
+	gp->condition = G_IO_IN;
+	gp->buf = NULL;
+	gp->pos = 0;
+	gp->len = 0;
+	if(gp->total == 0 && S_ISREG(sti.st_mode))
+	{
+		/* the input may have been partially read already */
+		if((offset = lseek(in, 0, SEEK_CUR)) < 0
+				|| offset > sti.st_size)
+			offset = 0;
+		gp->total = sti.st_size - offset;
+	}
+	return gp;
+}
+
+
+/* gaugepipe_delete */
+void gaugepipe_delete(GaugePipe * gp)
+{
+	g_free(gp->buf);
+	g_free(gp);
+}
+
+
+/* accessors */
+/* gaugepipe_get_condition */
+GIOCondition gaugepipe_get_condition(GaugePipe * gp)
+{
+	return gp->condition;
+}
+
+
+/* gaugepipe_get_count */
+guint64 gaugepipe_get_count(GaugePipe * gp)
+{
+	return gp->count;
+}
+
+
+/* gaugepipe_get_percentage */
+int gaugepipe_get_percentage(GaugePipe * gp)
+{
+	if(gp->total == 0)
+		return -1;
+	if(gp->count >= gp->total)
+		return 100;
+	return (int)(gp->count * 100 / gp->total);
+}
+
+
+/* useful */
+/* gaugepipe_transfer */
+GIOStatus gaugepipe_transfer(GaugePipe * gp, GError ** error)
+{
+	GIOStatus ret = G_IO_STATUS_AGAIN;
+	ssize_t s;
+	size_t i;
+
+	gp->condition = G_IO_IN;
+	/* bounded so that a fast producer cannot starve the interface */
+	for(i = 0; i < GAUGEPIPE_TRANSFERS; i++)
+	{
+		if((s = _gaugepipe_transfer(gp)) > 0)
+		{
+			gp->count += s;
+			ret = G_IO_STATUS_NORMAL;
+		}
+		else if(s == 0)
+			return G_IO_STATUS_EOF;
+		else if(errno == EAGAIN || errno == EWOULDBLOCK)
+			break;
+		else if(errno != EINTR)
+		{
+			g_set_error(error, G_FILE_ERROR,
+					g_file_error_from_errno(errno), "%s",
+					strerror(errno));
+			return G_IO_STATUS_ERROR;
+		}
+	}
+	return ret;
+}
+
+
+/* private */
+/* functions */
+/* gaugepipe_condition */
+static GIOCondition _gaugepipe_condition(GaugePipe * gp)
+{
+	struct pollfd pfd;
+
+	pfd.fd = gp->out;
+	pfd.events = POLLOUT;
+	pfd.revents = 0;
+	/* without waiting: errors are reported by the next transfer */
+	if(poll(&pfd, 1, 0) == 0)
+		return G_IO_OUT;
+	return G_IO_IN;
+}
+
+
+/* gaugepipe_read_write */
+static ssize_t _gaugepipe_read_write(GaugePipe * gp)
+{
+	ssize_t r;
+	ssize_t w;
+	size_t len;
+
+	if(gp->stream && (gp->condition = _gaugepipe_condition(gp))
+			== G_IO_OUT)
+	{
+		errno = EAGAIN;
+		return -1;
+	}
+	if(gp->buf == NULL)
+		gp->buf = g_malloc(GAUGEPIPE_CHUNK);
+	/* the remainder of the last chunk is written first */
+	if(gp->pos == gp->len)
+	{
+		if((r = read(gp->in, gp->buf, GAUGEPIPE_CHUNK)) <= 0)
+			return r;
+		gp->pos = 0;
+		gp->len = r;
+	}
+	/* at most PIPE_BUF bytes are known to fit */
+	len = gp->len - gp->pos;
+	if(gp->stream && len > PIPE_BUF)
+		len = PIPE_BUF;
+	if((w = write(gp->out, &gp->buf[gp->pos], len)) <= 0)
+	{
+		if(w == 0)
+			errno = EAGAIN;
+		if(errno == EAGAIN || errno == EWOULDBLOCK)
+			gp->condition = G_IO_OUT;
+		return -1;
+	}
+	gp->pos += w;
+	return w;
+}
+
+
+/* gaugepipe_transfer */
+static ssize_t _gaugepipe_transfer(GaugePipe * gp)
+{
+#if defined(GAUGEPIPE_SPLICE) || defined(GAUGEPIPE_COPY_FILE_RANGE)
+	ssize_t s;
+#endif
+
+	switch(gp->transfer)
+	{
+		case GPT_SPLICE:
+#ifdef GAUGEPIPE_SPLICE
+			/* only non-blocking for pipes otherwise */
+			if(gp->stream && !gp->fifo && (gp->condition
+						= _gaugepipe_condition(gp))
+					== G_IO_OUT)
+			{
+				errno = EAGAIN;
+				return -1;
+			}
+			s = splice(gp->in, NULL, gp->out, NULL,
+					(gp->stream && !gp->fifo) ? PIPE_BUF
+					: GAUGEPIPE_CHUNK, SPLICE_F_MOVE
+					| SPLICE_F_MORE | SPLICE_F_NONBLOCK);
+			if(s < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			{
+				/* the output may be full instead of the input
+				 * being empty: do not spin on the input then */
+				gp->condition = _gaugepipe_condition(gp);
+				errno = EAGAIN;
+			}
+			if(s >= 0 || errno != EINVAL)
+				return s;
+#endif
+			gp->transfer = GPT_READ_WRITE;
+			return _gaugepipe_read_write(gp);
+		case GPT_COPY_FILE_RANGE:
+#ifdef GAUGEPIPE_COPY_FILE_RANGE
+			s = copy_file_range(gp->in, NULL, gp->out, NULL,
+					GAUGEPIPE_CHUNK, 0);
+			if(s >= 0 || (errno != EINVAL && errno != EXDEV
+						&& errno != ENOSYS
+						&& errno != EBADF))
+				return s;
+#endif
+			gp->transfer = GPT_READ_WRITE;
+			return _gaugepipe_read_write(gp);
+		case GPT_READ_WRITE:
+		default:
+			return _gaugepipe_read_write(gp);
+	}
+}
+
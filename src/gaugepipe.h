@@ -0,0 +1,60 @@
+/* gbsddialog */
+/* gaugepipe.h */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#ifndef GBSDDIALOG_GAUGEPIPE_H
+# define GBSDDIALOG_GAUGEPIPE_H
+
+# include <glib.h>
+
+
+/* GaugePipe */
+/* types */
+typedef struct _GaugePipe GaugePipe;
+
+
+/* functions */
+/* the total is obtained from the input if 0 and a regular file */
+GaugePipe * gaugepipe_new(int in, int out, guint64 total);
+void gaugepipe_delete(GaugePipe * gp);
+
+/* accessors */
+/* G_IO_OUT while the output is full, G_IO_IN otherwise */
+GIOCondition gaugepipe_get_condition(GaugePipe * gp);
+guint64 gaugepipe_get_count(GaugePipe * gp);
+/* -1 if the total is not known */
+int gaugepipe_get_percentage(GaugePipe * gp);
+
+/* useful */
+/* copies what is available from the input to the output */
+GIOStatus gaugepipe_transfer(GaugePipe * gp, GError ** error);
+
+#endif /* !GBSDDIALOG_GAUGEPIPE_H */
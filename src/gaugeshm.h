@@ -0,0 +1,200 @@
+/* gbsddialog */
+/* gaugeshm.h */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#ifndef GBSDDIALOG_GAUGESHM_H
+# define GBSDDIALOG_GAUGESHM_H
+
+/* requires POSIX.1-2001 for ftruncate() and nanosleep(): programs built in
+ * strict C modes must define _POSIX_C_SOURCE to 200112L or later */
+
+# include <sys/types.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <stdint.h>
+# include <string.h>
+# include <time.h>
+# include <unistd.h>
+
+
+/* GaugeSHM */
+/* shared with --gauge-shm: the producer only writes to memory, and the
+ * dialog renders the latest consistent state once per frame */
+
+/* constants */
+# define GAUGESHM_MAGIC		0x4d485347	/* "GSHM" */
+# define GAUGESHM_VERSION	1
+
+/* while being initialized, waited for up to this many milliseconds */
+# define GAUGESHM_INIT		0x494d5347	/* "GSMI" */
+# define GAUGESHM_INIT_WAIT	1000
+
+# define GAUGESHM_DONE		0x1		/* closes the dialog */
+
+# define GAUGESHM_TEXT_SIZE	256
+
+
+/* types */
+struct gaugeshm
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t sequence;		/* odd while being updated */
+	uint32_t flags;
+	uint32_t percentage;
+	char text[GAUGESHM_TEXT_SIZE];
+};
+
+
+/* functions */
+/* private */
+static inline struct gaugeshm * _gaugeshm_map(char const * path)
+{
+	struct gaugeshm * shm;
+	struct stat st;
+	int fd;
+	uint32_t magic;
+	unsigned int i;
+	struct timespec ts = { 0, 1000000 };
+
+	if((fd = open(path, O_RDWR | O_CREAT, 0600)) < 0)
+		return NULL;
+	if(fstat(fd, &st) != 0 || (st.st_size < (off_t)sizeof(*shm)
+				&& ftruncate(fd, sizeof(*shm)) != 0))
+	{
+		close(fd);
+		return NULL;
+	}
+	shm = mmap(NULL, sizeof(*shm), PROT_READ | PROT_WRITE, MAP_SHARED,
+			fd, 0);
+	close(fd);
+	if(shm == MAP_FAILED)
+		return NULL;
+	/* initialized only once, by whoever claims it first; the sequence is
+	 * kept across users */
+	for(i = 0; (magic = __atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE))
+			!= GAUGESHM_MAGIC || shm->version != GAUGESHM_VERSION;
+			i++)
+	{
+		if(magic == GAUGESHM_INIT && i < GAUGESHM_INIT_WAIT)
+		{
+			nanosleep(&ts, NULL);
+			continue;
+		}
+		/* also taken over if the initialization never completed */
+		if(!__atomic_compare_exchange_n(&shm->magic, &magic,
+					GAUGESHM_INIT, 0, __ATOMIC_ACQ_REL,
+					__ATOMIC_ACQUIRE))
+			continue;
+		shm->sequence = 0;
+		shm->flags = 0;
+		shm->percentage = 0;
+		shm->text[0] = '\0';
+		shm->version = GAUGESHM_VERSION;
+		__atomic_store_n(&shm->magic, GAUGESHM_MAGIC,
+				__ATOMIC_RELEASE);
+	}
+	return shm;
+}
+
+
+/* prototypes */
+static inline void gaugeshm_update(struct gaugeshm * shm,
+		unsigned int percentage, char const * text, uint32_t flags);
+
+
+/* public */
+/* attaches to the channel at path, leaving its current state as is */
+static inline struct gaugeshm * gaugeshm_attach(char const * path)
+{
+	return _gaugeshm_map(path);
+}
+
+/* creates or resets the channel at path */
+static inline struct gaugeshm * gaugeshm_open(char const * path)
+{
+	struct gaugeshm * shm;
+
+	if((shm = _gaugeshm_map(path)) == NULL)
+		return NULL;
+	/* seen as a regular update by any dialog already attached */
+	gaugeshm_update(shm, 0, "", 0);
+	return shm;
+}
+
+static inline void gaugeshm_close(struct gaugeshm * shm)
+{
+	munmap(shm, sizeof(*shm));
+}
+
+/* useful */
+/* the text is left unchanged if NULL */
+static inline void gaugeshm_update(struct gaugeshm * shm,
+		unsigned int percentage, char const * text, uint32_t flags)
+{
+	uint32_t sequence;
+
+	sequence = __atomic_load_n(&shm->sequence, __ATOMIC_RELAXED) | 0x1;
+	__atomic_store_n(&shm->sequence, sequence, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	shm->percentage = percentage;
+	shm->flags = flags;
+	if(text != NULL)
+	{
+		strncpy(shm->text, text, sizeof(shm->text) - 1);
+		shm->text[sizeof(shm->text) - 1] = '\0';
+	}
+	__atomic_store_n(&shm->sequence, sequence + 1, __ATOMIC_RELEASE);
+}
+
+/* copies a consistent state, returns -1 while being updated */
+static inline int gaugeshm_read(struct gaugeshm const * shm,
+		struct gaugeshm * state)
+{
+	uint32_t sequence;
+
+	if(__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != GAUGESHM_MAGIC
+			|| shm->version != GAUGESHM_VERSION)
+		return -1;
+	sequence = __atomic_load_n(&shm->sequence, __ATOMIC_ACQUIRE);
+	if(sequence & 0x1)
+		return -1;
+	memcpy(state, shm, sizeof(*state));
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if(__atomic_load_n(&shm->sequence, __ATOMIC_RELAXED) != sequence)
+		return -1;
+	state->sequence = sequence;
+	state->text[sizeof(state->text) - 1] = '\0';
+	return 0;
+}
+
+#endif /* !GBSDDIALOG_GAUGESHM_H */
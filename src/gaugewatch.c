@@ -0,0 +1,375 @@
+/* gbsddialog */
+/* gaugewatch.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef __FreeBSD__
+# include <sys/param.h>
+# include <sys/sysctl.h>
+# include <sys/user.h>
+#endif
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <gio/gio.h>
+#include "gaugewatch.h"
+
+
+/* GaugeWatch */
+/* private */
+/* types */
+typedef enum _GaugeWatchSource
+{
+	GWS_FILE = 0,
+	GWS_PROCESS
+} GaugeWatchSource;
+
+struct _GaugeWatch
+{
+	GaugeWatchSource source;
+	gchar * path;			/* the file, or its fdinfo */
+	guint64 total;
+	guint64 count;
+
+	/* GWS_FILE */
+	GFileMonitor * monitor;
+	gboolean dirty;			/* changed since the last sample */
+
+	/* GWS_PROCESS */
+	pid_t pid;
+	int fd;
+};
+
+
+/* constants */
+#define GAUGEWATCH_RATE_LIMIT	16	/* in milliseconds */
+
+
+/* prototypes */
+static GaugeWatch * _gaugewatch_new(GaugeWatchSource source, gchar * path,
+		guint64 total);
+
+static gboolean _gaugewatch_sample_file(GaugeWatch * gw, guint64 * count,
+		GError ** error);
+static gboolean _gaugewatch_sample_process(GaugeWatch * gw,
+		guint64 * count);
+
+#ifdef __FreeBSD__
+static int _gaugewatch_get_file(pid_t pid, int fd, guint64 * offset,
+		guint64 * size);
+#endif
+
+/* callbacks */
+static void _gaugewatch_on_changed(gpointer data);
+
+
+/* public */
+/* functions */
+/* gaugewatch_new_file */
+GaugeWatch * gaugewatch_new_file(char const * filename, guint64 total,
+		GError ** error)
+{
+	GaugeWatch * gw;
+	GFile * file;
+	(void) error;
+
+	gw = _gaugewatch_new(GWS_FILE, g_strdup(filename), total);
+	/* notified of the changes if possible, the file is sampled otherwise;
+	 * it does not have to exist yet */
+	file = g_file_new_for_path(filename);
+	if((gw->monitor = g_file_monitor_file(file, G_FILE_MONITOR_NONE, NULL,
+					NULL)) != NULL)
+	{
+		g_file_monitor_set_rate_limit(gw->monitor,
+				GAUGEWATCH_RATE_LIMIT);
+		g_signal_connect_swapped(gw->monitor, "changed", G_CALLBACK(
+					_gaugewatch_on_changed), gw);
+	}
+	g_object_unref(file);
+	return gw;
+}
+
+
+/* gaugewatch_new_process */
+GaugeWatch * gaugewatch_new_process(char const * process, guint64 total,
+		GError ** error)
+{
+#ifdef __linux__
+	GaugeWatch * gw;
+	unsigned long pid;
+	unsigned long fd;
+	char c;
+	gchar * path;
+	struct stat st;
+
+	if(sscanf(process, "%lu:%lu%c", &pid, &fd, &c) != 2)
+	{
+		g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+				"%s: %s", process, "Invalid process");
+		return NULL;
+	}
+	gw = _gaugewatch_new(GWS_PROCESS, g_strdup_printf("/proc/%lu/fdinfo/%lu",
+				pid, fd), total);
+	if(access(gw->path, R_OK) != 0)
+	{
+		g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errno),
+				"%s: %s", process, strerror(errno));
+		gaugewatch_delete(gw);
+		return NULL;
+	}
+	if(gw->total == 0)
+	{
+		/* the total is the size of the file being read */
+		path = g_strdup_printf("/proc/%lu/fd/%lu", pid, fd);
+		if(stat(path, &st) == 0 && S_ISREG(st.st_mode))
+			gw->total = st.st_size;
+		g_free(path);
+	}
+	return gw;
+#elif defined(__FreeBSD__)
+	GaugeWatch * gw;
+	unsigned long pid;
+	unsigned long fd;
+	char c;
+	guint64 size = 0;
+
+	if(sscanf(process, "%lu:%lu%c", &pid, &fd, &c) != 2)
+	{
+		g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+				"%s: %s", process, "Invalid process");
+		return NULL;
+	}
+	gw = _gaugewatch_new(GWS_PROCESS, NULL, total);
+	gw->pid = pid;
+	gw->fd = fd;
+	if(_gaugewatch_get_file(gw->pid, gw->fd, &gw->count, &size) != 0)
+	{
+		g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errno),
+				"%s: %s", process, strerror(errno));
+		gaugewatch_delete(gw);
+		return NULL;
+	}
+	/* the total is the size of the file being read */
+	if(gw->total == 0)
+		gw->total = size;
+	return gw;
+#else
+	(void) total;
+
+	g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_NOSYS, "%s: %s",
+			process, strerror(ENOSYS));
+	return NULL;
+#endif
+}
+
+
+/* gaugewatch_delete */
+void gaugewatch_delete(GaugeWatch * gw)
+{
+	if(gw->monitor != NULL)
+	{
+		g_file_monitor_cancel(gw->monitor);
+		g_object_unref(gw->monitor);
+	}
+	g_free(gw->path);
+	g_free(gw);
+}
+
+
+/* accessors */
+/* gaugewatch_get_count */
+guint64 gaugewatch_get_count(GaugeWatch * gw)
+{
+	return gw->count;
+}
+
+
+/* gaugewatch_get_percentage */
+int gaugewatch_get_percentage(GaugeWatch * gw)
+{
+	if(gw->total == 0)
+		return -1;
+	if(gw->count >= gw->total)
+		return 100;
+	return (int)(gw->count * 100 / gw->total);
+}
+
+
+/* useful */
+/* gaugewatch_sample */
+GIOStatus gaugewatch_sample(GaugeWatch * gw, GError ** error)
+{
+	guint64 count = gw->count;
+
+	switch(gw->source)
+	{
+		case GWS_FILE:
+			if(gw->monitor != NULL && gw->dirty == FALSE)
+				return G_IO_STATUS_AGAIN;
+			gw->dirty = FALSE;
+			if(_gaugewatch_sample_file(gw, &count, error) != TRUE)
+				return G_IO_STATUS_ERROR;
+			break;
+		case GWS_PROCESS:
+			/* the process closed the file or exited */
+			if(_gaugewatch_sample_process(gw, &count) != TRUE)
+				return G_IO_STATUS_EOF;
+			break;
+	}
+	if(count == gw->count)
+		return G_IO_STATUS_AGAIN;
+	gw->count = count;
+	if(gw->source == GWS_FILE && gw->total != 0 && count >= gw->total)
+		return G_IO_STATUS_EOF;
+	return G_IO_STATUS_NORMAL;
+}
+
+
+/* private */
+/* functions */
+/* gaugewatch_new */
+static GaugeWatch * _gaugewatch_new(GaugeWatchSource source, gchar * path,
+		guint64 total)
+{
+	GaugeWatch * gw;
+
+	gw = g_new(GaugeWatch, 1);
+	gw->source = source;
+	gw->path = path;
+	gw->total = total;
+	gw->count = 0;
+	gw->monitor = NULL;
+	gw->dirty = TRUE;
+	gw->pid = 0;
+	gw->fd = -1;
+	return gw;
+}
+
+
+/* gaugewatch_sample_file */
+static gboolean _gaugewatch_sample_file(GaugeWatch * gw, guint64 * count,
+		GError ** error)
+{
+	struct stat st;
+
+	if(stat(gw->path, &st) == 0)
+		*count = st.st_size;
+	else if(errno == ENOENT)
+		/* not created yet, or replaced */
+		*count = 0;
+	else
+	{
+		g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errno),
+				"%s: %s", gw->path, strerror(errno));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+
+/* gaugewatch_sample_process */
+static gboolean _gaugewatch_sample_process(GaugeWatch * gw, guint64 * count)
+{
+#ifdef __FreeBSD__
+	return (_gaugewatch_get_file(gw->pid, gw->fd, count, NULL) == 0)
+		? TRUE : FALSE;
+#else
+	gchar * buf;
+	char const * p;
+
+	if(g_file_get_contents(gw->path, &buf, NULL, NULL) != TRUE)
+		return FALSE;
+	/* the offset comes first, as "pos:\t<offset>" */
+	if((p = strstr(buf, "pos:")) != NULL)
+		*count = g_ascii_strtoull(p + 4, NULL, 10);
+	g_free(buf);
+	return TRUE;
+#endif
+}
+
+
+#ifdef __FreeBSD__
+/* gaugewatch_get_file */
+/* as kinfo_getfile(3), without depending on libutil */
+static int _gaugewatch_get_file(pid_t pid, int fd, guint64 * offset,
+		guint64 * size)
+{
+	int mib[4] = { CTL_KERN, KERN_PROC, KERN_PROC_FILEDESC, 0 };
+	size_t len;
+	char * buf;
+	char * p;
+	struct kinfo_file * kf;
+	int ret = -1;
+
+	mib[3] = pid;
+	if(sysctl(mib, 4, NULL, &len, NULL, 0) != 0)
+		return -1;
+	/* more files may be opened in the meantime */
+	len = len * 4 / 3;
+	buf = g_malloc(len);
+	if(sysctl(mib, 4, buf, &len, NULL, 0) != 0)
+	{
+		g_free(buf);
+		return -1;
+	}
+	errno = EBADF;
+	for(p = buf; p + sizeof(kf->kf_structsize) <= buf + len;
+			p += kf->kf_structsize)
+	{
+		kf = (struct kinfo_file *)p;
+		if(kf->kf_structsize <= 0)
+			break;
+		if(kf->kf_fd != fd)
+			continue;
+		*offset = (kf->kf_offset > 0) ? (guint64)kf->kf_offset : 0;
+		if(size != NULL)
+			*size = (kf->kf_type == KF_TYPE_VNODE
+					&& kf->kf_vnode_type == KF_VTYPE_VREG)
+				? (guint64)kf->kf_un.kf_file.kf_file_size : 0;
+		ret = 0;
+		break;
+	}
+	g_free(buf);
+	return ret;
+}
+#endif
+
+
+/* callbacks */
+/* gaugewatch_on_changed */
+static void _gaugewatch_on_changed(gpointer data)
+{
+	GaugeWatch * gw = data;
+
+	gw->dirty = TRUE;
+}
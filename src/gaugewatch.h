@@ -0,0 +1,63 @@
+/* gbsddialog */
+/* gaugewatch.h */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#ifndef GBSDDIALOG_GAUGEWATCH_H
+# define GBSDDIALOG_GAUGEWATCH_H
+
+# include <glib.h>
+
+
+/* GaugeWatch */
+/* types */
+typedef struct _GaugeWatch GaugeWatch;
+
+
+/* functions */
+/* the size of a file growing */
+GaugeWatch * gaugewatch_new_file(char const * filename, guint64 total,
+		GError ** error);
+/* the offset of a file in a process, as "pid:fd"; the total is obtained
+ * from the file if 0 */
+GaugeWatch * gaugewatch_new_process(char const * process, guint64 total,
+		GError ** error);
+void gaugewatch_delete(GaugeWatch * gw);
+
+/* accessors */
+guint64 gaugewatch_get_count(GaugeWatch * gw);
+/* -1 if the total is not known */
+int gaugewatch_get_percentage(GaugeWatch * gw);
+
+/* useful */
+/* returns G_IO_STATUS_AGAIN if unchanged, G_IO_STATUS_EOF once complete */
+GIOStatus gaugewatch_sample(GaugeWatch * gw, GError ** error);
+
+#endif /* !GBSDDIALOG_GAUGEWATCH_H */
@@ -30,12 +30,17 @@
 
 
 
+#include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/un.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <limits.h>
+#include <ctype.h>
+#include <signal.h>
 #include <string.h>
 #include <time.h>
 #include <errno.h>
@@ -43,6 +48,10 @@
 #include "builders.h"
 #include "common.h"
 #include "gbsddialog.h"
+#include "output.h"
+#include "protocol.h"
+
+extern char ** environ;
 
 /* FIXME conflicts with <sys/syslimits.h> */
 #ifdef MAX_INPUT
@@ -72,6 +81,23 @@ typedef struct _GBSDDialog
 
 	int socket;
 	guint id;
+
+	/* for the current client */
+	int client;
+	guint client_id;
+	guint client_timeout;
+	char buf[256 + 1];
+	size_t buf_cnt;
+	struct gbsddialog_request request;
+	char * data;
+	size_t data_cnt;
+	int fds[GBSDDIALOG_PROTOCOL_FDS];
+	size_t fds_cnt;
+
+	/* for remote requests */
+	struct _GBSDDialog * server;
+	int output_fd[2];
+	GSList * themes;		/* loaded for the request only */
 } GBSDDialog;
 
 /* for getopt_long() */
@@ -120,6 +146,7 @@ enum OPTS {
 #endif
 	ERROR_EXIT_CODE,
 	ESC_EXIT_CODE,
+	EXEC_FILTER,
 	EXIT_LABEL,
 	EXTRA_BUTTON,
 	EXTRA_EXIT_CODE,
@@ -127,6 +154,15 @@ enum OPTS {
 #ifdef WITH_XDIALOG
 	FILL,
 	FIXED_FONT,
+#endif
+	GAUGE_COMPACT,
+	GAUGE_EXEC,
+	GAUGE_FILE,
+	GAUGE_PIPE,
+	GAUGE_PROCESS,
+	GAUGE_SHM,
+	GAUGE_SIZE,
+#ifdef WITH_XDIALOG
 	HELP,
 #endif
 	HELP_BUTTON,
@@ -147,7 +183,12 @@ enum OPTS {
 	INSECURE,
 	ITEM_BOTTOM_DESC,
 	ITEM_DEPTH,
+	ITEM_EXPAND,
+	ITEM_FILTER,
 	ITEM_PREFIX,
+	ITEM_SORT,
+	ITEMS_FROM,
+	LARGE_LIST,
 #ifdef WITH_XDIALOG
 	LEFT,
 #endif
@@ -159,6 +200,7 @@ enum OPTS {
 	LEFT3_EXIT_CODE,
 	LOAD_THEME,
 	MAX_INPUT,
+	MIXEDGAUGE_STDIN,
 	NO_BUTTONS,
 	NO_CANCEL,
 #ifdef WITH_XDIALOG
@@ -176,6 +218,7 @@ enum OPTS {
 	OK_EXIT_CODE,
 	OK_LABEL,
 	OUTPUT_FD,
+	OUTPUT_FORMAT,
 	OUTPUT_SEPARATOR,
 #ifdef WITH_XDIALOG
 	PASSWORD,
@@ -214,6 +257,7 @@ enum OPTS {
 	TAB_LEN,
 	TEXT_ESCAPE,
 	TEXT_UNCHANGED,
+	TEXTBOX_EXEC,
 	THEME,
 	TIMEOUT_EXIT_CODE,
 	TIME_FORMAT,
@@ -332,6 +376,7 @@ static struct option longopts[] = {
 #endif
 	{"error-exit-code",   required_argument, NULL, ERROR_EXIT_CODE},
 	{"esc-exit-code",     required_argument, NULL, ESC_EXIT_CODE},
+	{"exec-filter",       required_argument, NULL, EXEC_FILTER},
 	{"exit-label",        required_argument, NULL, EXIT_LABEL},
 	{"extra-button",      no_argument,       NULL, EXTRA_BUTTON},
 	{"extra-exit-code",   required_argument, NULL, EXTRA_EXIT_CODE},
@@ -339,6 +384,15 @@ static struct option longopts[] = {
 #ifdef WITH_XDIALOG
 	{"fill",              no_argument,       NULL, FIXED_FONT},
 	{"fixed-font",        no_argument,       NULL, FIXED_FONT},
+#endif
+	{"gauge-compact",     no_argument,       NULL, GAUGE_COMPACT},
+	{"gauge-exec",        required_argument, NULL, GAUGE_EXEC},
+	{"gauge-file",        required_argument, NULL, GAUGE_FILE},
+	{"gauge-pipe",        no_argument,       NULL, GAUGE_PIPE},
+	{"gauge-process",     required_argument, NULL, GAUGE_PROCESS},
+	{"gauge-shm",         required_argument, NULL, GAUGE_SHM},
+	{"gauge-size",        required_argument, NULL, GAUGE_SIZE},
+#ifdef WITH_XDIALOG
 	{"help",              required_argument, NULL, HELP},
 #endif
 	{"help-button",       no_argument,       NULL, HELP_BUTTON},
@@ -363,9 +417,14 @@ static struct option longopts[] = {
 	{"insecure",          no_argument,       NULL, INSECURE},
 	{"item-bottom-desc",  no_argument,       NULL, ITEM_BOTTOM_DESC},
 	{"item-depth",        no_argument,       NULL, ITEM_DEPTH},
+	{"item-expand",       required_argument, NULL, ITEM_EXPAND},
+	{"item-filter",       no_argument,       NULL, ITEM_FILTER},
 	{"item-help",         no_argument,       NULL, ITEM_BOTTOM_DESC},
 	{"item-prefix",       no_argument,       NULL, ITEM_PREFIX},
+	{"item-sort",         no_argument,       NULL, ITEM_SORT},
+	{"items-from",        required_argument, NULL, ITEMS_FROM},
 	{"keep-tite",         no_argument,       NULL, ALTERNATE_SCREEN},
+	{"large-list",        no_argument,       NULL, LARGE_LIST},
 #ifdef WITH_XDIALOG
 	{"left",              no_argument,       NULL, LEFT},
 #endif
@@ -379,6 +438,7 @@ static struct option longopts[] = {
 #endif
 	{"load-theme",        required_argument, NULL, LOAD_THEME},
 	{"max-input",         required_argument, NULL, MAX_INPUT},
+	{"mixedgauge-stdin",  no_argument,       NULL, MIXEDGAUGE_STDIN},
 #ifdef WITH_XDIALOG
 	{"no-buttons",        no_argument,       NULL, NO_BUTTONS},
 #endif
@@ -404,6 +464,7 @@ static struct option longopts[] = {
 	{"ok-exit-code",      required_argument, NULL, OK_EXIT_CODE},
 	{"ok-label",          required_argument, NULL, OK_LABEL},
 	{"output-fd",         required_argument, NULL, OUTPUT_FD},
+	{"output-format",     required_argument, NULL, OUTPUT_FORMAT},
 	{"output-separator",  required_argument, NULL, OUTPUT_SEPARATOR},
 #ifdef WITH_XDIALOG
 	{"password",          optional_argument, NULL, PASSWORD},
@@ -450,6 +511,7 @@ static struct option longopts[] = {
 #endif
 	{"text-escape",       no_argument,       NULL, TEXT_ESCAPE},
 	{"text-unchanged",    no_argument,       NULL, TEXT_UNCHANGED},
+	{"textbox-exec",      no_argument,       NULL, TEXTBOX_EXEC},
 	{"theme",             required_argument, NULL, THEME},
 	{"timeout-exit-code", required_argument, NULL, TIMEOUT_EXIT_CODE},
 	{"time-format",       required_argument, NULL, TIME_FORMAT},
@@ -519,9 +581,13 @@ static void _gbsddialog_backtitle(GBSDDialog * gbd);
 
 static void _gbsddialog_clear_screen(GBSDDialog * gbd);
 
+static int _gbsddialog_dialog(GBSDDialog * gbd);
+
 static int _gbsddialog_parseargs(GBSDDialog * gbd,
 		int argc, char const ** argv);
 
+static void _gbsddialog_result(GBSDDialog * gbd, int res);
+
 static gboolean _gbsddialog_theme_load(GBSDDialog * gbd, char const * theme);
 static gboolean _gbsddialog_theme_save(GBSDDialog * gbd, char const * filename);
 
@@ -557,6 +623,10 @@ int gbsddialog(int * ret, int argc, char const ** argv)
 	}
 	gbd->socket = -1;
 	gbd->id = 0;
+	gbd->client = -1;
+	gbd->server = NULL;
+	gbd->output_fd[0] = -1;
+	gbd->output_fd[1] = -1;
 	g_idle_add(_gbsddialog_on_idle, gbd);
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s() => 0\n", __func__);
@@ -567,6 +637,29 @@ int gbsddialog(int * ret, int argc, char const ** argv)
 static gboolean _gbsddialog_on_idle(gpointer data)
 {
 	GBSDDialog * gbd = data;
+
+	if(_gbsddialog_dialog(gbd) != 0)
+		return _gbsddialog_on_idle_quit(gbd);
+	return TRUE;
+}
+
+static gboolean _gbsddialog_on_idle_quit(gpointer data)
+{
+	GBSDDialog * gbd = data;
+
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s()\n", __func__);
+#endif
+	gtk_main_quit();
+	free(gbd);
+	return FALSE;
+}
+
+
+/* private */
+/* gbsddialog_dialog */
+static int _gbsddialog_dialog(GBSDDialog * gbd)
+{
 	struct bsddialog_conf * conf = &gbd->conf;
 	struct options * opt = &gbd->opt;
 	int parsed, argc, oi = optind;
@@ -586,7 +679,19 @@ static gboolean _gbsddialog_on_idle(gpointer data)
 	if((parsed = _gbsddialog_parseargs(gbd, gbd->argc, gbd->argv)) <= 0)
 	{
 		*gbd->ret = EXITCODE(BSDDIALOG_ERROR);
-		return _gbsddialog_on_idle_quit(gbd);
+		return -1;
+	}
+	if(gbd->server != NULL && opt->output_fd > STDERR_FILENO)
+	{
+		/* only use descriptors forwarded by the client */
+		if(opt->output_fd != gbd->output_fd[0])
+		{
+			*gbd->ret = EXITCODE(error(BSDDIALOG_ERROR,
+						"--output-fd %d was not forwarded",
+						opt->output_fd));
+			return -1;
+		}
+		opt->output_fd = gbd->output_fd[1];
 	}
 	argc = parsed - optind;
 	argv = gbd->argv + optind;
@@ -604,16 +709,23 @@ static gboolean _gbsddialog_on_idle(gpointer data)
 	{
 		*gbd->ret = EXITCODE(error(BSDDIALOG_ERROR,
 					"expected a --<dialog>"));
-		return _gbsddialog_on_idle_quit(gbd);
+		return -1;
 	}
 	if(opt->loadthemefile != NULL)
 	{
 		_gbsddialog_theme_load(gbd, opt->loadthemefile);
 		opt->loadthemefile = NULL;
 	}
-	if(opt->clearscreen)
+	if(opt->clearscreen && gbd->server == NULL)
 		_gbsddialog_clear_screen(gbd);
-	if(opt->backtitle != NULL && gbd->windows == NULL)
+	if(opt->backtitle != NULL && gbd->server != NULL)
+	{
+		/* update the backtitle of the server directly */
+		if(gbd->server->label != NULL)
+			gtk_label_set_text(GTK_LABEL(gbd->server->label),
+					opt->backtitle);
+	}
+	else if(opt->backtitle != NULL && gbd->windows == NULL)
 		_gbsddialog_backtitle(gbd);
 	if(opt->dialogbuilder != NULL)
 	{
@@ -635,13 +747,13 @@ static gboolean _gbsddialog_on_idle(gpointer data)
 		{
 			*gbd->ret = EXITCODE(error(BSDDIALOG_ERROR,
 						"expected <text> <rows> <cols>"));
-			return _gbsddialog_on_idle_quit(gbd);
+			return -1;
 		}
 		if((text = strdup(argv[0])) == NULL)
 		{
 			*gbd->ret = EXITCODE(error(BSDDIALOG_ERROR,
 						"cannot allocate <text>"));
-			return _gbsddialog_on_idle_quit(gbd);
+			return -1;
 		}
 #ifdef WITH_XDIALOG
 		if(((p = getenv("XDIALOG_FORCE_AUTOSIZE")) == NULL
@@ -665,6 +777,8 @@ static gboolean _gbsddialog_on_idle(gpointer data)
 		if(opt->beep == true)
 			gdk_display_beep(gdk_screen_get_display(gbd->screen));
 #endif
+		if(opt->output_format != OF_TEXT)
+			opt->result = output_new(opt->output_fd);
 		res = opt->dialogbuilder(conf, text, rows, cols,
 				argc - j, argv + j, opt);
 #ifdef WITH_XDIALOG
@@ -673,17 +787,21 @@ static gboolean _gbsddialog_on_idle(gpointer data)
 #endif
 		*gbd->ret = EXITCODE(res);
 		free(text);
+		if(opt->result != NULL)
+			_gbsddialog_result(gbd, res);
 		if(res == BSDDIALOG_ERROR)
-			return _gbsddialog_on_idle_quit(gbd);
-		if(conf->get_height != NULL && conf->get_width != NULL)
-			dprintf(opt->output_fd, "DialogSize: %d, %d\n",
+			return -1;
+		if(opt->output_format == OF_TEXT
+				&& conf->get_height != NULL
+				&& conf->get_width != NULL)
+			output_dprintf(opt->output_fd, "DialogSize: %d, %d\n",
 					*conf->get_height, *conf->get_width);
 		if(res == BSDDIALOG_CANCEL || res == BSDDIALOG_ESC)
-			return _gbsddialog_on_idle_quit(gbd);
+			return -1;
 	}
 	else
 		/* FIXME report error */
-		return _gbsddialog_on_idle_quit(gbd);
+		return -1;
 
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s() => %d gbd->argc=%d gbd->argv=\"%s\"\n",
@@ -692,30 +810,17 @@ static gboolean _gbsddialog_on_idle(gpointer data)
 #endif
 
 	if(parsed == gbd->argc)
-		return _gbsddialog_on_idle_quit(gbd);
+		return -1;
 
 	gbd->argv[parsed - 1] = gbd->argv[0];
 	gbd->argv += parsed - 1;
 	gbd->argc -= parsed - 1;
 	optind = oi;
 
-	return TRUE;
-}
-
-static gboolean _gbsddialog_on_idle_quit(gpointer data)
-{
-	GBSDDialog * gbd = data;
-
-#ifdef DEBUG
-	fprintf(stderr, "DEBUG: %s()\n", __func__);
-#endif
-	gtk_main_quit();
-	free(gbd);
-	return FALSE;
+	return 0;
 }
 
 
-/* private */
 /* gbsddialog_backtitle */
 #if GTK_CHECK_VERSION(3, 0, 0)
 static void _backtitle_apply_style(GtkWidget * widget,
@@ -1005,14 +1110,31 @@ static gboolean _backtitle_on_delete_event(void)
 
 
 /* gbsddialog_clear_screen */
+static void _clear_screen_close(GBSDDialog * gbd);
+static int _clear_screen_environ(char const * entry);
+static void _clear_screen_environ_put(char const * const * envp);
+static char ** _clear_screen_environ_take(void);
+static int _clear_screen_listen(GBSDDialog * gbd);
 static gboolean _clear_screen_on_accept(GIOChannel * channel,
 		GIOCondition condition, gpointer data);
+static gboolean _clear_screen_on_client(GIOChannel * channel,
+		GIOCondition condition, gpointer data);
+static gboolean _clear_screen_on_timeout(gpointer data);
+static int _clear_screen_peer(int fd);
+static int _clear_screen_receive(GBSDDialog * gbd);
+static int _clear_screen_receive_body(GBSDDialog * gbd);
+static int32_t _clear_screen_request(GBSDDialog * gbd);
+static int _clear_screen_request_run(GBSDDialog * gbd,
+		struct gbsddialog_request * request, char const ** argv,
+		char const ** envp, int * fds, size_t fds_cnt);
+static void _clear_screen_request_themes(GBSDDialog * remote);
 
 static void _gbsddialog_clear_screen(GBSDDialog * gbd)
 {
 	GdkDisplay * display;
 	struct sockaddr_un addr;
-	GIOChannel * channel;
+	mode_t mask;
+	int res;
 
 	if(gbd->opt.backtitle != NULL && gbd->windows == NULL)
 	{
@@ -1031,10 +1153,14 @@ static void _gbsddialog_clear_screen(GBSDDialog * gbd)
 					strerror(errno));
 			return;
 		}
-		if(bind(gbd->socket, (struct sockaddr *)&addr,
-					sizeof(addr)) != 0)
+		/* only allow the current user to connect */
+		mask = umask(S_IRWXG | S_IRWXO);
+		res = bind(gbd->socket, (struct sockaddr *)&addr, sizeof(addr));
+		umask(mask);
+		if(res != 0 || chmod(addr.sun_path, S_IRUSR | S_IWUSR) != 0)
 		{
-			error(BSDDIALOG_ERROR, "%s: %s: %s", "bind",
+			error(BSDDIALOG_ERROR, "%s: %s: %s",
+					(res != 0) ? "bind" : "chmod",
 					addr.sun_path, strerror(errno));
 			close(gbd->socket);
 			unlink(addr.sun_path);
@@ -1048,14 +1174,15 @@ static void _gbsddialog_clear_screen(GBSDDialog * gbd)
 			unlink(addr.sun_path);
 			return;
 		}
-		channel = g_io_channel_unix_new(gbd->socket);
-		g_io_channel_set_encoding(channel, NULL, NULL);
-		gbd->id = g_io_add_watch(channel, G_IO_IN,
-				_clear_screen_on_accept, gbd);
+		/* a client may go away while its output is written */
+		signal(SIGPIPE, SIG_IGN);
+		_clear_screen_listen(gbd);
 	}
 	gtk_main();
 	if(gbd->id > 0)
 		g_source_remove(gbd->id);
+	if(gbd->client >= 0)
+		_clear_screen_close(gbd);
 	if(gbd->socket >= 0)
 	{
 		close(gbd->socket);
@@ -1063,13 +1190,95 @@ static void _gbsddialog_clear_screen(GBSDDialog * gbd)
 	}
 }
 
+static void _clear_screen_close(GBSDDialog * gbd)
+{
+	size_t i;
+
+	if(gbd->client_id > 0)
+		g_source_remove(gbd->client_id);
+	gbd->client_id = 0;
+	if(gbd->client_timeout > 0)
+		g_source_remove(gbd->client_timeout);
+	gbd->client_timeout = 0;
+	for(i = 0; i < gbd->fds_cnt; i++)
+		close(gbd->fds[i]);
+	gbd->fds_cnt = 0;
+	free(gbd->data);
+	gbd->data = NULL;
+	gbd->data_cnt = 0;
+	gbd->buf_cnt = 0;
+	close(gbd->client);
+	gbd->client = -1;
+}
+
+static int _clear_screen_environ(char const * entry)
+{
+	char const * forward[] = { GBSDDIALOG_PROTOCOL_ENV };
+	size_t i;
+
+	for(i = 0; i < sizeof(forward) / sizeof(*forward); i++)
+		if(strncmp(entry, forward[i], strlen(forward[i])) == 0)
+			return 1;
+	return 0;
+}
+
+static void _clear_screen_environ_put(char const * const * envp)
+{
+	size_t i;
+	char const * p;
+	gchar * name;
+
+	for(i = 0; envp[i] != NULL; i++)
+	{
+		if(!_clear_screen_environ(envp[i])
+				|| (p = strchr(envp[i], '=')) == NULL)
+			continue;
+		name = g_strndup(envp[i], p - envp[i]);
+		setenv(name, p + 1, 1);
+		g_free(name);
+	}
+}
+
+static char ** _clear_screen_environ_take(void)
+{
+	char ** ret;
+	size_t i, j;
+	gchar * name;
+
+	/* remove the variables forwarded, returning their former values */
+	for(i = 0, j = 0; environ[i] != NULL; i++)
+		if(_clear_screen_environ(environ[i]))
+			j++;
+	ret = g_new0(char *, j + 1);
+	for(i = 0, j = 0; environ[i] != NULL; i++)
+		if(_clear_screen_environ(environ[i]))
+			ret[j++] = g_strdup(environ[i]);
+	for(i = 0; ret[i] != NULL; i++)
+	{
+		name = g_strndup(ret[i], strcspn(ret[i], "="));
+		unsetenv(name);
+		g_free(name);
+	}
+	return ret;
+}
+
+static int _clear_screen_listen(GBSDDialog * gbd)
+{
+	GIOChannel * channel;
+
+	channel = g_io_channel_unix_new(gbd->socket);
+	g_io_channel_set_encoding(channel, NULL, NULL);
+	gbd->id = g_io_add_watch(channel, G_IO_IN, _clear_screen_on_accept,
+			gbd);
+	g_io_channel_unref(channel);
+	return 0;
+}
+
 static gboolean _clear_screen_on_accept(GIOChannel * channel,
 		GIOCondition condition, gpointer data)
 {
 	GBSDDialog * gbd = data;
-	int fd;
-	char buf[257];
-	ssize_t len;
+	int fd, flags;
 	(void) channel;
 
 # ifdef DEBUG
@@ -1078,6 +1287,7 @@ static gboolean _clear_screen_on_accept(GIOChannel * channel,
 	if(condition != G_IO_IN)
 	{
 		error(BSDDIALOG_ERROR, "%s", "Unexpected condition");
+		gbd->id = 0;
 		return FALSE;
 	}
 	if((fd = accept(gbd->socket, NULL, NULL)) < 0)
@@ -1085,15 +1295,331 @@ static gboolean _clear_screen_on_accept(GIOChannel * channel,
 		error(BSDDIALOG_ERROR, "%s: %s", "accept", strerror(errno));
 		return TRUE;
 	}
-	len = recv(fd, buf, sizeof(buf) - 1, 0);
-	close(fd);
-	if(len > 0 && (size_t)len < sizeof(buf) && gbd->label != NULL)
+	if(_clear_screen_peer(fd) != 0)
+	{
+		close(fd);
+		return TRUE;
+	}
+	if((flags = fcntl(fd, F_GETFL)) < 0
+			|| fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0)
+	{
+		error(BSDDIALOG_ERROR, "%s: %s", "fcntl", strerror(errno));
+		close(fd);
+		return TRUE;
+	}
+	/* serve one client at a time, without blocking on its input */
+	gbd->client = fd;
+	channel = g_io_channel_unix_new(fd);
+	g_io_channel_set_encoding(channel, NULL, NULL);
+	gbd->client_id = g_io_add_watch(channel,
+			G_IO_IN | G_IO_HUP | G_IO_ERR,
+			_clear_screen_on_client, gbd);
+	g_io_channel_unref(channel);
+	gbd->client_timeout = g_timeout_add_seconds(GBSDDIALOG_PROTOCOL_TIMEOUT,
+			_clear_screen_on_timeout, gbd);
+	gbd->id = 0;
+	return FALSE;
+}
+
+static gboolean _clear_screen_on_client(GIOChannel * channel,
+		GIOCondition condition, gpointer data)
+{
+	GBSDDialog * gbd = data;
+	int res, flags;
+	int32_t ret;
+	(void) channel;
+	(void) condition;
+
+	if((res = (gbd->data == NULL) ? _clear_screen_receive(gbd)
+				: _clear_screen_receive_body(gbd)) > 0)
+		return TRUE;
+	gbd->client_id = 0;
+	if(gbd->buf_cnt >= sizeof(gbd->request) && memcmp(gbd->buf,
+				GBSDDIALOG_PROTOCOL_MAGIC,
+				GBSDDIALOG_PROTOCOL_MAGIC_SIZE) == 0)
+	{
+		/* run the dialog requested */
+		g_source_remove(gbd->client_timeout);
+		gbd->client_timeout = 0;
+		if((flags = fcntl(gbd->client, F_GETFL)) >= 0)
+			fcntl(gbd->client, F_SETFL, flags & ~O_NONBLOCK);
+		ret = (res == 0) ? _clear_screen_request(gbd)
+			: EXITCODE(BSDDIALOG_ERROR);
+		/* report the exit code */
+		if(send(gbd->client, &ret, sizeof(ret), 0) != sizeof(ret))
+			error(BSDDIALOG_ERROR, "%s: %s", "send",
+					strerror(errno));
+	}
+	else if(res == 0 && gbd->buf_cnt > 0 && gbd->label != NULL)
 	{
 		/* update the backtitle */
-		buf[len] = '\0';
-		gtk_label_set_text(GTK_LABEL(gbd->label), buf);
+		gbd->buf[gbd->buf_cnt] = '\0';
+		gtk_label_set_text(GTK_LABEL(gbd->label), gbd->buf);
 	}
-	return TRUE;
+	_clear_screen_close(gbd);
+	_clear_screen_listen(gbd);
+	return FALSE;
+}
+
+static gboolean _clear_screen_on_timeout(gpointer data)
+{
+	GBSDDialog * gbd = data;
+
+	error(BSDDIALOG_ERROR, "%s", "Timeout while receiving a request");
+	gbd->client_timeout = 0;
+	_clear_screen_close(gbd);
+	_clear_screen_listen(gbd);
+	return FALSE;
+}
+
+static int _clear_screen_peer(int fd)
+{
+	uid_t uid;
+	gid_t gid;
+
+	/* reject connections from other users */
+	if(getpeereid(fd, &uid, &gid) != 0)
+		return -error(BSDDIALOG_ERROR, "%s: %s", "getpeereid",
+				strerror(errno));
+	if(uid != geteuid())
+		return -error(BSDDIALOG_ERROR, "%s: %lu", "Permission denied",
+				(unsigned long)uid);
+	return 0;
+}
+
+static int _clear_screen_receive(GBSDDialog * gbd)
+{
+	struct gbsddialog_request * request = &gbd->request;
+	ssize_t len;
+	struct msghdr msg;
+	struct iovec iov;
+	union
+	{
+		struct cmsghdr cmsg;
+		char buf[CMSG_SPACE(sizeof(int) * GBSDDIALOG_PROTOCOL_FDS)];
+	} control;
+	struct cmsghdr * cmsg;
+	int f;
+	size_t i;
+
+	/* receive the next chunk, along with any descriptor */
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = &gbd->buf[gbd->buf_cnt];
+	iov.iov_len = sizeof(gbd->buf) - 1 - gbd->buf_cnt;
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+	if((len = recvmsg(gbd->client, &msg, 0)) < 0)
+	{
+		if(errno == EAGAIN || errno == EINTR)
+			return 1;
+		return -error(BSDDIALOG_ERROR, "%s: %s", "recvmsg",
+				strerror(errno));
+	}
+	for(cmsg = (len > 0) ? CMSG_FIRSTHDR(&msg) : NULL; cmsg != NULL;
+			cmsg = CMSG_NXTHDR(&msg, cmsg))
+		if(cmsg->cmsg_level == SOL_SOCKET
+				&& cmsg->cmsg_type == SCM_RIGHTS)
+			for(i = 0; i < (cmsg->cmsg_len - CMSG_LEN(0))
+					/ sizeof(int); i++)
+			{
+				if(gbd->fds_cnt < GBSDDIALOG_PROTOCOL_FDS)
+					memcpy(&gbd->fds[gbd->fds_cnt++],
+							CMSG_DATA(cmsg)
+							+ sizeof(int) * i,
+							sizeof(int));
+				else
+				{
+					memcpy(&f, CMSG_DATA(cmsg)
+							+ sizeof(int) * i,
+							sizeof(int));
+					close(f);
+				}
+			}
+	gbd->buf_cnt += len;
+	if(gbd->buf_cnt < sizeof(*request) || memcmp(gbd->buf,
+				GBSDDIALOG_PROTOCOL_MAGIC,
+				GBSDDIALOG_PROTOCOL_MAGIC_SIZE) != 0)
+	{
+		/* a backtitle update ends with the connection */
+		if(len == 0 && gbd->buf_cnt >= GBSDDIALOG_PROTOCOL_MAGIC_SIZE
+				&& memcmp(gbd->buf, GBSDDIALOG_PROTOCOL_MAGIC,
+					GBSDDIALOG_PROTOCOL_MAGIC_SIZE) == 0)
+			return -error(BSDDIALOG_ERROR, "%s",
+					"Invalid request");
+		return (len == 0 || gbd->buf_cnt == sizeof(gbd->buf) - 1)
+			? 0 : 1;
+	}
+	/* obtain the rest of the arguments asynchronously */
+	memcpy(request, gbd->buf, sizeof(*request));
+	len = gbd->buf_cnt - sizeof(*request);
+	if(request->argc == 0 || request->size == 0
+			|| request->size > GBSDDIALOG_PROTOCOL_SIZE_MAX
+			|| (size_t)request->argc + request->envc
+			> request->size
+			|| (size_t)len > request->size
+			|| gbd->fds_cnt < GBSDDIALOG_PROTOCOL_FDS - 1)
+		return -error(BSDDIALOG_ERROR, "%s", "Invalid request");
+	if((gbd->data = malloc(request->size)) == NULL)
+		return -error(BSDDIALOG_ERROR, "%s", strerror(errno));
+	memcpy(gbd->data, &gbd->buf[sizeof(*request)], len);
+	gbd->data_cnt = len;
+	return (gbd->data_cnt < request->size) ? 1 : 0;
+}
+
+static int _clear_screen_receive_body(GBSDDialog * gbd)
+{
+	ssize_t s;
+
+	if((s = recv(gbd->client, &gbd->data[gbd->data_cnt],
+					gbd->request.size - gbd->data_cnt, 0))
+			< 0)
+	{
+		if(errno == EAGAIN || errno == EINTR)
+			return 1;
+		return -error(BSDDIALOG_ERROR, "%s: %s", "recv",
+				strerror(errno));
+	}
+	else if(s == 0)
+		return -error(BSDDIALOG_ERROR, "%s: %s", "recv",
+				"Unexpected end of file");
+	gbd->data_cnt += s;
+	return (gbd->data_cnt < gbd->request.size) ? 1 : 0;
+}
+
+static int32_t _clear_screen_request(GBSDDialog * gbd)
+{
+	struct gbsddialog_request * request = &gbd->request;
+	char * data = gbd->data;
+	int32_t ret;
+	char const ** argv;
+	size_t i, j, cnt = request->argc + request->envc;
+
+	if((argv = malloc(sizeof(*argv) * (cnt + 2))) == NULL)
+		return EXITCODE(error(BSDDIALOG_ERROR, "%s", strerror(errno)));
+	/* split the arguments, then the environment */
+	for(i = 0, j = 0; i < request->size && j < cnt; j++)
+	{
+		argv[(j < request->argc) ? j : j + 1] = &data[i];
+		i += strnlen(&data[i], request->size - i) + 1;
+	}
+	argv[request->argc] = NULL;
+	argv[cnt + 1] = NULL;
+	if(j == cnt && i == request->size
+			&& data[request->size - 1] == '\0')
+		ret = _clear_screen_request_run(gbd, request, argv,
+				&argv[request->argc + 1], gbd->fds,
+				gbd->fds_cnt);
+	else
+		ret = EXITCODE(error(BSDDIALOG_ERROR, "%s", "Invalid request"));
+	free(argv);
+	return ret;
+}
+
+static int _clear_screen_request_run(GBSDDialog * gbd,
+		struct gbsddialog_request * request, char const ** argv,
+		char const ** envp, int * fds, size_t fds_cnt)
+{
+	GBSDDialog remote;
+	int ret;
+	int saved[3] = { -1, -1, -1 };
+	int i, oi = optind;
+	int cwd;
+	char ** environment;
+	struct exitcode codes[EXITCODES_COUNT];
+	GtkSettings * settings;
+	gchar * theme = NULL;
+	gchar * t = NULL;
+
+	/* run from the working directory of the client */
+	if((cwd = open(".", O_RDONLY | O_DIRECTORY)) < 0)
+		return EXITCODE(error(BSDDIALOG_ERROR, "%s: %s", "open",
+					strerror(errno)));
+	if(fchdir(fds[GBSDDIALOG_PROTOCOL_FD_CWD]) != 0)
+	{
+		close(cwd);
+		return EXITCODE(error(BSDDIALOG_ERROR, "%s: %s", "fchdir",
+					strerror(errno)));
+	}
+	/* the environment, exit codes and theme only apply to this request */
+	memcpy(codes, exitcodes, sizeof(codes));
+	environment = _clear_screen_environ_take();
+	_clear_screen_environ_put(envp);
+	init_exitcodes();
+	ret = EXITCODE(BSDDIALOG_ERROR);
+	settings = gtk_settings_get_default();
+	g_object_get(settings, "gtk-theme-name", &theme, NULL);
+	/* redirect the standard descriptors to the client */
+	for(i = 0; i < 3; i++)
+		if((saved[i] = dup(i)) < 0 || dup2(fds[i], i) < 0)
+			break;
+	if(i == 3)
+	{
+		memset(&remote, 0, sizeof(remote));
+		remote.ret = &ret;
+		remote.argc = request->argc;
+		remote.argv = argv;
+		remote.screen = gbd->screen;
+		remote.socket = -1;
+		remote.client = -1;
+		remote.server = gbd;
+		remote.output_fd[0] = (fds_cnt == GBSDDIALOG_PROTOCOL_FDS)
+			? request->output_fd : -1;
+		remote.output_fd[1] = (fds_cnt == GBSDDIALOG_PROTOCOL_FDS)
+			? fds[GBSDDIALOG_PROTOCOL_FD_OUTPUT] : -1;
+		optind = 1;
+		while(_gbsddialog_dialog(&remote) == 0);
+		optind = oi;
+		/* the client exits once replied to */
+		if(output_wait() != BSDDIALOG_OK)
+			ret = EXITCODE(BSDDIALOG_ERROR);
+		_clear_screen_request_themes(&remote);
+	}
+	else
+		error(BSDDIALOG_ERROR, "%s: %s", "dup", strerror(errno));
+	/* restore the standard descriptors */
+	for(i = 0; i < 3 && saved[i] >= 0; i++)
+	{
+		dup2(saved[i], i);
+		close(saved[i]);
+	}
+	g_strfreev(_clear_screen_environ_take());
+	_clear_screen_environ_put((char const * const *)environment);
+	g_strfreev(environment);
+	memcpy(exitcodes, codes, sizeof(codes));
+	if(fchdir(cwd) != 0)
+		error(BSDDIALOG_ERROR, "%s: %s", "fchdir", strerror(errno));
+	close(cwd);
+	g_object_get(settings, "gtk-theme-name", &t, NULL);
+	if(g_strcmp0(t, theme) != 0)
+		g_object_set(settings, "gtk-theme-name", theme, NULL);
+	g_free(t);
+	g_free(theme);
+	return ret;
+}
+
+static void _clear_screen_request_themes(GBSDDialog * remote)
+{
+	GSList * l;
+
+	/* unload the themes of the request */
+	if(remote->themes == NULL)
+		return;
+#if GTK_CHECK_VERSION(3, 0, 0)
+	for(l = remote->themes; l != NULL; l = l->next)
+	{
+		gtk_style_context_remove_provider_for_screen(remote->screen,
+				GTK_STYLE_PROVIDER(l->data));
+		g_object_unref(l->data);
+	}
+#else
+	for(l = remote->themes; l != NULL; l = l->next)
+		g_free(l->data);
+	gtk_rc_reparse_all_for_settings(gtk_settings_get_default(), TRUE);
+#endif
+	g_slist_free(remote->themes);
+	remote->themes = NULL;
 }
 
 
@@ -1126,6 +1652,7 @@ static int _gbsddialog_parseargs(GBSDDialog * gbd, int argc, char const ** argv)
 	memset(opt, 0, sizeof(*opt));
 	opt->theme = -1;
 	opt->output_fd = STDERR_FILENO;
+	opt->item_expand = -1;
 	opt->max_input_form = 2048;
 	opt->mandatory_dialog = true;
 #ifdef WITH_XDIALOG
@@ -1311,6 +1838,9 @@ static int _parseargs_arg(GBSDDialog * gbd, struct bsddialog_conf * conf,
 			exitcodes[BSDDIALOG_ESC + 1].value
 				= strtol(optarg, NULL, 10);
 			break;
+		case EXEC_FILTER:
+			opt->exec_filter = optarg;
+			break;
 		case EXIT_LABEL:
 			conf->button.ok_label = optarg;
 			break;
@@ -1336,6 +1866,29 @@ static int _parseargs_arg(GBSDDialog * gbd, struct bsddialog_conf * conf,
 		case FIXED_FONT:
 			opt->fixed_font = true;
 			break;
+#endif
+		case GAUGE_COMPACT:
+			opt->gauge_compact = true;
+			break;
+		case GAUGE_EXEC:
+			opt->gauge_exec = optarg;
+			break;
+		case GAUGE_FILE:
+			opt->gauge_file = optarg;
+			break;
+		case GAUGE_PIPE:
+			opt->gauge_pipe = true;
+			break;
+		case GAUGE_PROCESS:
+			opt->gauge_process = optarg;
+			break;
+		case GAUGE_SHM:
+			opt->gauge_shm = optarg;
+			break;
+		case GAUGE_SIZE:
+			opt->gauge_size = strtoull(optarg, NULL, 10);
+			break;
+#ifdef WITH_XDIALOG
 		case HELP:
 			opt->help = optarg;
 			break;
@@ -1382,9 +1935,24 @@ static int _parseargs_arg(GBSDDialog * gbd, struct bsddialog_conf * conf,
 		case ITEM_DEPTH:
 			opt->item_depth = true;
 			break;
+		case ITEM_EXPAND:
+			opt->item_expand = strtol(optarg, NULL, 10);
+			break;
+		case ITEM_FILTER:
+			opt->item_filter = true;
+			break;
 		case ITEM_PREFIX:
 			opt->item_prefix = true;
 			break;
+		case ITEM_SORT:
+			opt->item_sort = true;
+			break;
+		case ITEMS_FROM:
+			opt->items_from = optarg;
+			break;
+		case LARGE_LIST:
+			opt->large_list = true;
+			break;
 #ifdef WITH_XDIALOG
 		case LEFT:
 # if GTK_CHECK_VERSION(3, 14, 0)
@@ -1401,6 +1969,9 @@ static int _parseargs_arg(GBSDDialog * gbd, struct bsddialog_conf * conf,
 		case MAX_INPUT:
 			opt->max_input_form = strtoul(optarg, NULL, 10);
 			break;
+		case MIXEDGAUGE_STDIN:
+			opt->mixedgauge_stdin = true;
+			break;
 #ifdef WITH_XDIALOG
 		case NO_BUTTONS:
 			/* XXX should be in struct bsddialog_conf */
@@ -1445,6 +2016,18 @@ static int _parseargs_arg(GBSDDialog * gbd, struct bsddialog_conf * conf,
 		case OUTPUT_FD:
 			opt->output_fd = strtol(optarg, NULL, 10);
 			break;
+		case OUTPUT_FORMAT:
+			if(strcmp(optarg, "text") == 0)
+				opt->output_format = OF_TEXT;
+			else if(strcmp(optarg, "json") == 0)
+				opt->output_format = OF_JSON;
+			else if(strcmp(optarg, "nul") == 0)
+				opt->output_format = OF_NUL;
+			else
+				return -error(BSDDIALOG_ERROR,
+						"--output-format %s is invalid",
+						optarg);
+			break;
 		case OUTPUT_SEPARATOR:
 			opt->item_output_sep = optarg;
 			break;
@@ -1463,7 +2046,7 @@ static int _parseargs_arg(GBSDDialog * gbd, struct bsddialog_conf * conf,
 			opt->mandatory_dialog = false;
 			get_workarea(gbd->screen, &workarea);
 			ex = get_font_size(gbd->screen);
-			dprintf(opt->output_fd, "MaxSize: %d, %d\n",
+			output_dprintf(opt->output_fd, "MaxSize: %d, %d\n",
 					(int)(workarea.height / ex / 2) - 9,
 					(int)(workarea.width / ex) - 4);
 			break;
@@ -1473,7 +2056,7 @@ static int _parseargs_arg(GBSDDialog * gbd, struct bsddialog_conf * conf,
 			break;
 		case PRINT_VERSION:
 			opt->mandatory_dialog = false;
-			dprintf(opt->output_fd,
+			output_dprintf(opt->output_fd,
 					"Version: %s (libbsddialog: %s)\n",
 					VERSION, LIBBSDDIALOG_VERSION);
 			break;
@@ -1540,6 +2123,9 @@ static int _parseargs_arg(GBSDDialog * gbd, struct bsddialog_conf * conf,
 		case TEXT_UNCHANGED:
 			opt->text_unchanged = true;
 			break;
+		case TEXTBOX_EXEC:
+			opt->textbox_exec = true;
+			break;
 		case THEME:
 			g_object_set(gtk_settings_get_default(),
 					"gtk-theme-name", optarg, NULL);
@@ -1900,6 +2486,32 @@ static int _parseargs_arg(GBSDDialog * gbd, struct bsddialog_conf * conf,
 }
 
 
+/* gbsddialog_result */
+static void _gbsddialog_result(GBSDDialog * gbd, int res)
+{
+	struct bsddialog_conf * conf = &gbd->conf;
+	struct options * opt = &gbd->opt;
+	char button[32];
+	char const * p = "";
+	size_t i;
+
+	if(res + 1 >= 0 && res + 1 < EXITCODES_COUNT)
+	{
+		p = exitcodes[res + 1].name;
+		if(strncmp(p, "BSDDIALOG_", 10) == 0)
+			p += 10;
+	}
+	for(i = 0; p[i] != '\0' && i < sizeof(button) - 1; i++)
+		button[i] = tolower((unsigned char)p[i]);
+	button[i] = '\0';
+	output_record(opt->result, opt->output_format, EXITCODE(res), button,
+			(conf->get_height != NULL) ? *conf->get_height : -1,
+			(conf->get_width != NULL) ? *conf->get_width : -1);
+	output_delete(opt->result);
+	opt->result = NULL;
+}
+
+
 /* gbsddialog_theme_load */
 static gboolean _gbsddialog_theme_load(GBSDDialog * gbd, char const * theme)
 {
@@ -1917,11 +2529,15 @@ static gboolean _gbsddialog_theme_load(GBSDDialog * gbd, char const * theme)
 	gtk_style_context_add_provider_for_screen(gbd->screen,
 			GTK_STYLE_PROVIDER(css),
 			GTK_STYLE_PROVIDER_PRIORITY_USER);
+	/* unloaded at the end of remote requests */
+	if(gbd->server != NULL)
+		gbd->themes = g_slist_prepend(gbd->themes, css);
 	return TRUE;
 #else
-	(void) gbd;
-
 	gtk_rc_parse(theme);
+	/* reverted at the end of remote requests */
+	if(gbd->server != NULL)
+		gbd->themes = g_slist_prepend(gbd->themes, g_strdup(theme));
 	return TRUE;
 #endif
 }
@@ -0,0 +1,443 @@
+/* gbsddialog */
+/* library.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <gtk/gtk.h>
+#include "builders.h"
+#include "common.h"
+
+
+/* private */
+/* variables */
+static char _library_error[1024] = "";
+static GtkWidget * _library_backtitle = NULL;
+
+
+/* prototypes */
+static int _library_error_set(char const * format, ...);
+static void _library_options(struct options * opt, char const * name);
+static void _library_options_menu(struct options * opt, unsigned int nitems,
+		struct bsddialog_menuitem const * items);
+
+
+/* public */
+/* functions */
+/* bsddialog_init */
+int bsddialog_init(void)
+{
+	if(gtk_init_check(NULL, NULL) != TRUE)
+		return _library_error_set("%s", "Could not initialize Gtk+");
+	init_entropy();
+	init_exitcodes();
+	return BSDDIALOG_OK;
+}
+
+
+/* bsddialog_init_notheme */
+int bsddialog_init_notheme(void)
+{
+	return bsddialog_init();
+}
+
+
+/* bsddialog_end */
+int bsddialog_end(void)
+{
+	if(_library_backtitle != NULL)
+		gtk_widget_destroy(_library_backtitle);
+	_library_backtitle = NULL;
+	return BSDDIALOG_OK;
+}
+
+
+/* bsddialog_backtitle */
+int bsddialog_backtitle(struct bsddialog_conf * conf, const char * backtitle)
+{
+	GtkWidget * widget;
+	(void) conf;
+
+	if(_library_backtitle == NULL)
+	{
+		/* covers the screen behind the dialogs */
+		_library_backtitle = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+		gtk_window_set_decorated(GTK_WINDOW(_library_backtitle), FALSE);
+		gtk_window_fullscreen(GTK_WINDOW(_library_backtitle));
+		g_signal_connect(_library_backtitle, "delete-event",
+				G_CALLBACK(gtk_true), NULL);
+		widget = gtk_label_new(NULL);
+#if GTK_CHECK_VERSION(3, 14, 0)
+		gtk_widget_set_halign(widget, GTK_ALIGN_START);
+		gtk_widget_set_valign(widget, GTK_ALIGN_START);
+#else
+		gtk_misc_set_alignment(GTK_MISC(widget), 0.0, 0.0);
+#endif
+		gtk_container_add(GTK_CONTAINER(_library_backtitle), widget);
+		gtk_container_set_border_width(
+				GTK_CONTAINER(_library_backtitle), 16);
+	}
+	else
+		widget = gtk_bin_get_child(GTK_BIN(_library_backtitle));
+	gtk_label_set_text(GTK_LABEL(widget),
+			(backtitle != NULL) ? backtitle : "");
+	gtk_widget_show_all(_library_backtitle);
+	while(gtk_events_pending())
+		gtk_main_iteration();
+	return BSDDIALOG_OK;
+}
+
+
+/* bsddialog_initconf */
+int bsddialog_initconf(struct bsddialog_conf * conf)
+{
+	if(conf == NULL)
+		return _library_error_set("%s", "conf is NULL");
+	memset(conf, 0, sizeof(*conf));
+	conf->y = BSDDIALOG_AUTOSIZE;
+	conf->x = BSDDIALOG_AUTOSIZE;
+	conf->shadow = true;
+	conf->text.cols_per_row = DEFAULT_COLS_PER_ROW;
+	conf->key.enable_esc = true;
+	conf->button.always_active = true;
+	return BSDDIALOG_OK;
+}
+
+
+/* bsddialog_clearterminal */
+int bsddialog_clearterminal(void)
+{
+	return BSDDIALOG_OK;
+}
+
+
+/* bsddialog_geterror */
+const char * bsddialog_geterror(void)
+{
+	return _library_error;
+}
+
+
+/* dialogs */
+/* bsddialog_calendar */
+int bsddialog_calendar(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols, unsigned int * yy, unsigned int * mm,
+		unsigned int * dd)
+{
+	struct options opt;
+
+	if(yy == NULL || mm == NULL || dd == NULL)
+		return _library_error_set("%s", "yy / mm / dd cannot be NULL");
+	_library_options(&opt, "--calendar");
+	return builder_calendar_values(conf, text, rows, cols, yy, mm, dd,
+			&opt);
+}
+
+
+/* bsddialog_checklist */
+int bsddialog_checklist(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols, unsigned int menurows, unsigned int nitems,
+		struct bsddialog_menuitem * items, int * focusitem)
+{
+	struct options opt;
+	(void) menurows;
+
+	if(nitems > 0 && items == NULL)
+		return _library_error_set("%s", "items is NULL");
+	_library_options(&opt, "--checklist");
+	_library_options_menu(&opt, nitems, items);
+	return builder_checklist_items(conf, text, rows, cols, nitems, items,
+			focusitem, &opt);
+}
+
+
+/* bsddialog_datebox */
+int bsddialog_datebox(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols, unsigned int * yy, unsigned int * mm,
+		unsigned int * dd)
+{
+	struct options opt;
+
+	if(yy == NULL || mm == NULL || dd == NULL)
+		return _library_error_set("%s", "yy / mm / dd cannot be NULL");
+	_library_options(&opt, "--datebox");
+	return builder_datebox_values(conf, text, rows, cols, yy, mm, dd,
+			&opt);
+}
+
+
+/* bsddialog_form */
+int bsddialog_form(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols, unsigned int formheight, unsigned int nitems,
+		struct bsddialog_formitem * items)
+{
+	struct options opt;
+	unsigned int i;
+	(void) formheight;
+
+	if(nitems > 0 && items == NULL)
+		return _library_error_set("%s", "items is NULL");
+	_library_options(&opt, "--form");
+	for(i = 0; i < nitems; i++)
+		if(items[i].bottomdesc != NULL)
+			opt.item_bottomdesc = true;
+	return builder_form_items(conf, text, rows, cols, nitems, items,
+			&opt);
+}
+
+
+/* bsddialog_gauge */
+int bsddialog_gauge(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols, unsigned int perc, int fd, const char * sep)
+{
+	struct options opt;
+
+	if(fd < 0)
+		return _library_error_set("%s", "Invalid file descriptor");
+	_library_options(&opt, "--gauge");
+	return builder_gauge_fd(conf, text, rows, cols, perc, fd, sep, &opt);
+}
+
+
+/* bsddialog_infobox */
+int bsddialog_infobox(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols)
+{
+	struct options opt;
+
+	_library_options(&opt, "--infobox");
+	return builder_infobox(conf, text, rows, cols, 0, NULL, &opt);
+}
+
+
+/* bsddialog_menu */
+int bsddialog_menu(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols, unsigned int menurows, unsigned int nitems,
+		struct bsddialog_menuitem * items, int * focusitem)
+{
+	struct options opt;
+	(void) menurows;
+
+	if(nitems > 0 && items == NULL)
+		return _library_error_set("%s", "items is NULL");
+	_library_options(&opt, "--menu");
+	_library_options_menu(&opt, nitems, items);
+	return builder_menu_items(conf, text, rows, cols, nitems, items,
+			focusitem, &opt);
+}
+
+
+/* bsddialog_mixedgauge */
+int bsddialog_mixedgauge(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols, unsigned int mainperc,
+		unsigned int nminibars, const char ** minilabels,
+		int * minipercs)
+{
+	struct options opt;
+
+	if(nminibars > 0 && (minilabels == NULL || minipercs == NULL))
+		return _library_error_set("%s",
+				"minilabels / minipercs is NULL");
+	_library_options(&opt, "--mixedgauge");
+	return builder_mixedgauge_bars(conf, text, rows, cols, mainperc,
+			nminibars, minilabels, minipercs, &opt);
+}
+
+
+/* bsddialog_mixedlist */
+int bsddialog_mixedlist(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols, unsigned int menurows, unsigned int ngroups,
+		struct bsddialog_menugroup * groups, int * focuslist,
+		int * focusitem)
+{
+	struct options opt;
+	unsigned int i;
+	(void) menurows;
+
+	if(ngroups > 0 && groups == NULL)
+		return _library_error_set("%s", "groups is NULL");
+	for(i = 0; i < ngroups; i++)
+		if(groups[i].nitems > 0 && groups[i].items == NULL)
+			return _library_error_set("%s", "items is NULL");
+	_library_options(&opt, "--mixedlist");
+	for(i = 0; i < ngroups; i++)
+		_library_options_menu(&opt, groups[i].nitems, groups[i].items);
+	return builder_mixedlist_groups(conf, text, rows, cols, ngroups,
+			groups, focuslist, focusitem, &opt);
+}
+
+
+/* bsddialog_msgbox */
+int bsddialog_msgbox(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols)
+{
+	struct options opt;
+
+	_library_options(&opt, "--msgbox");
+	return builder_msgbox(conf, text, rows, cols, 0, NULL, &opt);
+}
+
+
+/* bsddialog_pause */
+int bsddialog_pause(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols, unsigned int seconds)
+{
+	struct options opt;
+
+	_library_options(&opt, "--pause");
+	return builder_pause_seconds(conf, text, rows, cols, seconds, &opt);
+}
+
+
+/* bsddialog_radiolist */
+int bsddialog_radiolist(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols, unsigned int menurows, unsigned int nitems,
+		struct bsddialog_menuitem * items, int * focusitem)
+{
+	struct options opt;
+	(void) menurows;
+
+	if(nitems > 0 && items == NULL)
+		return _library_error_set("%s", "items is NULL");
+	_library_options(&opt, "--radiolist");
+	_library_options_menu(&opt, nitems, items);
+	return builder_radiolist_items(conf, text, rows, cols, nitems, items,
+			focusitem, &opt);
+}
+
+
+/* bsddialog_rangebox */
+int bsddialog_rangebox(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols, int min, int max, int * value)
+{
+	struct options opt;
+
+	if(value == NULL)
+		return _library_error_set("%s", "value is NULL");
+	if(min >= max)
+		return _library_error_set("%s", "min >= max");
+	_library_options(&opt, "--rangebox");
+	if(*value < min)
+		*value = min;
+	else if(*value > max)
+		*value = max;
+	return builder_rangebox_values(conf, text, rows, cols, min, max,
+			value, &opt);
+}
+
+
+/* bsddialog_textbox */
+int bsddialog_textbox(struct bsddialog_conf * conf, const char * file,
+		int rows, int cols)
+{
+	struct options opt;
+
+	if(file == NULL)
+		return _library_error_set("%s", "file is NULL");
+	_library_options(&opt, "--textbox");
+	return builder_textbox(conf, file, rows, cols, 0, NULL, &opt);
+}
+
+
+/* bsddialog_timebox */
+int bsddialog_timebox(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols, unsigned int * hh, unsigned int * mm,
+		unsigned int * ss)
+{
+	struct options opt;
+
+	if(hh == NULL || mm == NULL || ss == NULL)
+		return _library_error_set("%s", "hh / mm / ss cannot be NULL");
+	_library_options(&opt, "--timebox");
+	return builder_timebox_values(conf, text, rows, cols, hh, mm, ss,
+			&opt);
+}
+
+
+/* bsddialog_yesno */
+int bsddialog_yesno(struct bsddialog_conf * conf, const char * text,
+		int rows, int cols)
+{
+	struct options opt;
+
+	_library_options(&opt, "--yesno");
+	return builder_yesno(conf, text, rows, cols, 0, NULL, &opt);
+}
+
+
+/* private */
+/* functions */
+/* library_error_set */
+static int _library_error_set(char const * format, ...)
+{
+	va_list ap;
+
+	va_start(ap, format);
+	vsnprintf(_library_error, sizeof(_library_error), format, ap);
+	va_end(ap);
+	return BSDDIALOG_ERROR;
+}
+
+
+/* library_options */
+static void _library_options(struct options * opt, char const * name)
+{
+	memset(opt, 0, sizeof(*opt));
+	opt->theme = -1;
+	opt->output_fd = STDERR_FILENO;
+	opt->item_expand = -1;
+	opt->max_input_form = 2048;
+	opt->mandatory_dialog = true;
+#if GTK_CHECK_VERSION(3, 14, 0)
+	opt->halign = GTK_ALIGN_START;
+#endif
+	opt->position = GTK_WIN_POS_CENTER;
+	opt->name = name;
+	_library_error[0] = '\0';
+}
+
+
+/* library_options_menu */
+static void _library_options_menu(struct options * opt, unsigned int nitems,
+		struct bsddialog_menuitem const * items)
+{
+	unsigned int i;
+
+	for(i = 0; i < nitems; i++)
+	{
+		if(items[i].prefix != NULL)
+			opt->item_prefix = true;
+		if(items[i].bottomdesc != NULL)
+			opt->item_bottomdesc = true;
+	}
+}
@@ -0,0 +1,91 @@
+/* gbsddialog */
+/* liststore.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+#include "liststore.h"
+
+
+/* ListStore */
+/* public */
+/* functions */
+/* useful */
+/* liststore_move */
+void liststore_move(GtkListStore * from, GtkListStore * to, GList * rows,
+		GtkTreeView * fromview, GtkTreeView * toview)
+{
+	GtkTreeModel * model = GTK_TREE_MODEL(from);
+	gboolean all = (rows == NULL);
+	gint count;
+	gint * columns;
+	GValue * values;
+	GtkTreeIter iter, iter2;
+	gboolean valid;
+	gint i, j;
+
+	/* every column is moved */
+	count = gtk_tree_model_get_n_columns(model);
+	columns = g_new(gint, count);
+	values = g_new0(GValue, count);
+	for(j = 0; j < count; j++)
+		columns[j] = j;
+	g_object_ref(from);
+	g_object_ref(to);
+	if(fromview != NULL)
+		gtk_tree_view_set_model(fromview, NULL);
+	if(toview != NULL)
+		gtk_tree_view_set_model(toview, NULL);
+	for(i = 0, valid = gtk_tree_model_get_iter_first(model, &iter);
+			valid == TRUE && (all || rows != NULL); i++)
+	{
+		if(all == FALSE
+				&& gtk_tree_path_get_indices(rows->data)[0] != i)
+		{
+			valid = gtk_tree_model_iter_next(model, &iter);
+			continue;
+		}
+		for(j = 0; j < count; j++)
+			gtk_tree_model_get_value(model, &iter, j, &values[j]);
+		valid = gtk_list_store_remove(from, &iter);
+		gtk_list_store_insert_with_valuesv(to, &iter2, -1, columns,
+				values, count);
+		for(j = 0; j < count; j++)
+			g_value_unset(&values[j]);
+		if(all == FALSE)
+			rows = rows->next;
+	}
+	if(fromview != NULL)
+		gtk_tree_view_set_model(fromview, model);
+	if(toview != NULL)
+		gtk_tree_view_set_model(toview, GTK_TREE_MODEL(to));
+	g_object_unref(from);
+	g_object_unref(to);
+	g_free(values);
+	g_free(columns);
+}
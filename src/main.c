@@ -39,6 +39,7 @@
 #include <gtk/gtk.h>
 #include "common.h"
 #include "gbsddialog.h"
+#include "output.h"
 
 #ifndef PROGNAME_BSDDIALOG
 # define PROGNAME_BSDDIALOG	"bsddialog"
@@ -107,6 +108,8 @@ int main(int argc, char * argv[])
 		return r;
 
 	gtk_main();
+	if(output_wait() != BSDDIALOG_OK)
+		ret = EXITCODE(BSDDIALOG_ERROR);
 
 	return ret;
 }
@@ -134,9 +137,12 @@ static int _usage(void)
             " --cr-wrap,\n --datebox-format d/m/y|m/d/y|y/m/d,"
             " --date-format <format>,\n --default-button <label>,"
             " --default-item <name>, --default-no, --disable-esc,\n"
-            " --error-exit-code <retval>, --esc-exit-code <retval>,"
-            " --exit-label <label>,\n --extra-button,"
-            " --extra-exit-code <retval>, --extra-label <label>,\n"
+            " --error-exit-code <retval>, --esc-exit-code <retval>,\n"
+            " --exec-filter <regex>, --exit-label <label>, --extra-button,\n"
+            " --extra-exit-code <retval>, --extra-label <label>,"
+            " --gauge-compact,\n --gauge-exec <command>, --gauge-file <file>,"
+            " --gauge-pipe,\n --gauge-process <pid>:<fd>, --gauge-shm <file>,"
+            " --gauge-size <bytes>,\n"
             " --left1-button <label>, --left1-exit-code <retval>,"
             " --left2-button <label>,\n --left2-exit-code <retval>,"
             " --left3-button <label>, --left3-exit-code <retval>,\n"
@@ -146,21 +152,25 @@ static int _usage(void)
             " --help-button, --help-exit-code <retval>, --help-label <label>,\n"
             " --help-print-items, --help-print-name, --hfile <file>,"
             " --hline <string>,\n --hmsg <string>, --ignore, --insecure,"
-            " --item-bottom-desc, --item-depth,\n --item-prefix,"
-            " --load-theme <file>, --max-input <size>, --no-cancel,\n"
-            " --no-descriptions, --no-label <label>, --no-lines, --no-names,"
-            " --no-ok,\n --no-shadow, --normal-screen, --ok-exit-code <retval>,"
-            " --ok-label <label>,\n --output-fd <fd>, --output-separator <sep>,"
-            " --print-maxsize, --print-size,\n --print-version, --quoted,"
-            " --right1-button <label>,\n --right1-exit-code <retval>,"
-            " --right2-button <label>,\n --right2-exit-code <retval>,"
+            " --item-bottom-desc, --item-depth,\n --item-expand <depth>,"
+            " --item-filter, --item-prefix, --item-sort,\n"
+            " --items-from <file|fd>, --large-list, --load-theme <file>,\n"
+            " --max-input <size>, --mixedgauge-stdin, --no-cancel,\n"
+            " --no-descriptions, --no-label <label>, --no-lines, --no-names,\n"
+            " --no-ok, --no-shadow, --normal-screen, --ok-exit-code <retval>,\n"
+            " --ok-label <label>, --output-fd <fd>, --output-format <format>,\n"
+            " --output-separator <sep>, --print-maxsize, --print-size,\n"
+            " --print-version, --quoted, --right1-button <label>,\n"
+            " --right1-exit-code <retval>, --right2-button <label>,\n"
+            " --right2-exit-code <retval>,"
             " --right3-button <label>,\n --right3-exit-code <retval>,"
             " --save-theme <file>, --separate-output,\n --separator <sep>,"
             " --shadow, --single-quoted, --sleep <secs>, --stderr,\n --stdout,"
             " --switch-buttons, --tab-escape, --tab-len <spaces>,"
-            " --text-escape,\n --text-unchanged, --theme 3d|blackwhite|flat,"
-            " --timeout-exit-code <retval>,\n --time-format <format>,"
-            " --title <title>, --yes-label <label>.");
+            " --text-escape,\n --text-unchanged, --textbox-exec,"
+            " --theme 3d|blackwhite|flat,\n --timeout-exit-code <retval>,"
+            " --time-format <format>, --title <title>,\n"
+            " --yes-label <label>.");
         printf("\n\n");
 
         printf("Dialogs:\n");
@@ -0,0 +1,404 @@
+/* gbsddialog */
+/* menuindex.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "menuindex.h"
+
+
+/* MenuIndex */
+/* private */
+/* types */
+struct _MenuIndex
+{
+	struct bsddialog_menuitem const * items;
+	guint nitems;
+	gboolean sort;
+	MenuIndexCallback callback;
+	void * data;
+
+	GThread * thread;
+	gint cancel;
+
+	/* built by the thread */
+	char * text;			/* the names and descriptions folded */
+	guint * offsets;		/* for each item into text */
+	guint * order;			/* sorted by name if requested */
+	guint * buckets;		/* for each trigram into postings */
+	guint * postings;		/* the items containing each trigram */
+	guint * buckets2;		/* for each bigram into postings2 */
+	guint * postings2;		/* the items containing each bigram */
+
+	/* the last query */
+	char * query;
+	guint * rows;
+	guint nrows;
+	guint * tmp;
+	guint8 * marks;
+};
+
+
+/* constants */
+#define MENUINDEX_BUCKETS	32768
+#define MENUINDEX_BUCKETS2	65536
+
+
+/* prototypes */
+static char * _menuindex_casefold(char const * s);
+static guint _menuindex_hash(char const * s);
+static guint _menuindex_hash2(char const * s);
+static gboolean _menuindex_on_ready(gpointer data);
+static gpointer _menuindex_thread(gpointer data);
+
+
+/* public */
+/* functions */
+/* menuindex_new */
+MenuIndex * menuindex_new(struct bsddialog_menuitem const * items,
+		unsigned int nitems, gboolean sort,
+		MenuIndexCallback callback, void * data)
+{
+	MenuIndex * index;
+
+	if((index = malloc(sizeof(*index))) == NULL)
+		return NULL;
+	index->items = items;
+	index->nitems = nitems;
+	index->sort = sort;
+	index->callback = callback;
+	index->data = data;
+	index->cancel = 0;
+	index->text = NULL;
+	index->offsets = NULL;
+	index->order = NULL;
+	index->buckets = NULL;
+	index->postings = NULL;
+	index->buckets2 = NULL;
+	index->postings2 = NULL;
+	index->query = NULL;
+	index->rows = NULL;
+	index->nrows = 0;
+	index->tmp = NULL;
+	index->marks = NULL;
+	/* the items must not change until the index is deleted */
+#if GLIB_CHECK_VERSION(2, 32, 0)
+	index->thread = g_thread_new("menuindex", _menuindex_thread, index);
+#else
+	index->thread = g_thread_create(_menuindex_thread, index, TRUE, NULL);
+#endif
+	if(index->thread == NULL)
+	{
+		free(index);
+		return NULL;
+	}
+	return index;
+}
+
+
+/* menuindex_delete */
+void menuindex_delete(MenuIndex * index)
+{
+	g_atomic_int_set(&index->cancel, 1);
+	g_thread_join(index->thread);
+	/* the notification may still be pending */
+	g_source_remove_by_user_data(index);
+	g_free(index->text);
+	g_free(index->offsets);
+	g_free(index->order);
+	g_free(index->buckets);
+	g_free(index->postings);
+	g_free(index->buckets2);
+	g_free(index->postings2);
+	g_free(index->query);
+	g_free(index->rows);
+	g_free(index->tmp);
+	g_free(index->marks);
+	free(index);
+}
+
+
+/* useful */
+/* menuindex_filter */
+unsigned int menuindex_filter(MenuIndex * index, char const * query,
+		unsigned int const ** rows)
+{
+	char * q;
+	size_t len, i;
+	guint const * base;
+	guint const * buckets = index->buckets, * postings = index->postings;
+	guint nbase, n, k, j, h, best = 0, size = G_MAXUINT;
+	gboolean exact = FALSE;
+	guint * p;
+
+	q = _menuindex_casefold(query);
+	if((len = strlen(q)) == 0)
+	{
+		g_free(q);
+		g_free(index->query);
+		index->query = NULL;
+		*rows = index->order;
+		return index->nitems;
+	}
+	if(index->rows == NULL)
+	{
+		index->rows = g_new(guint, index->nitems);
+		index->tmp = g_new(guint, index->nitems);
+		index->marks = g_new0(guint8, index->nitems);
+	}
+	if(index->query != NULL && strstr(q, index->query) != NULL)
+	{
+		/* the previous results are narrowed down */
+		base = index->rows;
+		nbase = index->nrows;
+	}
+	else
+	{
+		base = index->order;
+		nbase = index->nitems;
+	}
+	if(len == 2)
+	{
+		/* the items with this bigram match exactly */
+		buckets = index->buckets2;
+		postings = index->postings2;
+		best = _menuindex_hash2(q);
+		size = buckets[best + 1] - buckets[best];
+		exact = TRUE;
+	}
+	/* only the items with the rarest trigram may match */
+	for(i = 0; len >= 3 && i <= len - 3; i++)
+	{
+		h = _menuindex_hash(&q[i]);
+		if(buckets[h + 1] - buckets[h] < size)
+		{
+			best = h;
+			size = buckets[h + 1] - buckets[h];
+		}
+	}
+	if(size >= nbase && exact == FALSE)
+		size = G_MAXUINT;
+	if(size != G_MAXUINT)
+		for(j = buckets[best]; j < buckets[best + 1]; j++)
+			index->marks[postings[j]] = 1;
+	for(k = 0, n = 0; k < nbase; k++)
+	{
+		j = (base != NULL) ? base[k] : k;
+		if(size != G_MAXUINT && index->marks[j] == 0)
+			continue;
+		if(exact || (len == 1 && memchr(
+						&index->text[index->offsets[j]],
+						q[0], index->offsets[j + 1]
+						- index->offsets[j]) != NULL)
+				|| (len > 1 && g_strstr_len(
+						&index->text[index->offsets[j]],
+						index->offsets[j + 1]
+						- index->offsets[j], q)
+					!= NULL))
+			index->tmp[n++] = j;
+	}
+	if(size != G_MAXUINT)
+		for(j = buckets[best]; j < buckets[best + 1]; j++)
+			index->marks[postings[j]] = 0;
+	p = index->rows;
+	index->rows = index->tmp;
+	index->tmp = p;
+	index->nrows = n;
+	g_free(index->query);
+	index->query = q;
+	*rows = index->rows;
+	return n;
+}
+
+
+/* private */
+/* functions */
+/* menuindex_casefold */
+static char * _menuindex_casefold(char const * s)
+{
+	char * ret;
+	char const * end;
+	GString * valid;
+
+	if(g_utf8_validate(s, -1, NULL))
+		return g_utf8_casefold(s, -1);
+	/* every invalid byte is replaced, as with g_utf8_make_valid() */
+	valid = g_string_new(NULL);
+	for(; !g_utf8_validate(s, -1, &end); s = end + 1)
+	{
+		g_string_append_len(valid, s, end - s);
+		g_string_append(valid, "\xef\xbf\xbd");
+	}
+	g_string_append(valid, s);
+	ret = g_utf8_casefold(valid->str, valid->len);
+	g_string_free(valid, TRUE);
+	return ret;
+}
+
+
+/* menuindex_hash */
+static guint _menuindex_hash(char const * s)
+{
+	guchar const * u = (guchar const *)s;
+
+	return ((u[0] << 10) ^ (u[1] << 5) ^ u[2]) % MENUINDEX_BUCKETS;
+}
+
+
+/* menuindex_hash2 */
+static guint _menuindex_hash2(char const * s)
+{
+	guchar const * u = (guchar const *)s;
+
+	return (u[0] << 8) | u[1];
+}
+
+
+/* menuindex_on_ready */
+static gboolean _menuindex_on_ready(gpointer data)
+{
+	MenuIndex * index = data;
+
+	index->callback(index, index->data);
+	return FALSE;
+}
+
+
+/* menuindex_thread */
+static int _thread_compare(gconstpointer a, gconstpointer b, gpointer data);
+static void _thread_postings(MenuIndex * index, char const * text,
+		guint const * offsets, guint size, guint count,
+		guint (*hash)(char const *), guint ** buckets,
+		guint ** postings);
+
+static gpointer _menuindex_thread(gpointer data)
+{
+	MenuIndex * index = data;
+	GString * text;
+	guint * offsets;
+	guint * order = NULL;
+	guint i;
+	char * p;
+
+	text = g_string_new(NULL);
+	offsets = g_new(guint, index->nitems + 1);
+	for(i = 0; i < index->nitems; i++)
+	{
+		if(g_atomic_int_get(&index->cancel))
+			break;
+		offsets[i] = text->len;
+		if(index->items[i].name != NULL)
+		{
+			p = _menuindex_casefold(index->items[i].name);
+			g_string_append(text, p);
+			g_free(p);
+		}
+		/* the names are sorted up to this separator */
+		g_string_append_c(text, '\n');
+		if(index->items[i].desc != NULL)
+		{
+			p = _menuindex_casefold(index->items[i].desc);
+			g_string_append(text, p);
+			g_free(p);
+		}
+		g_string_append_c(text, '\n');
+	}
+	offsets[i] = text->len;
+	_thread_postings(index, text->str, offsets, 3, MENUINDEX_BUCKETS,
+			_menuindex_hash, &index->buckets, &index->postings);
+	_thread_postings(index, text->str, offsets, 2, MENUINDEX_BUCKETS2,
+			_menuindex_hash2, &index->buckets2, &index->postings2);
+	index->text = g_string_free(text, FALSE);
+	index->offsets = offsets;
+	if(index->sort && !g_atomic_int_get(&index->cancel))
+	{
+		order = g_new(guint, index->nitems);
+		for(i = 0; i < index->nitems; i++)
+			order[i] = i;
+		g_qsort_with_data(order, index->nitems, sizeof(*order),
+				_thread_compare, index);
+	}
+	index->order = order;
+	if(!g_atomic_int_get(&index->cancel))
+		g_idle_add(_menuindex_on_ready, index);
+	return NULL;
+}
+
+static int _thread_compare(gconstpointer a, gconstpointer b, gpointer data)
+{
+	MenuIndex * index = data;
+	guint i = *(guint const *)a, j = *(guint const *)b;
+	guchar const * p = (guchar const *)&index->text[index->offsets[i]];
+	guchar const * q = (guchar const *)&index->text[index->offsets[j]];
+
+	/* the names end with a newline, sorted first */
+	for(; *p == *q && *p != '\n'; p++, q++);
+	if(*p != *q)
+		return *p - *q;
+	return (i < j) ? -1 : ((i > j) ? 1 : 0);
+}
+
+static void _thread_postings(MenuIndex * index, char const * text,
+		guint const * offsets, guint size, guint count,
+		guint (*hash)(char const *), guint ** buckets,
+		guint ** postings)
+{
+	guint * b, * p, * last, * cursors;
+	guint i, j, h;
+
+	/* the n-grams are counted once for each item */
+	b = g_new0(guint, count + 1);
+	last = g_new0(guint, count);
+	for(i = 0; i < index->nitems && !g_atomic_int_get(&index->cancel); i++)
+		for(j = offsets[i]; j + size <= offsets[i + 1]; j++)
+			if(last[h = hash(&text[j])] != i + 1)
+			{
+				last[h] = i + 1;
+				b[h + 1]++;
+			}
+	for(h = 0; h < count; h++)
+		b[h + 1] += b[h];
+	p = g_new(guint, b[count] + 1);
+	cursors = g_new(guint, count);
+	memcpy(cursors, b, sizeof(*cursors) * count);
+	memset(last, 0, sizeof(*last) * count);
+	for(i = 0; i < index->nitems && !g_atomic_int_get(&index->cancel); i++)
+		for(j = offsets[i]; j + size <= offsets[i + 1]; j++)
+			if(last[h = hash(&text[j])] != i + 1)
+			{
+				last[h] = i + 1;
+				p[cursors[h]++] = i;
+			}
+	g_free(cursors);
+	g_free(last);
+	*buckets = b;
+	*postings = p;
+}
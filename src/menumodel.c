@@ -0,0 +1,915 @@
+/* gbsddialog */
+/* menumodel.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+#include <string.h>
+#include "menumodel.h"
+
+
+/* MenuModel */
+/* private */
+/* types */
+struct menumodel_node
+{
+	guint parent;
+	guint child;
+	guint next;
+	guint pos;		/* position amongst its siblings */
+};
+
+struct _MenuModel
+{
+	GObject parent;
+
+	gint stamp;
+	struct bsddialog_menuitem * items;
+	guint nitems;
+	guint size;			/* allocated if not 0 */
+	gboolean tree;
+	struct menumodel_node * nodes;
+	guint nroots;
+	guint * rows;			/* the rows shown if not a tree */
+	guint * positions;		/* of each item in rows */
+	guint gap;			/* in rows while updating them */
+	guint gapsize;
+	gboolean radiolist;
+	guint radio;			/* the item set if a radiolist */
+};
+
+struct _MenuModelClass
+{
+	GObjectClass parent;
+};
+
+
+/* constants */
+#define MENUMODEL_NONE	G_MAXUINT
+
+
+/* prototypes */
+static void _menumodel_finalize(GObject * object);
+
+/* GtkTreeModel */
+static void _menumodel_tree_model_init(GtkTreeModelIface * iface);
+
+static GtkTreeModelFlags _menumodel_get_flags(GtkTreeModel * model);
+static gint _menumodel_get_n_columns(GtkTreeModel * model);
+static GType _menumodel_get_column_type(GtkTreeModel * model, gint index);
+static gboolean _menumodel_get_iter(GtkTreeModel * model, GtkTreeIter * iter,
+		GtkTreePath * path);
+static GtkTreePath * _menumodel_get_path(GtkTreeModel * model,
+		GtkTreeIter * iter);
+static void _menumodel_get_value(GtkTreeModel * model, GtkTreeIter * iter,
+		gint column, GValue * value);
+static gboolean _menumodel_iter_next(GtkTreeModel * model, GtkTreeIter * iter);
+static gboolean _menumodel_iter_children(GtkTreeModel * model,
+		GtkTreeIter * iter, GtkTreeIter * parent);
+static gboolean _menumodel_iter_has_child(GtkTreeModel * model,
+		GtkTreeIter * iter);
+static gint _menumodel_iter_n_children(GtkTreeModel * model,
+		GtkTreeIter * iter);
+static gboolean _menumodel_iter_nth_child(GtkTreeModel * model,
+		GtkTreeIter * iter, GtkTreeIter * parent, gint n);
+static gboolean _menumodel_iter_parent(GtkTreeModel * model,
+		GtkTreeIter * iter, GtkTreeIter * child);
+
+/* useful */
+static void _menumodel_iter_set(MenuModel * model, GtkTreeIter * iter,
+		guint index);
+static guint _menumodel_iter_index(MenuModel * model, GtkTreeIter * iter);
+static guint _menumodel_iter_position(MenuModel * model, GtkTreeIter * iter);
+static guint _menumodel_position(MenuModel * model, guint index);
+static guint _menumodel_row(MenuModel * model, guint position);
+static void _menumodel_link(MenuModel * model, guint index);
+static void _menumodel_row_changed(MenuModel * model, guint index);
+
+
+G_DEFINE_TYPE_WITH_CODE(MenuModel, menumodel, G_TYPE_OBJECT,
+		G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL,
+			_menumodel_tree_model_init))
+
+
+/* public */
+/* functions */
+/* menumodel_new */
+MenuModel * menumodel_new(struct bsddialog_menuitem * items,
+		unsigned int nitems, gboolean tree)
+{
+	MenuModel * model;
+	guint i;
+
+	model = g_object_new(MENUMODEL_TYPE, NULL);
+	model->items = items;
+	model->nitems = nitems;
+	model->nroots = nitems;
+	for(i = 0; tree == FALSE && i < nitems; i++)
+		if(items[i].depth > 0)
+			tree = TRUE;
+	if((model->tree = tree) == FALSE || nitems == 0)
+		return model;
+	if((model->nodes = g_try_new(struct menumodel_node, nitems)) == NULL)
+	{
+		g_object_unref(model);
+		return NULL;
+	}
+	model->nroots = 0;
+	for(i = 0; i < nitems; i++)
+		_menumodel_link(model, i);
+	return model;
+}
+
+
+/* accessors */
+/* menumodel_get_count */
+unsigned int menumodel_get_count(MenuModel * model)
+{
+	return model->nitems;
+}
+
+
+/* menumodel_get_index */
+int menumodel_get_index(MenuModel * model, GtkTreeIter * iter)
+{
+	return _menumodel_iter_index(model, iter);
+}
+
+
+/* menumodel_get_iter */
+gboolean menumodel_get_iter(MenuModel * model, GtkTreeIter * iter,
+		unsigned int index)
+{
+	if(index >= model->nitems || (model->rows != NULL
+				&& model->positions[index] == MENUMODEL_NONE))
+		return FALSE;
+	_menumodel_iter_set(model, iter, index);
+	return TRUE;
+}
+
+
+/* menumodel_get_items */
+struct bsddialog_menuitem * menumodel_get_items(MenuModel * model)
+{
+	return model->items;
+}
+
+
+/* menumodel_get_radio */
+int menumodel_get_radio(MenuModel * model)
+{
+	return (model->radio != MENUMODEL_NONE) ? (int)model->radio : -1;
+}
+
+
+/* menumodel_get_set */
+gboolean menumodel_get_set(MenuModel * model, GtkTreeIter * iter)
+{
+	return model->items[_menumodel_iter_index(model, iter)].on
+		? TRUE : FALSE;
+}
+
+
+/* menumodel_is_tree */
+gboolean menumodel_is_tree(MenuModel * model)
+{
+	return model->tree;
+}
+
+
+/* menumodel_set */
+void menumodel_set(MenuModel * model, GtkTreeIter * iter, gboolean set)
+{
+	guint i;
+
+	i = _menumodel_iter_index(model, iter);
+	model->items[i].on = set ? true : false;
+	_menumodel_row_changed(model, i);
+}
+
+
+/* menumodel_set_range */
+void menumodel_set_range(MenuModel * model, GtkTreeIter * first,
+		GtkTreeIter * last, MenuModelSet set)
+{
+	guint count, i, j, k;
+
+	/* the range is that of the rows shown, in their order */
+	if((count = model->tree ? model->nitems : model->nroots) == 0)
+		return;
+	i = (first != NULL) ? _menumodel_iter_position(model, first) : 0;
+	j = (last != NULL) ? _menumodel_iter_position(model, last) : count - 1;
+	if(i > j)
+	{
+		k = i;
+		i = j;
+		j = k;
+	}
+	for(; i <= j && i < count; i++)
+	{
+		k = _menumodel_row(model, i);
+		switch(set)
+		{
+			case MMS_UNSET:
+				model->items[k].on = false;
+				break;
+			case MMS_SET:
+				model->items[k].on = true;
+				break;
+			case MMS_INVERT:
+				model->items[k].on = !model->items[k].on;
+				break;
+		}
+	}
+}
+
+
+/* menumodel_set_rows */
+int menumodel_set_rows(MenuModel * model, unsigned int const * rows,
+		unsigned int nrows)
+{
+	guint i;
+
+	if(model->tree)
+		return -1;
+	if(rows == NULL || model->nitems == 0)
+	{
+		g_free(model->rows);
+		g_free(model->positions);
+		model->rows = NULL;
+		model->positions = NULL;
+		model->nroots = model->nitems;
+		return 0;
+	}
+	if(model->rows == NULL)
+	{
+		model->rows = g_try_new(guint, model->nitems);
+		model->positions = g_try_new(guint, model->nitems);
+		if(model->rows == NULL || model->positions == NULL)
+		{
+			menumodel_set_rows(model, NULL, 0);
+			return -1;
+		}
+		for(i = 0; i < model->nitems; i++)
+			model->positions[i] = MENUMODEL_NONE;
+	}
+	else
+		for(i = 0; i < model->nroots; i++)
+			model->positions[model->rows[i]] = MENUMODEL_NONE;
+	memcpy(model->rows, rows, sizeof(*rows) * nrows);
+	for(i = 0; i < nrows; i++)
+		model->positions[rows[i]] = i;
+	model->nroots = nrows;
+	return 0;
+}
+
+
+/* menumodel_set_radio */
+void menumodel_set_radio(MenuModel * model, GtkTreeIter * iter)
+{
+	guint i;
+
+	if((i = _menumodel_iter_index(model, iter)) == model->radio)
+		return;
+	if(model->radio != MENUMODEL_NONE)
+	{
+		model->items[model->radio].on = false;
+		_menumodel_row_changed(model, model->radio);
+	}
+	model->items[i].on = true;
+	model->radio = i;
+	_menumodel_row_changed(model, i);
+}
+
+
+/* menumodel_set_radiolist */
+void menumodel_set_radiolist(MenuModel * model)
+{
+	guint i;
+
+	/* only the first item set remains so */
+	model->radiolist = TRUE;
+	model->radio = MENUMODEL_NONE;
+	for(i = 0; i < model->nitems; i++)
+		if(model->items[i].on == false)
+			continue;
+		else if(model->radio == MENUMODEL_NONE)
+			model->radio = i;
+		else
+		{
+			model->items[i].on = false;
+			_menumodel_row_changed(model, i);
+		}
+}
+
+
+/* useful */
+/* menumodel_append */
+int menumodel_append(MenuModel * model,
+		struct bsddialog_menuitem const * item)
+{
+	struct bsddialog_menuitem * items;
+	struct menumodel_node * nodes;
+	guint size, i;
+	GtkTreeIter iter;
+	GtkTreePath * path;
+
+	g_return_val_if_fail(model->rows == NULL, -1);
+	if(model->nitems >= model->size)
+	{
+		/* the items are only copied the first time */
+		size = (model->nitems > 0) ? model->nitems * 2 : 64;
+		if(model->size > 0)
+			items = g_try_renew(struct bsddialog_menuitem,
+					model->items, size);
+		else if((items = g_try_new(struct bsddialog_menuitem, size))
+				!= NULL && model->nitems > 0)
+			memcpy(items, model->items,
+					sizeof(*items) * model->nitems);
+		if(items == NULL)
+			return -1;
+		model->items = items;
+		model->size = size;
+		if(model->tree)
+		{
+			if((nodes = g_try_renew(struct menumodel_node,
+							model->nodes, size))
+					== NULL)
+				return -1;
+			model->nodes = nodes;
+		}
+	}
+	i = model->nitems;
+	model->items[i] = *item;
+	if(model->radiolist && model->items[i].on)
+	{
+		if(model->radio == MENUMODEL_NONE)
+			model->radio = i;
+		else
+			model->items[i].on = false;
+	}
+	if(model->tree)
+		_menumodel_link(model, i);
+	else
+	{
+		model->items[i].depth = 0;
+		model->nroots++;
+	}
+	model->nitems++;
+	_menumodel_iter_set(model, &iter, i);
+	path = _menumodel_get_path(GTK_TREE_MODEL(model), &iter);
+	gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, &iter);
+	if(model->tree && model->nodes[i].parent != MENUMODEL_NONE
+			&& model->nodes[model->nodes[i].parent].child == i)
+	{
+		/* the parent just got its first child */
+		gtk_tree_path_up(path);
+		_menumodel_iter_set(model, &iter, model->nodes[i].parent);
+		gtk_tree_model_row_has_child_toggled(GTK_TREE_MODEL(model),
+				path, &iter);
+	}
+	gtk_tree_path_free(path);
+	return 0;
+}
+
+
+/* menumodel_update_rows */
+static guint _update_rows_get(unsigned int const * rows, guint k);
+static void _update_rows_gap(MenuModel * model, guint gap, guint count);
+
+int menumodel_update_rows(MenuModel * model, unsigned int const * rows,
+		unsigned int nrows, unsigned int changes)
+{
+	guint n = model->nroots, size = model->nitems, i, j, k, s;
+	GtkTreeIter iter;
+	GtkTreePath * path;
+
+	if(model->tree || (nrows > n ? nrows - n : n - nrows) > changes)
+		return -1;
+	/* the rows must be a subset or a superset of those shown, in the same
+	 * order, as when the query of a filter grows or shrinks */
+	if(nrows <= n)
+	{
+		for(i = 0, k = 0; i < n && k < nrows; i++)
+			if(_menumodel_row(model, i) == _update_rows_get(rows, k))
+				k++;
+		if(k < nrows)
+			return -1;
+	}
+	else
+	{
+		for(i = 0, k = 0; i < n && k < nrows; k++)
+			if(_menumodel_row(model, i) == _update_rows_get(rows, k))
+				i++;
+		if(i < n)
+			return -1;
+	}
+	if(nrows == n)
+		return 0;
+	if(model->rows == NULL)
+	{
+		if((model->rows = g_try_new(guint, size)) == NULL
+				|| (model->positions = g_try_new(guint, size))
+				== NULL)
+		{
+			menumodel_set_rows(model, NULL, 0);
+			return -1;
+		}
+		for(i = 0; i < size; i++)
+			model->rows[i] = model->positions[i] = i;
+	}
+	/* the rows kept are moved across a gap, so that the model is
+	 * consistent whenever a row is deleted or inserted */
+	if(nrows < n)
+		/* the rows are removed starting from the end */
+		for(i = n, k = nrows, s = 0; i-- > 0;)
+		{
+			j = model->rows[i];
+			if(k > 0 && j == _update_rows_get(rows, k - 1))
+			{
+				k--;
+				s++;
+				model->rows[size - s] = j;
+				model->positions[j] = size - s;
+				_update_rows_gap(model, i, s);
+				continue;
+			}
+			model->positions[j] = MENUMODEL_NONE;
+			_update_rows_gap(model, i, s);
+			model->nroots--;
+			path = gtk_tree_path_new_from_indices(i, -1);
+			gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+			gtk_tree_path_free(path);
+		}
+	else
+	{
+		/* the rows are inserted starting from the beginning */
+		memmove(&model->rows[size - n], model->rows,
+				sizeof(*model->rows) * n);
+		for(i = size - n; i < size; i++)
+			model->positions[model->rows[i]] = i;
+		_update_rows_gap(model, 0, n);
+		for(k = 0, s = n; k < nrows; k++)
+		{
+			j = _update_rows_get(rows, k);
+			if(s > 0 && model->rows[size - s] == j)
+			{
+				s--;
+				model->rows[k] = j;
+				model->positions[j] = k;
+				_update_rows_gap(model, k + 1, s);
+				continue;
+			}
+			model->rows[k] = j;
+			model->positions[j] = k;
+			_update_rows_gap(model, k + 1, s);
+			model->nroots++;
+			_menumodel_iter_set(model, &iter, j);
+			path = gtk_tree_path_new_from_indices(k, -1);
+			gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path,
+					&iter);
+			gtk_tree_path_free(path);
+		}
+	}
+	/* the gap is closed */
+	if(model->gapsize > 0)
+	{
+		memmove(&model->rows[model->gap],
+				&model->rows[model->gap + model->gapsize],
+				sizeof(*model->rows) * (model->nroots
+					- model->gap));
+		for(i = model->gap; i < model->nroots; i++)
+			model->positions[model->rows[i]] = i;
+	}
+	model->gap = 0;
+	model->gapsize = 0;
+	return 0;
+}
+
+static guint _update_rows_get(unsigned int const * rows, guint k)
+{
+	return (rows != NULL) ? rows[k] : k;
+}
+
+static void _update_rows_gap(MenuModel * model, guint gap, guint count)
+{
+	/* count rows are kept at the end, past the gap */
+	model->gap = gap;
+	model->gapsize = model->nitems - gap - count;
+}
+
+
+/* private */
+/* functions */
+/* menumodel_class_init */
+static void menumodel_class_init(MenuModelClass * klass)
+{
+	GObjectClass * object_class = G_OBJECT_CLASS(klass);
+
+	object_class->finalize = _menumodel_finalize;
+}
+
+
+/* menumodel_init */
+static void menumodel_init(MenuModel * model)
+{
+	model->stamp = g_random_int();
+	model->items = NULL;
+	model->nitems = 0;
+	model->size = 0;
+	model->tree = FALSE;
+	model->nodes = NULL;
+	model->nroots = 0;
+	model->rows = NULL;
+	model->positions = NULL;
+	model->gap = 0;
+	model->gapsize = 0;
+	model->radiolist = FALSE;
+	model->radio = MENUMODEL_NONE;
+}
+
+
+/* menumodel_finalize */
+static void _menumodel_finalize(GObject * object)
+{
+	MenuModel * model = MENUMODEL(object);
+
+	if(model->size > 0)
+		g_free(model->items);
+	g_free(model->nodes);
+	g_free(model->rows);
+	g_free(model->positions);
+	G_OBJECT_CLASS(menumodel_parent_class)->finalize(object);
+}
+
+
+/* GtkTreeModel */
+/* menumodel_tree_model_init */
+static void _menumodel_tree_model_init(GtkTreeModelIface * iface)
+{
+	iface->get_flags = _menumodel_get_flags;
+	iface->get_n_columns = _menumodel_get_n_columns;
+	iface->get_column_type = _menumodel_get_column_type;
+	iface->get_iter = _menumodel_get_iter;
+	iface->get_path = _menumodel_get_path;
+	iface->get_value = _menumodel_get_value;
+	iface->iter_next = _menumodel_iter_next;
+	iface->iter_children = _menumodel_iter_children;
+	iface->iter_has_child = _menumodel_iter_has_child;
+	iface->iter_n_children = _menumodel_iter_n_children;
+	iface->iter_nth_child = _menumodel_iter_nth_child;
+	iface->iter_parent = _menumodel_iter_parent;
+}
+
+
+/* menumodel_get_flags */
+static GtkTreeModelFlags _menumodel_get_flags(GtkTreeModel * model)
+{
+	MenuModel * mm = MENUMODEL(model);
+
+	return (mm->tree == FALSE)
+		? GTK_TREE_MODEL_ITERS_PERSIST | GTK_TREE_MODEL_LIST_ONLY
+		: GTK_TREE_MODEL_ITERS_PERSIST;
+}
+
+
+/* menumodel_get_n_columns */
+static gint _menumodel_get_n_columns(GtkTreeModel * model)
+{
+	(void) model;
+
+	return MMC_COUNT;
+}
+
+
+/* menumodel_get_column_type */
+static GType _menumodel_get_column_type(GtkTreeModel * model, gint index)
+{
+	(void) model;
+
+	switch(index)
+	{
+		case MMC_SET:
+			return G_TYPE_BOOLEAN;
+		case MMC_DEPTH:
+			return G_TYPE_INT;
+		case MMC_PREFIX:
+		case MMC_NAME:
+		case MMC_DESCRIPTION:
+		case MMC_TOOLTIP:
+			return G_TYPE_STRING;
+	}
+	return G_TYPE_INVALID;
+}
+
+
+/* menumodel_get_iter */
+static gboolean _menumodel_get_iter(GtkTreeModel * model, GtkTreeIter * iter,
+		GtkTreePath * path)
+{
+	MenuModel * mm = MENUMODEL(model);
+	gint * indices;
+	gint depth, i;
+	GtkTreeIter parent;
+
+	indices = gtk_tree_path_get_indices(path);
+	depth = gtk_tree_path_get_depth(path);
+	for(i = 0; i < depth; i++)
+	{
+		if(_menumodel_iter_nth_child(model, iter,
+					(i > 0) ? &parent : NULL,
+					indices[i]) != TRUE)
+			return FALSE;
+		parent = *iter;
+	}
+	return (depth > 0 && mm->nitems > 0) ? TRUE : FALSE;
+}
+
+
+/* menumodel_get_path */
+static GtkTreePath * _menumodel_get_path(GtkTreeModel * model,
+		GtkTreeIter * iter)
+{
+	MenuModel * mm = MENUMODEL(model);
+	GtkTreePath * path;
+	guint i;
+
+	path = gtk_tree_path_new();
+	i = _menumodel_iter_index(mm, iter);
+	if(mm->tree == FALSE)
+	{
+		gtk_tree_path_append_index(path, _menumodel_position(mm, i));
+		return path;
+	}
+	for(; i != MENUMODEL_NONE; i = mm->nodes[i].parent)
+		gtk_tree_path_prepend_index(path, mm->nodes[i].pos);
+	return path;
+}
+
+
+/* menumodel_get_value */
+static void _menumodel_get_value(GtkTreeModel * model, GtkTreeIter * iter,
+		gint column, GValue * value)
+{
+	MenuModel * mm = MENUMODEL(model);
+	struct bsddialog_menuitem * item;
+
+	item = &mm->items[_menumodel_iter_index(mm, iter)];
+	g_value_init(value, _menumodel_get_column_type(model, column));
+	/* the strings are not copied */
+	switch(column)
+	{
+		case MMC_PREFIX:
+			g_value_set_static_string(value, item->prefix);
+			break;
+		case MMC_SET:
+			g_value_set_boolean(value, item->on ? TRUE : FALSE);
+			break;
+		case MMC_DEPTH:
+			g_value_set_int(value, item->depth);
+			break;
+		case MMC_NAME:
+			g_value_set_static_string(value, item->name);
+			break;
+		case MMC_DESCRIPTION:
+			g_value_set_static_string(value, item->desc);
+			break;
+		case MMC_TOOLTIP:
+			g_value_set_static_string(value, item->bottomdesc);
+			break;
+	}
+}
+
+
+/* menumodel_iter_next */
+static gboolean _menumodel_iter_next(GtkTreeModel * model, GtkTreeIter * iter)
+{
+	MenuModel * mm = MENUMODEL(model);
+	guint i;
+
+	i = _menumodel_iter_index(mm, iter);
+	if(mm->tree)
+		i = mm->nodes[i].next;
+	else if((i = _menumodel_position(mm, i) + 1) >= mm->nroots)
+		i = MENUMODEL_NONE;
+	else
+		i = _menumodel_row(mm, i);
+	if(i == MENUMODEL_NONE)
+		return FALSE;
+	_menumodel_iter_set(mm, iter, i);
+	return TRUE;
+}
+
+
+/* menumodel_iter_children */
+static gboolean _menumodel_iter_children(GtkTreeModel * model,
+		GtkTreeIter * iter, GtkTreeIter * parent)
+{
+	return _menumodel_iter_nth_child(model, iter, parent, 0);
+}
+
+
+/* menumodel_iter_has_child */
+static gboolean _menumodel_iter_has_child(GtkTreeModel * model,
+		GtkTreeIter * iter)
+{
+	MenuModel * mm = MENUMODEL(model);
+
+	if(mm->tree == FALSE)
+		return FALSE;
+	return (mm->nodes[_menumodel_iter_index(mm, iter)].child
+			!= MENUMODEL_NONE) ? TRUE : FALSE;
+}
+
+
+/* menumodel_iter_n_children */
+static gint _menumodel_iter_n_children(GtkTreeModel * model,
+		GtkTreeIter * iter)
+{
+	MenuModel * mm = MENUMODEL(model);
+	guint i;
+	gint ret = 0;
+
+	if(iter == NULL)
+		return mm->nroots;
+	if(mm->tree == FALSE)
+		return 0;
+	for(i = mm->nodes[_menumodel_iter_index(mm, iter)].child;
+			i != MENUMODEL_NONE; i = mm->nodes[i].next)
+		ret++;
+	return ret;
+}
+
+
+/* menumodel_iter_nth_child */
+static gboolean _menumodel_iter_nth_child(GtkTreeModel * model,
+		GtkTreeIter * iter, GtkTreeIter * parent, gint n)
+{
+	MenuModel * mm = MENUMODEL(model);
+	guint i;
+
+	if(n < 0)
+		return FALSE;
+	if(mm->tree == FALSE)
+	{
+		/* the rows are indexed directly */
+		if(parent != NULL || (guint)n >= mm->nroots)
+			return FALSE;
+		_menumodel_iter_set(mm, iter, _menumodel_row(mm, n));
+		return TRUE;
+	}
+	i = (parent == NULL) ? ((mm->nitems > 0) ? 0 : MENUMODEL_NONE)
+		: mm->nodes[_menumodel_iter_index(mm, parent)].child;
+	for(; i != MENUMODEL_NONE && n > 0; n--)
+		i = mm->nodes[i].next;
+	if(i == MENUMODEL_NONE)
+		return FALSE;
+	_menumodel_iter_set(mm, iter, i);
+	return TRUE;
+}
+
+
+/* menumodel_iter_parent */
+static gboolean _menumodel_iter_parent(GtkTreeModel * model,
+		GtkTreeIter * iter, GtkTreeIter * child)
+{
+	MenuModel * mm = MENUMODEL(model);
+	guint i;
+
+	if(mm->tree == FALSE)
+		return FALSE;
+	if((i = mm->nodes[_menumodel_iter_index(mm, child)].parent)
+			== MENUMODEL_NONE)
+		return FALSE;
+	_menumodel_iter_set(mm, iter, i);
+	return TRUE;
+}
+
+
+/* useful */
+/* menumodel_iter_set */
+static void _menumodel_iter_set(MenuModel * model, GtkTreeIter * iter,
+		guint index)
+{
+	iter->stamp = model->stamp;
+	iter->user_data = GUINT_TO_POINTER(index);
+	iter->user_data2 = NULL;
+	iter->user_data3 = NULL;
+}
+
+
+/* menumodel_iter_index */
+static guint _menumodel_iter_index(MenuModel * model, GtkTreeIter * iter)
+{
+	g_return_val_if_fail(iter->stamp == model->stamp, 0);
+	return GPOINTER_TO_UINT(iter->user_data);
+}
+
+
+/* menumodel_iter_position */
+static guint _menumodel_iter_position(MenuModel * model, GtkTreeIter * iter)
+{
+	guint i;
+
+	i = _menumodel_iter_index(model, iter);
+	return _menumodel_position(model, i);
+}
+
+
+/* menumodel_link */
+static void _menumodel_link(MenuModel * model, guint index)
+{
+	struct menumodel_node * nodes = model->nodes;
+	guint p, last;
+	unsigned int depth;
+
+	/* the parent is the last row inserted with a lower depth, found by
+	 * walking up the ancestors of the previous row */
+	depth = model->items[index].depth;
+	for(p = (index > 0) ? index - 1 : MENUMODEL_NONE, last = MENUMODEL_NONE;
+			p != MENUMODEL_NONE && model->items[p].depth >= depth;
+			p = nodes[p].parent)
+		last = p;
+	nodes[index].parent = p;
+	nodes[index].child = MENUMODEL_NONE;
+	nodes[index].next = MENUMODEL_NONE;
+	if(last != MENUMODEL_NONE)
+	{
+		/* last is the previous sibling */
+		nodes[last].next = index;
+		nodes[index].pos = nodes[last].pos + 1;
+	}
+	else
+	{
+		if(p != MENUMODEL_NONE)
+			nodes[p].child = index;
+		nodes[index].pos = 0;
+	}
+	if(p == MENUMODEL_NONE)
+		model->nroots++;
+}
+
+
+/* menumodel_position */
+static guint _menumodel_position(MenuModel * model, guint index)
+{
+	guint p;
+
+	if(model->rows == NULL)
+		return index;
+	/* the positions stored are offsets into rows, past the gap if any */
+	if((p = model->positions[index]) == MENUMODEL_NONE || p < model->gap)
+		return p;
+	return p - model->gapsize;
+}
+
+
+/* menumodel_row */
+static guint _menumodel_row(MenuModel * model, guint position)
+{
+	if(model->rows == NULL)
+		return position;
+	return model->rows[(position < model->gap) ? position
+		: position + model->gapsize];
+}
+
+
+/* menumodel_row_changed */
+static void _menumodel_row_changed(MenuModel * model, guint index)
+{
+	GtkTreeIter iter;
+	GtkTreePath * path;
+
+	/* the items filtered out are not shown */
+	if(model->rows != NULL && model->positions[index] == MENUMODEL_NONE)
+		return;
+	_menumodel_iter_set(model, &iter, index);
+	path = _menumodel_get_path(GTK_TREE_MODEL(model), &iter);
+	gtk_tree_model_row_changed(GTK_TREE_MODEL(model), path, &iter);
+	gtk_tree_path_free(path);
+}
@@ -0,0 +1,107 @@
+/* gbsddialog */
+/* menumodel.h */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+#ifndef GBSDDIALOG_MENUMODEL_H
+# define GBSDDIALOG_MENUMODEL_H
+
+# include <gtk/gtk.h>
+# include "bsddialog.h"
+
+
+/* MenuModel */
+/* types */
+typedef struct _MenuModel MenuModel;
+typedef struct _MenuModelClass MenuModelClass;
+
+
+/* constants */
+enum MENUMODEL_COLUMN
+{
+	MMC_PREFIX = 0,
+	MMC_SET,
+	MMC_DEPTH,
+	MMC_NAME,
+	MMC_DESCRIPTION,
+	MMC_TOOLTIP
+};
+# define MMC_LAST MMC_TOOLTIP
+# define MMC_COUNT (MMC_LAST + 1)
+
+typedef enum _MenuModelSet
+{
+	MMS_UNSET = 0,
+	MMS_SET,
+	MMS_INVERT
+} MenuModelSet;
+
+# define MENUMODEL_TYPE		(menumodel_get_type())
+# define MENUMODEL(obj)		(G_TYPE_CHECK_INSTANCE_CAST((obj), \
+			MENUMODEL_TYPE, MenuModel))
+# define IS_MENUMODEL(obj)	(G_TYPE_CHECK_INSTANCE_TYPE((obj), \
+			MENUMODEL_TYPE))
+
+
+/* functions */
+GType menumodel_get_type(void);
+
+MenuModel * menumodel_new(struct bsddialog_menuitem * items,
+		unsigned int nitems, gboolean tree);
+
+/* accessors */
+unsigned int menumodel_get_count(MenuModel * model);
+int menumodel_get_index(MenuModel * model, GtkTreeIter * iter);
+gboolean menumodel_get_iter(MenuModel * model, GtkTreeIter * iter,
+		unsigned int index);
+struct bsddialog_menuitem * menumodel_get_items(MenuModel * model);
+int menumodel_get_radio(MenuModel * model);
+gboolean menumodel_get_set(MenuModel * model, GtkTreeIter * iter);
+gboolean menumodel_is_tree(MenuModel * model);
+
+void menumodel_set(MenuModel * model, GtkTreeIter * iter, gboolean set);
+/* the model must not be in use by a view when setting a range */
+void menumodel_set_range(MenuModel * model, GtkTreeIter * first,
+		GtkTreeIter * last, MenuModelSet set);
+/* only after menumodel_set_radiolist() */
+void menumodel_set_radio(MenuModel * model, GtkTreeIter * iter);
+void menumodel_set_radiolist(MenuModel * model);
+/* the model must not be in use by a view when setting the rows */
+int menumodel_set_rows(MenuModel * model, unsigned int const * rows,
+		unsigned int nrows);
+
+/* useful */
+int menumodel_append(MenuModel * model,
+		struct bsddialog_menuitem const * item);
+/* only if the rows are a subset or a superset of those shown, updating the
+ * views as they change */
+int menumodel_update_rows(MenuModel * model, unsigned int const * rows,
+		unsigned int nrows, unsigned int changes);
+
+#endif /* !GBSDDIALOG_MENUMODEL_H */
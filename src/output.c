@@ -0,0 +1,707 @@
+/* gbsddialog */
+/* output.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "common.h"
+#include "output.h"
+
+#ifndef IOV_MAX
+# define IOV_MAX	16
+#endif
+
+
+/* Output */
+/* private */
+/* types */
+struct _Output
+{
+	int fd;
+	gboolean owned;			/* the descriptor was duplicated */
+	gboolean stream;		/* a pipe or a socket */
+	int target;			/* the descriptor passed */
+	dev_t dev;			/* identifies the file written to */
+	ino_t ino;
+
+	GPtrArray * blocks;
+	guint block;			/* the first block not written */
+	gsize offset;			/* into this block */
+
+	guint id;
+	gboolean queued;		/* behind another output to this file */
+	gboolean deleted;
+
+	/* writer thread */
+	GThread * thread;
+	struct iovec * iov;
+	guint iov_cnt;
+	guint iov_block;		/* the first block not handed over */
+
+	/* records */
+	GPtrArray * values;
+};
+
+
+/* constants */
+#define OUTPUT_BLOCK	65536
+
+
+/* variables */
+static guint _output_pending = 0;
+static guint _output_errors = 0;
+/* the outputs pending, written in turn for each file */
+static GList * _output_queue = NULL;
+
+
+/* prototypes */
+static void _output_done(Output * output);
+static void _output_error(int code);
+static int _output_json(Output * output, char const * string);
+static void _output_own(Output * output);
+static Output * _output_queued(Output * output);
+static size_t _output_size(Output * output);
+static void _output_start(Output * output);
+static int _output_thread(Output * output);
+static void _output_watch(Output * output);
+static int _output_write(Output * output);
+static gpointer _output_writer(gpointer data);
+
+/* callbacks */
+static gboolean _output_on_can_write(GIOChannel * channel,
+		GIOCondition condition, gpointer data);
+static gboolean _output_on_written(gpointer data);
+
+
+/* public */
+/* functions */
+/* output_new */
+Output * output_new(int fd)
+{
+	Output * output;
+	struct stat st;
+
+	output = g_new(Output, 1);
+	output->fd = fd;
+	output->owned = FALSE;
+	output->target = fd;
+	output->dev = 0;
+	output->ino = 0;
+	output->stream = FALSE;
+	if(fstat(fd, &st) == 0)
+	{
+		/* writing to pipes and sockets may block */
+		output->stream = S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode);
+		output->dev = st.st_dev;
+		output->ino = st.st_ino;
+	}
+	output->blocks = g_ptr_array_new_with_free_func(
+			(GDestroyNotify)g_byte_array_unref);
+	output->block = 0;
+	output->offset = 0;
+	output->id = 0;
+	output->queued = FALSE;
+	output->deleted = FALSE;
+	output->thread = NULL;
+	output->iov = NULL;
+	output->iov_cnt = 0;
+	output->iov_block = 0;
+	output->values = g_ptr_array_new_with_free_func(g_free);
+	return output;
+}
+
+
+/* output_delete */
+void output_delete(Output * output)
+{
+	output_flush(output);
+	if(output->id != 0 || output->queued || output->thread != NULL)
+	{
+		/* freed once written */
+		output->deleted = TRUE;
+		return;
+	}
+	if(output->owned)
+		close(output->fd);
+	g_ptr_array_free(output->blocks, TRUE);
+	g_ptr_array_free(output->values, TRUE);
+	g_free(output);
+}
+
+
+/* useful */
+/* output_flush */
+int output_flush(Output * output)
+{
+	int res;
+
+	if(output->id != 0 || output->queued || output->thread != NULL)
+		return 0;
+	if(output->block >= output->blocks->len)
+	{
+		g_ptr_array_set_size(output->blocks, 0);
+		output->block = 0;
+		output->offset = 0;
+		return 0;
+	}
+	/* the outputs to the same file are written in order */
+	if(_output_queued(output) != NULL)
+	{
+		_output_own(output);
+		output->queued = TRUE;
+	}
+	/* larger outputs to streams are written at once from a thread */
+	else if((res = (output->stream && _output_size(output) > PIPE_BUF)
+				? 1 : _output_write(output)) <= 0)
+	{
+		if(res < 0)
+			_output_error(errno);
+		g_ptr_array_set_size(output->blocks, 0);
+		output->block = 0;
+		output->offset = 0;
+		return res;
+	}
+	else
+	{
+		_output_own(output);
+		_output_watch(output);
+	}
+	_output_queue = g_list_append(_output_queue, output);
+	_output_pending++;
+	return 0;
+}
+
+
+/* output_printf */
+int output_printf(Output * output, char const * format, ...)
+{
+	int res;
+	va_list ap;
+	char buf[256];
+	char * p;
+
+	va_start(ap, format);
+	res = vsnprintf(buf, sizeof(buf), format, ap);
+	va_end(ap);
+	if(res < 0)
+		return -1;
+	if((size_t)res < sizeof(buf))
+		return output_write(output, buf, res);
+	va_start(ap, format);
+	p = g_strdup_vprintf(format, ap);
+	va_end(ap);
+	res = output_write(output, p, res);
+	g_free(p);
+	return res;
+}
+
+
+/* output_quoted */
+int output_quoted(Output * output, char const * string, char quotech)
+{
+	if(output_write(output, &quotech, 1) != 0
+			|| output_string(output, string) != 0)
+		return -1;
+	return output_write(output, &quotech, 1);
+}
+
+
+/* output_string */
+int output_string(Output * output, char const * string)
+{
+	return output_write(output, string, strlen(string));
+}
+
+
+/* output_write */
+int output_write(Output * output, void const * buf, size_t size)
+{
+	GByteArray * block = NULL;
+
+	if(size == 0)
+		return 0;
+	/* the blocks handed over to the writer thread are left untouched */
+	if(output->thread == NULL && output->blocks->len > output->block)
+		block = g_ptr_array_index(output->blocks,
+				output->blocks->len - 1);
+	if(block == NULL || block->len + size > OUTPUT_BLOCK)
+	{
+		block = g_byte_array_sized_new(MAX(size, OUTPUT_BLOCK));
+		g_ptr_array_add(output->blocks, block);
+	}
+	g_byte_array_append(block, buf, size);
+	return 0;
+}
+
+
+/* records */
+/* output_record */
+int output_record(Output * output, OutputFormat format, int code,
+		char const * button, int height, int width)
+{
+	int ret = 0;
+	guint i;
+
+	switch(format)
+	{
+		case OF_JSON:
+			ret |= output_printf(output, "{\"code\":%d,\"button\":",
+					code);
+			ret |= _output_json(output, button);
+			ret |= output_string(output, ",\"values\":[");
+			for(i = 0; i < output->values->len; i++)
+			{
+				if(i > 0)
+					ret |= output_write(output, ",", 1);
+				ret |= _output_json(output, g_ptr_array_index(
+							output->values, i));
+			}
+			ret |= output_write(output, "]", 1);
+			if(height >= 0 && width >= 0)
+				ret |= output_printf(output,
+						",\"height\":%d,\"width\":%d",
+						height, width);
+			ret |= output_string(output, "}\n");
+			break;
+		case OF_NUL:
+			/* every field is terminated */
+			ret |= output_printf(output, "%d%c%s%c", code, '\0',
+					button, '\0');
+			if(height >= 0 && width >= 0)
+				ret |= output_printf(output, "%d%c%d%c",
+						height, '\0', width, '\0');
+			else
+				ret |= output_write(output, "\0\0", 2);
+			for(i = 0; i < output->values->len; i++)
+				ret |= output_write(output, g_ptr_array_index(
+							output->values, i),
+						strlen(g_ptr_array_index(
+								output->values,
+								i)) + 1);
+			break;
+		case OF_TEXT:
+			for(i = 0; i < output->values->len; i++)
+				ret |= output_printf(output, "%s\n",
+						(char *)g_ptr_array_index(
+							output->values, i));
+			break;
+	}
+	g_ptr_array_set_size(output->values, 0);
+	return (ret == 0) ? output_flush(output) : -1;
+}
+
+
+/* output_value */
+int output_value(Output * output, char const * value)
+{
+	g_ptr_array_add(output->values, g_strdup(value));
+	return 0;
+}
+
+
+/* output_value_printf */
+int output_value_printf(Output * output, char const * format, ...)
+{
+	va_list ap;
+
+	va_start(ap, format);
+	g_ptr_array_add(output->values, g_strdup_vprintf(format, ap));
+	va_end(ap);
+	return 0;
+}
+
+
+/* output_dprintf */
+int output_dprintf(int fd, char const * format, ...)
+{
+	Output * output;
+	va_list ap;
+	char * p;
+	int res;
+
+	va_start(ap, format);
+	p = g_strdup_vprintf(format, ap);
+	va_end(ap);
+	output = output_new(fd);
+	res = output_string(output, p);
+	g_free(p);
+	output_delete(output);
+	return res;
+}
+
+
+/* output_wait */
+int output_wait(void)
+{
+	int ret;
+
+	while(_output_pending > 0)
+		g_main_context_iteration(NULL, TRUE);
+	ret = (_output_errors > 0) ? BSDDIALOG_ERROR : BSDDIALOG_OK;
+	_output_errors = 0;
+	return ret;
+}
+
+
+/* private */
+/* functions */
+/* output_done */
+static void _output_done(Output * output)
+{
+	Output * next;
+
+	_output_queue = g_list_remove(_output_queue, output);
+	_output_pending--;
+	g_ptr_array_set_size(output->blocks, 0);
+	output->block = 0;
+	output->offset = 0;
+	/* the next output to this file can be written */
+	next = _output_queued(output);
+	if(output->deleted)
+		output_delete(output);
+	if(next != NULL)
+		_output_start(next);
+}
+
+
+/* output_error */
+static void _output_error(int code)
+{
+	error(BSDDIALOG_ERROR, "%s: %s", "write", strerror(code));
+	_output_errors++;
+}
+
+
+/* output_json */
+static int _output_json(Output * output, char const * string)
+{
+	int ret = 0;
+	char const * p;
+
+	ret |= output_write(output, "\"", 1);
+	for(p = string; *string != '\0'; string = ++p)
+	{
+		while(*p != '\0' && *p != '"' && *p != '\\'
+				&& (unsigned char)*p >= 0x20)
+			p++;
+		ret |= output_write(output, string, p - string);
+		if(*p == '\0')
+			break;
+		else if(*p == '"' || *p == '\\')
+			ret |= output_printf(output, "\\%c", *p);
+		else if(*p == '\n')
+			ret |= output_write(output, "\\n", 2);
+		else if(*p == '\t')
+			ret |= output_write(output, "\\t", 2);
+		else
+			ret |= output_printf(output, "\\u%04x",
+					(unsigned char)*p);
+	}
+	ret |= output_write(output, "\"", 1);
+	return ret;
+}
+
+
+/* output_own */
+static void _output_own(Output * output)
+{
+	int fd;
+
+	/* the descriptor may be closed by the caller meanwhile */
+	if(output->owned == FALSE && (fd = dup(output->fd)) >= 0)
+	{
+		output->fd = fd;
+		output->owned = TRUE;
+	}
+}
+
+
+/* output_queued */
+static Output * _output_queued(Output * output)
+{
+	GList * l;
+	Output * o;
+
+	for(l = _output_queue; l != NULL; l = l->next)
+		if((o = l->data) == output)
+			continue;
+		else if((output->ino != 0 || output->dev != 0)
+				? (o->dev == output->dev
+					&& o->ino == output->ino)
+				: (o->target == output->target))
+			return o;
+	return NULL;
+}
+
+
+/* output_size */
+static size_t _output_size(Output * output)
+{
+	size_t ret = 0;
+	guint i;
+
+	for(i = output->block; i < output->blocks->len; i++)
+		ret += ((GByteArray *)g_ptr_array_index(output->blocks, i))->len;
+	return ret - output->offset;
+}
+
+
+/* output_start */
+static void _output_start(Output * output)
+{
+	int res;
+
+	output->queued = FALSE;
+	if((res = (output->stream && _output_size(output) > PIPE_BUF)
+				? 1 : _output_write(output)) > 0)
+	{
+		_output_watch(output);
+		return;
+	}
+	if(res < 0)
+		_output_error(errno);
+	_output_done(output);
+}
+
+
+/* output_thread */
+static int _output_thread(Output * output)
+{
+	GByteArray * block;
+	guint i;
+
+	output->iov = g_new(struct iovec, output->blocks->len - output->block);
+	for(i = output->block, output->iov_cnt = 0; i < output->blocks->len;
+			i++, output->iov_cnt++)
+	{
+		block = g_ptr_array_index(output->blocks, i);
+		output->iov[output->iov_cnt].iov_base = block->data;
+		output->iov[output->iov_cnt].iov_len = block->len;
+	}
+	output->iov[0].iov_base = (char *)output->iov[0].iov_base
+		+ output->offset;
+	output->iov[0].iov_len -= output->offset;
+	output->iov_block = output->blocks->len;
+#if GLIB_CHECK_VERSION(2, 32, 0)
+	output->thread = g_thread_try_new("output", _output_writer, output,
+			NULL);
+#else
+	output->thread = g_thread_create(_output_writer, output, TRUE, NULL);
+#endif
+	if(output->thread == NULL)
+	{
+		g_free(output->iov);
+		output->iov = NULL;
+		return -1;
+	}
+	return 0;
+}
+
+
+/* output_watch */
+static void _output_watch(Output * output)
+{
+	GIOChannel * channel;
+
+	/* otherwise written in pieces as the descriptor becomes writable */
+	if(output->stream && _output_thread(output) == 0)
+		return;
+	channel = g_io_channel_unix_new(output->fd);
+	output->id = g_io_add_watch(channel, G_IO_OUT | G_IO_ERR | G_IO_HUP,
+			_output_on_can_write, output);
+	g_io_channel_unref(channel);
+}
+
+
+/* output_write */
+static int _output_write(Output * output)
+{
+	struct iovec iov[IOV_MAX];
+	struct pollfd pfd;
+	GByteArray * block;
+	guint i;
+	int n;
+	size_t size, len;
+	ssize_t res;
+
+	while(output->block < output->blocks->len)
+	{
+		if(output->stream)
+		{
+			/* at most PIPE_BUF bytes are known to fit */
+			pfd.fd = output->fd;
+			pfd.events = POLLOUT;
+			if((n = poll(&pfd, 1, 0)) == 0)
+				return 1;
+			else if(n < 0 && errno != EINTR)
+				return -1;
+		}
+		for(i = output->block, n = 0, size = 0;
+				i < output->blocks->len && n < IOV_MAX
+				&& (output->stream == FALSE
+					|| size < PIPE_BUF); i++, n++)
+		{
+			block = g_ptr_array_index(output->blocks, i);
+			len = block->len;
+			iov[n].iov_base = block->data;
+			if(i == output->block)
+			{
+				len -= output->offset;
+				iov[n].iov_base = block->data + output->offset;
+			}
+			if(output->stream && size + len > PIPE_BUF)
+				len = PIPE_BUF - size;
+			iov[n].iov_len = len;
+			size += len;
+		}
+		if((res = writev(output->fd, iov, n)) < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			if(errno == EAGAIN || errno == EWOULDBLOCK)
+				return 1;
+			return -1;
+		}
+		/* skip what was written */
+		for(size = res; output->block < output->blocks->len; )
+		{
+			block = g_ptr_array_index(output->blocks,
+					output->block);
+			len = block->len - output->offset;
+			if(size < len)
+			{
+				output->offset += size;
+				break;
+			}
+			size -= len;
+			output->block++;
+			output->offset = 0;
+		}
+	}
+	return 0;
+}
+
+
+/* output_writer */
+static gpointer _output_writer(gpointer data)
+{
+	Output * output = data;
+	struct iovec * iov = output->iov;
+	guint cnt = output->iov_cnt;
+	struct pollfd pfd;
+	size_t size;
+	ssize_t res;
+	int ret = 0;
+
+	/* blocks the thread instead of the main loop */
+	while(cnt > 0)
+	{
+		if((res = writev(output->fd, iov, MIN(cnt, IOV_MAX))) < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			/* the descriptor may be non-blocking */
+			pfd.fd = output->fd;
+			pfd.events = POLLOUT;
+			if((errno == EAGAIN || errno == EWOULDBLOCK)
+					&& (poll(&pfd, 1, -1) >= 0
+						|| errno == EINTR))
+				continue;
+			ret = errno;
+			break;
+		}
+		/* skip what was written */
+		for(size = res; cnt > 0 && size >= iov->iov_len; iov++, cnt--)
+			size -= iov->iov_len;
+		if(cnt > 0)
+		{
+			iov->iov_base = (char *)iov->iov_base + size;
+			iov->iov_len -= size;
+		}
+	}
+	g_idle_add(_output_on_written, output);
+	return GINT_TO_POINTER(ret);
+}
+
+
+/* callbacks */
+/* output_on_can_write */
+static gboolean _output_on_can_write(GIOChannel * channel,
+		GIOCondition condition, gpointer data)
+{
+	Output * output = data;
+	int res;
+	(void) channel;
+
+	if((condition & G_IO_OUT) == 0)
+		_output_error(EPIPE);
+	else if((res = _output_write(output)) > 0)
+		return TRUE;
+	else if(res < 0)
+		_output_error(errno);
+	output->id = 0;
+	_output_done(output);
+	return FALSE;
+}
+
+
+/* output_on_written */
+static gboolean _output_on_written(gpointer data)
+{
+	Output * output = data;
+	int res;
+
+	res = GPOINTER_TO_INT(g_thread_join(output->thread));
+	output->thread = NULL;
+	g_free(output->iov);
+	output->iov = NULL;
+	output->block = output->iov_block;
+	output->offset = 0;
+	if(res != 0)
+		_output_error(res);
+	else if(output->block < output->blocks->len)
+	{
+		/* written meanwhile */
+		_output_watch(output);
+		return FALSE;
+	}
+	_output_done(output);
+	return FALSE;
+}
@@ -0,0 +1,76 @@
+/* gbsddialog */
+/* output.h */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#ifndef GBSDDIALOG_OUTPUT_H
+# define GBSDDIALOG_OUTPUT_H
+
+# include <glib.h>
+
+
+/* Output */
+/* types */
+typedef struct _Output Output;
+
+typedef enum _OutputFormat
+{
+	OF_TEXT = 0,
+	OF_JSON,
+	OF_NUL
+} OutputFormat;
+
+
+/* functions */
+Output * output_new(int fd);
+/* what remains to be written is flushed from the main loop if necessary */
+void output_delete(Output * output);
+
+/* useful */
+int output_flush(Output * output);
+int output_printf(Output * output, char const * format, ...)
+	G_GNUC_PRINTF(2, 3);
+int output_quoted(Output * output, char const * string, char quotech);
+int output_string(Output * output, char const * string);
+int output_write(Output * output, void const * buf, size_t size);
+
+/* records */
+int output_record(Output * output, OutputFormat format, int code,
+		char const * button, int height, int width);
+int output_value(Output * output, char const * value);
+int output_value_printf(Output * output, char const * format, ...)
+	G_GNUC_PRINTF(2, 3);
+
+int output_dprintf(int fd, char const * format, ...) G_GNUC_PRINTF(2, 3);
+/* waits for the outputs still pending, returns BSDDIALOG_ERROR if any was
+ * lost since the last call */
+int output_wait(void);
+
+#endif /* !GBSDDIALOG_OUTPUT_H */
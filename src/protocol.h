@@ -0,0 +1,77 @@
+/* gbsddialog */
+/* protocol.h */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#ifndef GBSDDIALOG_PROTOCOL_H
+# define GBSDDIALOG_PROTOCOL_H
+
+# include <stdint.h>
+
+
+/* protocol */
+/* constants */
+/* identifies requests, as opposed to a plain backtitle update */
+# define GBSDDIALOG_PROTOCOL_MAGIC	"\0GBD"
+# define GBSDDIALOG_PROTOCOL_MAGIC_SIZE	4
+
+/* descriptors passed along the request: stdin, stdout, stderr, the working
+ * directory, and optionally the output */
+# define GBSDDIALOG_PROTOCOL_FDS	5
+# define GBSDDIALOG_PROTOCOL_FD_CWD	3
+# define GBSDDIALOG_PROTOCOL_FD_OUTPUT	4
+
+/* environment variables forwarded along the request, as prefixes of the
+ * NAME=value entries */
+# define GBSDDIALOG_PROTOCOL_ENV	"BSDDIALOG_", "XDIALOG_", "PATH=", \
+	"TMPDIR="
+
+/* upper limit for the size of the argument vector */
+# define GBSDDIALOG_PROTOCOL_SIZE_MAX	(1 << 20)
+
+/* delay for the complete request to be received, in seconds */
+# define GBSDDIALOG_PROTOCOL_TIMEOUT	10
+
+
+/* types */
+/* the request is followed by size bytes of NUL-terminated strings: argc
+ * arguments, then envc environment variables */
+struct gbsddialog_request
+{
+	char magic[GBSDDIALOG_PROTOCOL_MAGIC_SIZE];
+	uint32_t argc;
+	uint32_t envc;
+	uint32_t size;
+	int32_t output_fd;
+};
+
+/* the reply is the exit code of the process, as a single int32_t */
+
+#endif /* !GBSDDIALOG_PROTOCOL_H */
@@ -0,0 +1,548 @@
+/* gbsddialog */
+/* reader.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include "reader.h"
+
+
+/* Reader */
+/* private */
+/* types */
+struct reader_chunk
+{
+	char * buf;			/* NULL at the end */
+	size_t len;			/* or lines indexed */
+	GArray * offsets;		/* indexed instead of read */
+};
+
+struct _Reader
+{
+	char * filename;
+	int fd;
+	gboolean close;
+	size_t map;
+	ReaderCallback callback;
+	ReaderIndexCallback index;
+	gpointer data;
+
+	GThread * thread;
+	gint cancel;
+	int wake[2];			/* to interrupt the thread */
+	gint waiting;			/* for the chunks to be consumed */
+
+	/* set by the thread before the first chunk */
+	TextMap * tm;			/* until taken */
+	TextMap * indexed;		/* extended by the main loop */
+	GError * error;
+
+	/* handed over from the thread to the main loop without locking */
+	struct reader_chunk chunks[16];
+	gint head;			/* written by the thread only */
+	gint tail;			/* written by the main loop only */
+	gint notified;			/* an idle source is pending */
+	gboolean paused;
+	gboolean done;
+};
+
+
+/* constants */
+#define READER_BLOCK		65536
+/* bytes indexed at once when mapped */
+#define READER_INDEX		(16 * 1024 * 1024)
+
+
+/* prototypes */
+static Reader * _reader_new(char const * filename, int fd, gboolean closefd,
+		size_t map, ReaderCallback callback, ReaderIndexCallback index,
+		gpointer data);
+
+static size_t _reader_cut(char const * buf, size_t len, gboolean lines);
+static gboolean _reader_map(Reader * reader);
+static int _reader_open(Reader * reader);
+static gboolean _reader_push(Reader * reader, char * buf, size_t len,
+		GArray * offsets);
+static GIOStatus _reader_read(Reader * reader, char * buf, size_t size,
+		gboolean wait, size_t * len);
+static void _reader_stream(Reader * reader);
+static void _reader_wait(Reader * reader);
+static void _reader_wake(Reader * reader, gboolean always);
+
+static gboolean _reader_on_ready(gpointer data);
+static gpointer _reader_thread(gpointer data);
+
+
+/* public */
+/* functions */
+/* reader_new_file */
+Reader * reader_new_file(char const * filename, size_t map,
+		ReaderCallback callback, ReaderIndexCallback index,
+		gpointer data)
+{
+	return _reader_new(filename, -1, TRUE, map, callback, index, data);
+}
+
+
+/* reader_new_fd */
+Reader * reader_new_fd(int fd, gboolean close, ReaderCallback callback,
+		gpointer data)
+{
+	return _reader_new(NULL, fd, close, 0, callback, NULL, data);
+}
+
+
+/* reader_delete */
+void reader_delete(Reader * reader)
+{
+	guint i;
+
+	g_atomic_int_set(&reader->cancel, 1);
+	_reader_wake(reader, TRUE);
+	g_thread_join(reader->thread);
+	/* the notifications may still be pending */
+	while(g_source_remove_by_user_data(reader));
+	for(i = 0; i < G_N_ELEMENTS(reader->chunks); i++)
+	{
+		g_free(reader->chunks[i].buf);
+		if(reader->chunks[i].offsets != NULL)
+			g_array_free(reader->chunks[i].offsets, TRUE);
+	}
+	if(reader->tm != NULL)
+		textmap_delete(reader->tm);
+	if(reader->error != NULL)
+		g_error_free(reader->error);
+	close(reader->wake[0]);
+	close(reader->wake[1]);
+	g_free(reader->filename);
+	g_free(reader);
+}
+
+
+/* accessors */
+/* reader_take_map */
+TextMap * reader_take_map(Reader * reader)
+{
+	TextMap * tm = reader->tm;
+
+	reader->tm = NULL;
+	return tm;
+}
+
+
+/* useful */
+/* reader_resume */
+void reader_resume(Reader * reader)
+{
+	if(!reader->paused)
+		return;
+	reader->paused = FALSE;
+	g_atomic_int_set(&reader->notified, 1);
+	g_idle_add(_reader_on_ready, reader);
+	_reader_wake(reader, FALSE);
+}
+
+
+/* private */
+/* functions */
+/* reader_new */
+static Reader * _reader_new(char const * filename, int fd, gboolean closefd,
+		size_t map, ReaderCallback callback, ReaderIndexCallback index,
+		gpointer data)
+{
+	Reader * reader;
+	guint i;
+
+	reader = g_new(Reader, 1);
+	if(pipe(reader->wake) != 0)
+	{
+		g_free(reader);
+		return NULL;
+	}
+	/* only ever polled */
+	fcntl(reader->wake[0], F_SETFL, O_NONBLOCK);
+	fcntl(reader->wake[1], F_SETFL, O_NONBLOCK);
+	reader->filename = g_strdup(filename);
+	reader->fd = fd;
+	reader->close = closefd;
+	reader->map = map;
+	reader->callback = callback;
+	reader->index = index;
+	reader->data = data;
+	reader->cancel = 0;
+	reader->waiting = 0;
+	reader->tm = NULL;
+	reader->indexed = NULL;
+	reader->error = NULL;
+	for(i = 0; i < G_N_ELEMENTS(reader->chunks); i++)
+	{
+		reader->chunks[i].buf = NULL;
+		reader->chunks[i].offsets = NULL;
+	}
+	reader->head = 0;
+	reader->tail = 0;
+	reader->notified = 0;
+	reader->paused = FALSE;
+	reader->done = FALSE;
+#if GLIB_CHECK_VERSION(2, 32, 0)
+	reader->thread = g_thread_new("reader", _reader_thread, reader);
+#else
+	reader->thread = g_thread_create(_reader_thread, reader, TRUE, NULL);
+#endif
+	if(reader->thread == NULL)
+	{
+		close(reader->wake[0]);
+		close(reader->wake[1]);
+		g_free(reader->filename);
+		g_free(reader);
+		return NULL;
+	}
+	return reader;
+}
+
+
+/* reader_cut */
+/* returns how much to hand over: up to the last line if requested, or
+ * complete characters */
+static size_t _reader_cut(char const * buf, size_t len, gboolean lines)
+{
+	size_t i;
+
+	if(lines)
+		for(i = len; i > 0; i--)
+			if(buf[i - 1] == '\n')
+				return i;
+	for(i = len; i > 0 && len - i < 4; i--)
+		if((buf[i - 1] & 0xc0) != 0x80)
+		{
+			if(g_utf8_get_char_validated(&buf[i - 1], len - i + 1)
+					== (gunichar)-2)
+				return i - 1;
+			break;
+		}
+	return len;
+}
+
+
+/* reader_map */
+/* indexed here, and handed over to the main loop as it progresses */
+static gboolean _reader_map(Reader * reader)
+{
+	struct stat st;
+	TextMap * tm;
+	gboolean complete = FALSE;
+
+	if(reader->map == 0 || reader->index == NULL
+			|| fstat(reader->fd, &st) != 0
+			|| !S_ISREG(st.st_mode)
+			|| (size_t)st.st_size < reader->map)
+		return FALSE;
+	if((tm = textmap_new(reader->fd)) == NULL)
+		return FALSE;
+	if((reader->tm = textmap_new(reader->fd)) == NULL)
+	{
+		textmap_delete(tm);
+		return FALSE;
+	}
+	reader->indexed = reader->tm;
+	while(!complete && !g_atomic_int_get(&reader->cancel))
+	{
+		complete = textmap_index(tm, READER_INDEX);
+		if(_reader_push(reader, NULL, textmap_get_lines(tm),
+					textmap_take_index(tm)) == FALSE)
+			break;
+	}
+	textmap_delete(tm);
+	return TRUE;
+}
+
+
+/* reader_open */
+static int _reader_open(Reader * reader)
+{
+	int flags;
+
+	/* without waiting for a writer if a FIFO, so that it can still be
+	 * cancelled: it is polled instead */
+	if((reader->fd = open(reader->filename, O_RDONLY | O_NONBLOCK)) < 0
+			|| (flags = fcntl(reader->fd, F_GETFL)) < 0
+			|| fcntl(reader->fd, F_SETFL, flags & ~O_NONBLOCK)
+			!= 0)
+	{
+		g_set_error(&reader->error, G_FILE_ERROR,
+				g_file_error_from_errno(errno), "%s: %s",
+				reader->filename, strerror(errno));
+		if(reader->fd >= 0)
+			close(reader->fd);
+		return -1;
+	}
+	return 0;
+}
+
+
+/* reader_push */
+/* called by the thread, takes ownership of buf or offsets */
+static gboolean _reader_push(Reader * reader, char * buf, size_t len,
+		GArray * offsets)
+{
+	guint head;
+	struct reader_chunk * chunk;
+#if GLIB_CHECK_VERSION(2, 52, 0)
+	char * p;
+
+	/* invalid sequences would not be displayed at all */
+	if(buf != NULL && !g_utf8_validate(buf, len, NULL))
+	{
+		p = g_utf8_make_valid(buf, len);
+		g_free(buf);
+		buf = p;
+		len = strlen(p);
+	}
+#endif
+	head = g_atomic_int_get(&reader->head);
+	while(head - (guint)g_atomic_int_get(&reader->tail)
+			== G_N_ELEMENTS(reader->chunks))
+		if(g_atomic_int_get(&reader->cancel))
+		{
+			g_free(buf);
+			if(offsets != NULL)
+				g_array_free(offsets, TRUE);
+			return FALSE;
+		}
+		else
+			_reader_wait(reader);
+	chunk = &reader->chunks[head % G_N_ELEMENTS(reader->chunks)];
+	chunk->buf = buf;
+	chunk->len = len;
+	chunk->offsets = offsets;
+	/* the chunk is complete before it is published */
+	g_atomic_int_set(&reader->head, head + 1);
+	/* a single notification for every batch */
+	if(g_atomic_int_compare_and_exchange(&reader->notified, 0, 1))
+		g_idle_add(_reader_on_ready, reader);
+	return TRUE;
+}
+
+
+/* reader_read */
+static GIOStatus _reader_read(Reader * reader, char * buf, size_t size,
+		gboolean wait, size_t * len)
+{
+	struct pollfd pfd[2];
+	char c;
+	int res;
+	ssize_t r;
+
+	pfd[0].fd = reader->fd;
+	pfd[0].events = POLLIN;
+	pfd[1].fd = reader->wake[0];
+	pfd[1].events = POLLIN;
+	for(;;)
+	{
+		pfd[0].revents = 0;
+		pfd[1].revents = 0;
+		if((res = poll(pfd, 2, wait ? -1 : 0)) == 0)
+			return G_IO_STATUS_AGAIN;
+		else if(res > 0 && pfd[1].revents != 0)
+		{
+			while(read(reader->wake[0], &c, sizeof(c)) > 0);
+			if(g_atomic_int_get(&reader->cancel))
+				return G_IO_STATUS_AGAIN;
+			if(pfd[0].revents == 0)
+				continue;
+		}
+		if(res > 0 && (r = read(reader->fd, buf, size)) >= 0)
+		{
+			*len = r;
+			return (r > 0) ? G_IO_STATUS_NORMAL : G_IO_STATUS_EOF;
+		}
+		else if(errno == EINTR || errno == EAGAIN)
+			continue;
+		g_set_error(&reader->error, G_FILE_ERROR,
+				g_file_error_from_errno(errno), "%s: %s",
+				(reader->filename != NULL)
+				? reader->filename : "Read error",
+				strerror(errno));
+		return G_IO_STATUS_ERROR;
+	}
+}
+
+
+/* reader_stream */
+static void _reader_stream(Reader * reader)
+{
+	char * buf;
+	char * p;
+	size_t len = 0;
+	size_t r = 0;
+	size_t n;
+	GIOStatus status;
+	gboolean wait = TRUE;
+
+	for(buf = g_malloc(READER_BLOCK); !g_atomic_int_get(&reader->cancel);)
+	{
+		status = _reader_read(reader, &buf[len], READER_BLOCK - len,
+				wait, &r);
+		if(status == G_IO_STATUS_NORMAL)
+		{
+			len += r;
+			/* read on while data is available */
+			wait = FALSE;
+			if(len < READER_BLOCK)
+				continue;
+		}
+		else if(status == G_IO_STATUS_AGAIN)
+			wait = TRUE;
+		/* hand over the complete lines, or what is there */
+		if(status == G_IO_STATUS_EOF || status == G_IO_STATUS_ERROR)
+			n = len;
+		else
+			n = _reader_cut(buf, len, status == G_IO_STATUS_NORMAL);
+		if(n > 0)
+		{
+			p = buf;
+			buf = g_malloc(READER_BLOCK);
+			memcpy(buf, &p[n], len - n);
+			len -= n;
+			if(_reader_push(reader, p, n, NULL) == FALSE)
+				break;
+		}
+		if(status == G_IO_STATUS_EOF || status == G_IO_STATUS_ERROR)
+			break;
+	}
+	g_free(buf);
+}
+
+
+/* reader_wait */
+/* called by the thread while the chunks are all full */
+static void _reader_wait(Reader * reader)
+{
+	struct pollfd pfd;
+	char c;
+
+	pfd.fd = reader->wake[0];
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	g_atomic_int_set(&reader->waiting, 1);
+	/* a chunk may have been consumed in the meantime */
+	if(reader->head - (guint)g_atomic_int_get(&reader->tail)
+			== G_N_ELEMENTS(reader->chunks)
+			&& !g_atomic_int_get(&reader->cancel))
+		poll(&pfd, 1, -1);
+	while(read(reader->wake[0], &c, sizeof(c)) > 0);
+	g_atomic_int_set(&reader->waiting, 0);
+}
+
+
+/* reader_wake */
+/* called by the main loop */
+static void _reader_wake(Reader * reader, gboolean always)
+{
+	char c = '\0';
+
+	if(!always && !g_atomic_int_compare_and_exchange(&reader->waiting, 1,
+				0))
+		return;
+	/* if full, the thread is about to wake up already */
+	while(write(reader->wake[1], &c, sizeof(c)) < 0 && errno == EINTR);
+}
+
+
+/* callbacks */
+/* reader_on_ready */
+static gboolean _reader_on_ready(gpointer data)
+{
+	Reader * reader = data;
+	guint tail;
+	struct reader_chunk * chunk;
+	gboolean ret = TRUE;
+
+	if(reader->paused || reader->done)
+		return FALSE;
+	g_atomic_int_set(&reader->notified, 0);
+	while(ret && (tail = g_atomic_int_get(&reader->tail))
+			!= (guint)g_atomic_int_get(&reader->head))
+	{
+		chunk = &reader->chunks[tail % G_N_ELEMENTS(reader->chunks)];
+		if(chunk->offsets != NULL)
+		{
+			textmap_add_index(reader->indexed, chunk->offsets,
+					chunk->len);
+			chunk->offsets = NULL;
+			reader->index(reader->data);
+		}
+		else if(chunk->buf == NULL)
+		{
+			reader->done = TRUE;
+			reader->callback(NULL, 0, reader->error, reader->data);
+			return FALSE;
+		}
+		else
+		{
+			ret = reader->callback(chunk->buf, chunk->len, NULL,
+					reader->data);
+			g_free(chunk->buf);
+			chunk->buf = NULL;
+		}
+		g_atomic_int_set(&reader->tail, tail + 1);
+		/* paused until reader_resume() otherwise */
+		reader->paused = !ret;
+	}
+	_reader_wake(reader, FALSE);
+	return FALSE;
+}
+
+
+/* reader_thread */
+static gpointer _reader_thread(gpointer data)
+{
+	Reader * reader = data;
+
+	if(reader->filename != NULL && _reader_open(reader) != 0)
+	{
+		_reader_push(reader, NULL, 0, NULL);
+		return NULL;
+	}
+	/* large files are mapped instead */
+	if(!_reader_map(reader))
+		_reader_stream(reader);
+	if(reader->close)
+		close(reader->fd);
+	if(!g_atomic_int_get(&reader->cancel))
+		_reader_push(reader, NULL, 0, NULL);
+	return NULL;
+}
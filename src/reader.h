@@ -0,0 +1,72 @@
+/* gbsddialog */
+/* reader.h */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#ifndef GBSDDIALOG_READER_H
+# define GBSDDIALOG_READER_H
+
+# include <glib.h>
+# include "textmap.h"
+
+
+/* Reader */
+/* types */
+typedef struct _Reader Reader;
+
+/* called in the main loop for every chunk read, ending with complete lines
+ * or characters whenever possible, and once with buf NULL at the end of the
+ * file or on error; returning FALSE pauses until reader_resume() */
+typedef gboolean (*ReaderCallback)(char const * buf, size_t len,
+		GError const * error, gpointer data);
+
+/* called in the main loop for mapped files, every time more lines were
+ * indexed by the thread, before the end */
+typedef void (*ReaderIndexCallback)(gpointer data);
+
+
+/* functions */
+/* regular files from map bytes are mapped instead of read, if not 0 */
+Reader * reader_new_file(char const * filename, size_t map,
+		ReaderCallback callback, ReaderIndexCallback index,
+		gpointer data);
+Reader * reader_new_fd(int fd, gboolean close, ReaderCallback callback,
+		gpointer data);
+void reader_delete(Reader * reader);
+
+/* accessors */
+/* the file mapped if any, to be deleted by the caller after the reader
+ * (the index is extended until then) */
+TextMap * reader_take_map(Reader * reader);
+
+/* useful */
+void reader_resume(Reader * reader);
+
+#endif /* !GBSDDIALOG_READER_H */
@@ -0,0 +1,312 @@
+/* gbsddialog */
+/* textmap.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include "textmap.h"
+
+
+/* TextMap */
+/* private */
+/* types */
+struct _TextMap
+{
+	int fd;
+	size_t size;
+	gboolean truncated;
+	char * buf;			/* read from the file */
+	GString * text;			/* returned by textmap_get_text() */
+
+	/* index */
+	GArray * offsets;		/* every TEXTMAP_STEP lines */
+	guint taken;			/* offsets handed over already */
+	size_t lines;
+	size_t start;			/* of the next line */
+	size_t scanned;
+	gboolean complete;
+};
+
+
+/* constants */
+/* a sparse index keeps the memory used low, at the cost of scanning up to
+ * this many lines again on access */
+#define TEXTMAP_STEP		64
+
+/* longer lines are split, which also bounds the size of the text for a given
+ * number of lines */
+#define TEXTMAP_LINE_MAX	4096
+
+/* read at a time, holding at least a complete line */
+#define TEXTMAP_CHUNK		(1024 * 1024)
+
+
+/* prototypes */
+static size_t _textmap_eol(char const * buf, size_t len, gboolean eof);
+static size_t _textmap_line(TextMap * tm, size_t line);
+static size_t _textmap_read(TextMap * tm, size_t offset, size_t len);
+
+
+/* public */
+/* functions */
+/* textmap_new */
+TextMap * textmap_new(int fd)
+{
+	TextMap * tm;
+	struct stat st;
+	size_t offset = 0;
+
+	/* the file is read instead of mapped, so that truncating it while
+	 * accessed is not fatal (SIGBUS) */
+	if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0
+			|| (fd = dup(fd)) < 0)
+		return NULL;
+	tm = g_new(TextMap, 1);
+	tm->fd = fd;
+	tm->size = st.st_size;
+	tm->truncated = FALSE;
+	tm->buf = g_malloc(TEXTMAP_CHUNK);
+	tm->text = g_string_new(NULL);
+	tm->offsets = g_array_new(FALSE, FALSE, sizeof(size_t));
+	g_array_append_val(tm->offsets, offset);
+	tm->taken = 1;
+	tm->lines = 0;
+	tm->start = 0;
+	tm->scanned = 0;
+	tm->complete = FALSE;
+	return tm;
+}
+
+
+/* textmap_delete */
+void textmap_delete(TextMap * tm)
+{
+	close(tm->fd);
+	g_free(tm->buf);
+	g_string_free(tm->text, TRUE);
+	g_array_free(tm->offsets, TRUE);
+	g_free(tm);
+}
+
+
+/* accessors */
+/* textmap_get_lines */
+size_t textmap_get_lines(TextMap * tm)
+{
+	return tm->lines;
+}
+
+
+/* textmap_get_text */
+char const * textmap_get_text(TextMap * tm, size_t first, size_t last,
+		size_t * len)
+{
+	size_t start;
+	size_t end;
+	size_t l;
+	size_t n;
+	char const * p;
+
+	first = MIN(first, tm->lines);
+	last = MIN(MAX(first, last), tm->lines);
+	start = _textmap_line(tm, first);
+	end = _textmap_line(tm, last);
+	g_string_truncate(tm->text, 0);
+	while(start < end)
+	{
+		if((n = _textmap_read(tm, start, MIN(end - start,
+							TEXTMAP_CHUNK))) == 0)
+			break;
+		for(p = tm->buf; (l = _textmap_eol(p, n - (p - tm->buf),
+						start + n == tm->size)) > 0;
+				p += l)
+		{
+			g_string_append_len(tm->text, p, l);
+			/* the lines split are terminated as well */
+			if(p[l - 1] != '\n' && start + (p - tm->buf) + l
+					< tm->size)
+				g_string_append_c(tm->text, '\n');
+		}
+		if(p == tm->buf)
+			break;
+		start += p - tm->buf;
+	}
+	*len = tm->text->len;
+	return tm->text->str;
+}
+
+
+/* textmap_is_truncated */
+gboolean textmap_is_truncated(TextMap * tm)
+{
+	struct stat st;
+
+	if(!tm->truncated && (fstat(tm->fd, &st) != 0
+				|| st.st_size < (off_t)tm->size))
+		tm->truncated = TRUE;
+	return tm->truncated;
+}
+
+
+/* useful */
+/* textmap_add_index */
+void textmap_add_index(TextMap * tm, GArray * offsets, size_t lines)
+{
+	g_array_append_vals(tm->offsets, offsets->data, offsets->len);
+	g_array_free(offsets, TRUE);
+	tm->lines = lines;
+}
+
+
+/* textmap_index */
+gboolean textmap_index(TextMap * tm, size_t size)
+{
+	size_t target;
+	size_t offset;
+	size_t l;
+	size_t n;
+	char const * p;
+
+	if(tm->complete)
+		return TRUE;
+	/* the line in progress is read again */
+	target = MIN(tm->scanned + size, tm->size);
+	while(tm->start < target)
+	{
+		if((n = _textmap_read(tm, tm->start, MIN(target - tm->start,
+							TEXTMAP_CHUNK))) == 0)
+			break;
+		/* memchr() is usually vectorized */
+		for(p = tm->buf; (l = _textmap_eol(p, n - (p - tm->buf),
+						tm->start + n == tm->size)) > 0;
+				p += l)
+			if(++tm->lines % TEXTMAP_STEP == 0)
+			{
+				offset = tm->start + (p + l - tm->buf);
+				g_array_append_val(tm->offsets, offset);
+			}
+		if(p == tm->buf)
+			break;
+		tm->start += p - tm->buf;
+	}
+	tm->scanned = target;
+	/* what was indexed so far is kept */
+	if(tm->start < tm->size && !tm->truncated)
+		return FALSE;
+	tm->complete = TRUE;
+	return TRUE;
+}
+
+
+/* textmap_take_index */
+GArray * textmap_take_index(TextMap * tm)
+{
+	GArray * offsets;
+
+	offsets = g_array_sized_new(FALSE, FALSE, sizeof(size_t),
+			tm->offsets->len - tm->taken);
+	g_array_append_vals(offsets, &g_array_index(tm->offsets, size_t,
+				tm->taken), tm->offsets->len - tm->taken);
+	tm->taken = tm->offsets->len;
+	return offsets;
+}
+
+
+/* private */
+/* functions */
+/* textmap_eol */
+/* returns the length of the line, newline included, or 0 until known */
+static size_t _textmap_eol(char const * buf, size_t len, gboolean eof)
+{
+	char const * p;
+	size_t l;
+
+	if((p = memchr(buf, '\n', MIN(len, TEXTMAP_LINE_MAX + 1))) != NULL)
+		return p + 1 - buf;
+	if(len <= TEXTMAP_LINE_MAX)
+		return eof ? len : 0;
+	/* split before a UTF-8 continuation byte if possible */
+	for(l = TEXTMAP_LINE_MAX; l > TEXTMAP_LINE_MAX - 3
+			&& ((unsigned char)buf[l] & 0xc0) == 0x80; l--);
+	return (((unsigned char)buf[l] & 0xc0) == 0x80) ? TEXTMAP_LINE_MAX : l;
+}
+
+
+/* textmap_line */
+static size_t _textmap_line(TextMap * tm, size_t line)
+{
+	size_t i;
+	size_t offset;
+	size_t l;
+	size_t n;
+	char const * p;
+
+	offset = g_array_index(tm->offsets, size_t, line / TEXTMAP_STEP);
+	for(i = line - line % TEXTMAP_STEP; i < line; offset += p - tm->buf)
+	{
+		if((n = _textmap_read(tm, offset, MIN(tm->size - offset,
+							TEXTMAP_CHUNK))) == 0)
+			break;
+		for(p = tm->buf; i < line && (l = _textmap_eol(p,
+						n - (p - tm->buf),
+						offset + n == tm->size)) > 0;
+				p += l, i++);
+		if(p == tm->buf)
+			break;
+	}
+	return offset;
+}
+
+
+/* textmap_read */
+/* returns the amount read, the file was truncated if short */
+static size_t _textmap_read(TextMap * tm, size_t offset, size_t len)
+{
+	size_t ret;
+	ssize_t res;
+
+	for(ret = 0; ret < len; ret += res)
+		if((res = pread(tm->fd, &tm->buf[ret], len - ret,
+						offset + ret)) <= 0)
+		{
+			if(res < 0 && errno == EINTR)
+			{
+				res = 0;
+				continue;
+			}
+			tm->truncated = TRUE;
+			break;
+		}
+	return ret;
+}
@@ -0,0 +1,70 @@
+/* gbsddialog */
+/* textmap.h */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+
+#ifndef GBSDDIALOG_TEXTMAP_H
+# define GBSDDIALOG_TEXTMAP_H
+
+# include <glib.h>
+
+
+/* TextMap */
+/* types */
+typedef struct _TextMap TextMap;
+
+
+/* functions */
+/* indexes the file open as fd, which can be closed afterwards */
+TextMap * textmap_new(int fd);
+void textmap_delete(TextMap * tm);
+
+/* accessors */
+/* the lines indexed so far */
+size_t textmap_get_lines(TextMap * tm);
+/* returns lines first to last (excluded) in the file, valid until the next
+ * call; the lines too long are split */
+char const * textmap_get_text(TextMap * tm, size_t first, size_t last,
+		size_t * len);
+/* TRUE once the file is found shorter than indexed; the text is incomplete
+ * then */
+gboolean textmap_is_truncated(TextMap * tm);
+
+/* useful */
+/* extends the index with what textmap_take_index() returned for the same
+ * file, possibly from another thread */
+void textmap_add_index(TextMap * tm, GArray * offsets, size_t lines);
+/* indexes up to size more bytes, returns TRUE once complete */
+gboolean textmap_index(TextMap * tm, size_t size);
+/* what was indexed since the last call, to be handed over to
+ * textmap_add_index() */
+GArray * textmap_take_index(TextMap * tm);
+
+#endif /* !GBSDDIALOG_TEXTMAP_H */
@@ -0,0 +1,987 @@
+/* gbsddialog */
+/* bench.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "../src/gaugeparser.c"
+#include "../src/liststore.c"
+#include "../src/menumodel.c"
+#include "../src/reader.c"
+#include "../src/textmap.c"
+
+
+/* bench */
+/* private */
+/* types */
+typedef struct _Bench
+{
+	char const * name;
+	void (*callback)(void);
+} Bench;
+
+typedef enum _BulkMove
+{
+	BM_REFERENCES = 0,
+	BM_SELECTED,
+	BM_ALL
+} BulkMove;
+
+struct pipe_data
+{
+	GMainLoop * loop;
+	int fd;
+	size_t size;
+	gint64 tick;
+	gint64 stall;
+};
+
+struct scroll_data
+{
+	GtkWidget * view;
+	GMainLoop * loop;
+	unsigned int frames;
+	gint64 total;
+	gint64 max;
+};
+
+
+/* constants */
+#define BENCH_TREE_ITEMS	100000
+#define BENCH_TREE_WALK		10000		/* the quadratic walk */
+#define BENCH_ROWS_WIDTH	640
+#define BENCH_ROWS_HEIGHT	480
+#define BENCH_SCROLL_ITEMS	1000000
+#define BENCH_SCROLL_FRAMES	200
+#define BENCH_RADIO_ITEMS	100000
+#define BENCH_RADIO_WALK	1000		/* toggles walking the items */
+#define BENCH_BULK_ITEMS	50000
+#define BENCH_BULK_MOVE		10000		/* rows moved */
+#define BENCH_GAUGE_RECORDS	1000000
+#define BENCH_GAUGE_WRITE	4096		/* bytes per write */
+#define BENCH_READER_SIZE	1048576
+#define BENCH_READER_WRITE	512		/* bytes per write */
+#define BENCH_READER_DELAY	1000		/* in us between writes */
+#define BENCH_READER_TICK	10		/* in ms, as for frames */
+
+
+/* prototypes */
+static int _usage(void);
+
+static struct bsddialog_menuitem * _bench_items(unsigned int count,
+		gboolean tree);
+static void _bench_items_delete(struct bsddialog_menuitem * items,
+		unsigned int count);
+static gboolean _bench_display(void);
+static void _bench_print(char const * name, unsigned int count,
+		gint64 start);
+
+static void _bench_tree(void);
+static void _bench_rows(void);
+static void _bench_scroll(void);
+static void _bench_radio(void);
+static void _bench_bulk(void);
+static void _bench_gauge(void);
+static void _bench_reader(void);
+
+
+/* variables */
+static const Bench _bench[] =
+{
+	{ "tree",	_bench_tree	},
+	{ "rows",	_bench_rows	},
+	{ "scroll",	_bench_scroll	},
+	{ "radio",	_bench_radio	},
+	{ "bulk",	_bench_bulk	},
+	{ "gauge",	_bench_gauge	},
+	{ "reader",	_bench_reader	}
+};
+
+
+/* functions */
+/* main */
+int main(int argc, char * argv[])
+{
+	size_t i;
+	int j;
+
+	for(j = 1; j < argc; j++)
+	{
+		for(i = 0; i < sizeof(_bench) / sizeof(*_bench); i++)
+			if(strcmp(argv[j], _bench[i].name) == 0)
+				break;
+		if(i == sizeof(_bench) / sizeof(*_bench))
+			return _usage();
+	}
+	for(i = 0; i < sizeof(_bench) / sizeof(*_bench); i++)
+	{
+		for(j = 1; j < argc; j++)
+			if(strcmp(argv[j], _bench[i].name) == 0)
+				break;
+		if(argc == 1 || j < argc)
+			_bench[i].callback();
+	}
+	return 0;
+}
+
+
+/* usage */
+static int _usage(void)
+{
+	size_t i;
+
+	fputs("usage: bench3 [benchmark...]\n", stderr);
+	for(i = 0; i < sizeof(_bench) / sizeof(*_bench); i++)
+		fprintf(stderr, "       %s\n", _bench[i].name);
+	return 1;
+}
+
+
+/* bench_items */
+static struct bsddialog_menuitem * _bench_items(unsigned int count,
+		gboolean tree)
+{
+	struct bsddialog_menuitem * items;
+	unsigned int i;
+
+	/* a root every 100 items, each with 10 children of 9 leaves */
+	items = g_new0(struct bsddialog_menuitem, count);
+	for(i = 0; i < count; i++)
+	{
+		items[i].prefix = "";
+		if(tree)
+			items[i].depth = (i % 100 == 0) ? 0
+				: ((i % 10 == 1) ? 1 : 2);
+		items[i].name = g_strdup_printf("item%u", i);
+		items[i].desc = g_strdup_printf("Description of item %u", i);
+		items[i].bottomdesc = "";
+	}
+	return items;
+}
+
+
+/* bench_items_delete */
+static void _bench_items_delete(struct bsddialog_menuitem * items,
+		unsigned int count)
+{
+	unsigned int i;
+
+	for(i = 0; i < count; i++)
+	{
+		g_free((char *)items[i].name);
+		g_free((char *)items[i].desc);
+	}
+	g_free(items);
+}
+
+
+/* bench_display */
+static gboolean _bench_display(void)
+{
+	static int display = -1;
+
+	if(display < 0)
+		display = gtk_init_check(NULL, NULL) ? 1 : 0;
+	return display ? TRUE : FALSE;
+}
+
+
+/* bench_print */
+static void _bench_print(char const * name, unsigned int count,
+		gint64 start)
+{
+	printf("%-32s %8u %12.3f ms\n", name, count,
+			(g_get_monotonic_time() - start) / 1000.0);
+}
+
+
+/* benchmarks */
+/* bench_tree */
+static GtkTreeStore * _tree_store(void);
+static GtkTreeIter * _tree_walk_parent(GtkTreeModel * model,
+		GtkTreeIter * parent, unsigned int depth);
+
+static void _bench_tree(void)
+{
+	struct bsddialog_menuitem * items;
+	GtkTreeStore * store;
+	GtkTreeIter iter, parent, * pparent;
+	GtkTreeIter stack[3];
+	MenuModel * model;
+	unsigned int i;
+	gint64 start;
+
+	items = _bench_items(BENCH_TREE_ITEMS, TRUE);
+	/* before: the parent looked up among the rows for every item */
+	store = _tree_store();
+	start = g_get_monotonic_time();
+	for(i = 0; i < BENCH_TREE_WALK; i++)
+	{
+		pparent = _tree_walk_parent(GTK_TREE_MODEL(store), &parent,
+				items[i].depth);
+		gtk_tree_store_insert_with_values(store, &iter, pparent, -1,
+				MMC_DEPTH, items[i].depth,
+				MMC_NAME, items[i].name,
+				MMC_DESCRIPTION, items[i].desc, -1);
+	}
+	_bench_print("tree (walk)", BENCH_TREE_WALK, start);
+	g_object_unref(store);
+	/* a stack of the rows last inserted at each depth */
+	store = _tree_store();
+	start = g_get_monotonic_time();
+	for(i = 0; i < BENCH_TREE_ITEMS; i++)
+	{
+		pparent = (items[i].depth > 0) ? &stack[items[i].depth - 1]
+			: NULL;
+		gtk_tree_store_insert_with_values(store, &iter, pparent, -1,
+				MMC_DEPTH, items[i].depth,
+				MMC_NAME, items[i].name,
+				MMC_DESCRIPTION, items[i].desc, -1);
+		stack[items[i].depth] = iter;
+	}
+	_bench_print("tree (stack)", BENCH_TREE_ITEMS, start);
+	g_object_unref(store);
+	/* after: the items linked once by the MenuModel */
+	start = g_get_monotonic_time();
+	model = menumodel_new(items, BENCH_TREE_ITEMS, TRUE);
+	_bench_print("tree (MenuModel)", BENCH_TREE_ITEMS, start);
+	g_object_unref(model);
+	_bench_items_delete(items, BENCH_TREE_ITEMS);
+}
+
+static GtkTreeStore * _tree_store(void)
+{
+	return gtk_tree_store_new(MMC_COUNT, G_TYPE_STRING, G_TYPE_BOOLEAN,
+			G_TYPE_INT, G_TYPE_STRING, G_TYPE_STRING,
+			G_TYPE_STRING);
+}
+
+static GtkTreeIter * _tree_walk_parent(GtkTreeModel * model,
+		GtkTreeIter * parent, unsigned int depth)
+{
+	GtkTreeIter * ret = NULL;
+	GtkTreeIter iter, child;
+	gboolean valid;
+
+	/* the last row with a lower depth, as found before */
+	if(depth == 0)
+		return NULL;
+	for(valid = gtk_tree_model_get_iter_first(model, &iter); valid == TRUE;
+			valid = gtk_tree_model_iter_next(model, &iter))
+	{
+		*parent = iter;
+		ret = parent;
+		if(depth > 1 && gtk_tree_model_iter_nth_child(model, &child,
+					&iter, gtk_tree_model_iter_n_children(
+						model, &iter) - 1))
+			*parent = child;
+	}
+	return ret;
+}
+
+
+/* bench_rows */
+static GtkWidget * _rows_view(gboolean fixed);
+static void _rows_frame(GtkWidget * view, char const * name,
+		unsigned int count, gint64 start);
+static gboolean _rows_on_draw(GtkWidget * widget, gpointer context,
+		gpointer data);
+
+static void _bench_rows(void)
+{
+	const unsigned int counts[] = { 10000, 100000, 1000000 };
+	struct bsddialog_menuitem * items;
+	GtkTreeStore * store;
+	GtkTreeIter iter;
+	GtkWidget * view = NULL;
+	MenuModel * model;
+	unsigned int count, i;
+	size_t j;
+	gint64 start;
+
+	/* until the first frame is drawn if possible, the models only
+	 * otherwise */
+	printf("rows: %s\n", _bench_display() ? "until the first frame"
+			: "no display, the models only");
+	for(j = 0; j < sizeof(counts) / sizeof(*counts); j++)
+	{
+		count = counts[j];
+		items = _bench_items(count, FALSE);
+		/* before: rows appended then set while attached */
+		start = g_get_monotonic_time();
+		store = _tree_store();
+		if(_bench_display())
+		{
+			view = _rows_view(FALSE);
+			gtk_tree_view_set_model(GTK_TREE_VIEW(view),
+					GTK_TREE_MODEL(store));
+		}
+		for(i = 0; i < count; i++)
+		{
+			gtk_tree_store_append(store, &iter, NULL);
+			gtk_tree_store_set(store, &iter,
+					MMC_DEPTH, items[i].depth,
+					MMC_NAME, items[i].name,
+					MMC_DESCRIPTION, items[i].desc, -1);
+		}
+		_rows_frame(view, "rows (append)", count, start);
+		g_object_unref(store);
+		/* rows inserted with their values while detached */
+		start = g_get_monotonic_time();
+		store = _tree_store();
+		for(i = 0; i < count; i++)
+			gtk_tree_store_insert_with_values(store, &iter, NULL,
+					-1, MMC_DEPTH, items[i].depth,
+					MMC_NAME, items[i].name,
+					MMC_DESCRIPTION, items[i].desc, -1);
+		if(_bench_display())
+		{
+			view = _rows_view(TRUE);
+			gtk_tree_view_set_model(GTK_TREE_VIEW(view),
+					GTK_TREE_MODEL(store));
+		}
+		_rows_frame(view, "rows (insert)", count, start);
+		g_object_unref(store);
+		/* after: the items wrapped by the MenuModel */
+		start = g_get_monotonic_time();
+		model = menumodel_new(items, count, FALSE);
+		if(_bench_display())
+		{
+			view = _rows_view(TRUE);
+			gtk_tree_view_set_model(GTK_TREE_VIEW(view),
+					GTK_TREE_MODEL(model));
+		}
+		_rows_frame(view, "rows (MenuModel)", count, start);
+		g_object_unref(model);
+		_bench_items_delete(items, count);
+	}
+}
+
+static GtkWidget * _rows_view(gboolean fixed)
+{
+	GtkWidget * window;
+	GtkWidget * widget;
+	GtkWidget * view;
+	GtkCellRenderer * renderer;
+	GtkTreeViewColumn * column;
+	gint i;
+
+	window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+	gtk_window_set_default_size(GTK_WINDOW(window), BENCH_ROWS_WIDTH,
+			BENCH_ROWS_HEIGHT);
+	widget = gtk_scrolled_window_new(NULL, NULL);
+	view = gtk_tree_view_new();
+	renderer = gtk_cell_renderer_text_new();
+	column = gtk_tree_view_column_new_with_attributes(NULL, renderer,
+			"text", MMC_NAME, NULL);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(view), column);
+	renderer = gtk_cell_renderer_text_new();
+	column = gtk_tree_view_column_new_with_attributes(NULL, renderer,
+			"text", MMC_DESCRIPTION, NULL);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(view), column);
+	/* as set up by the builders for the large lists */
+	for(i = 0; fixed && (column = gtk_tree_view_get_column(
+					GTK_TREE_VIEW(view), i)) != NULL; i++)
+	{
+		gtk_tree_view_column_set_sizing(column,
+				GTK_TREE_VIEW_COLUMN_FIXED);
+		gtk_tree_view_column_set_fixed_width(column,
+				BENCH_ROWS_WIDTH / 2);
+	}
+	if(fixed)
+		gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(view), TRUE);
+	gtk_container_add(GTK_CONTAINER(widget), view);
+	gtk_container_add(GTK_CONTAINER(window), widget);
+	return view;
+}
+
+static void _rows_frame(GtkWidget * view, char const * name,
+		unsigned int count, gint64 start)
+{
+	GMainLoop * loop;
+
+	if(view == NULL)
+	{
+		_bench_print(name, count, start);
+		return;
+	}
+	loop = g_main_loop_new(NULL, FALSE);
+#if GTK_CHECK_VERSION(3, 0, 0)
+	g_signal_connect_after(view, "draw", G_CALLBACK(_rows_on_draw), loop);
+#else
+	g_signal_connect_after(view, "expose-event", G_CALLBACK(_rows_on_draw),
+			loop);
+#endif
+	gtk_widget_show_all(gtk_widget_get_toplevel(view));
+	g_main_loop_run(loop);
+	_bench_print(name, count, start);
+	gtk_widget_destroy(gtk_widget_get_toplevel(view));
+	g_main_loop_unref(loop);
+}
+
+static gboolean _rows_on_draw(GtkWidget * widget, gpointer context,
+		gpointer data)
+{
+	GMainLoop * loop = data;
+	(void) widget;
+	(void) context;
+
+	g_main_loop_quit(loop);
+	return FALSE;
+}
+
+
+/* bench_scroll */
+static void _scroll_frame(struct scroll_data * sd, gint64 start);
+static void _scroll_print(struct scroll_data * sd, char const * name);
+
+static void _bench_scroll(void)
+{
+	struct bsddialog_menuitem * items;
+	MenuModel * model;
+	struct scroll_data sd;
+	GtkAdjustment * adjustment;
+	GtkTreePath * path;
+	gdouble range;
+	unsigned int i;
+	gint64 start;
+
+	if(!_bench_display())
+	{
+		fputs("bench3: scroll: No display available\n", stderr);
+		return;
+	}
+	items = _bench_items(BENCH_SCROLL_ITEMS, FALSE);
+	start = g_get_monotonic_time();
+	model = menumodel_new(items, BENCH_SCROLL_ITEMS, FALSE);
+	sd.view = _rows_view(TRUE);
+	gtk_tree_view_set_model(GTK_TREE_VIEW(sd.view), GTK_TREE_MODEL(model));
+	sd.loop = g_main_loop_new(NULL, FALSE);
+#if GTK_CHECK_VERSION(3, 0, 0)
+	g_signal_connect_after(sd.view, "draw", G_CALLBACK(_rows_on_draw),
+			sd.loop);
+	adjustment = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(sd.view));
+#else
+	g_signal_connect_after(sd.view, "expose-event",
+			G_CALLBACK(_rows_on_draw), sd.loop);
+	adjustment = gtk_tree_view_get_vadjustment(GTK_TREE_VIEW(sd.view));
+#endif
+	gtk_widget_show_all(gtk_widget_get_toplevel(sd.view));
+	g_main_loop_run(sd.loop);
+	_bench_print("scroll (first frame)", BENCH_SCROLL_ITEMS, start);
+	sd.frames = 0;
+	sd.total = 0;
+	sd.max = 0;
+	/* a page at a time, as with the keyboard or the wheel */
+	for(i = 0; i < BENCH_SCROLL_FRAMES; i++)
+	{
+		start = g_get_monotonic_time();
+		gtk_adjustment_set_value(adjustment,
+				gtk_adjustment_get_value(adjustment)
+				+ gtk_adjustment_get_page_size(adjustment));
+		_scroll_frame(&sd, start);
+	}
+	_scroll_print(&sd, "scroll (pages)");
+	/* across the whole list, as when dragging the scrollbar */
+	range = gtk_adjustment_get_upper(adjustment)
+		- gtk_adjustment_get_page_size(adjustment);
+	for(i = 0; i < BENCH_SCROLL_FRAMES; i++)
+	{
+		start = g_get_monotonic_time();
+		gtk_adjustment_set_value(adjustment,
+				range * (BENCH_SCROLL_FRAMES - i)
+				/ BENCH_SCROLL_FRAMES);
+		_scroll_frame(&sd, start);
+	}
+	_scroll_print(&sd, "scroll (drag)");
+	/* the cursor moved down, then across the whole list */
+	for(i = 0; i < BENCH_SCROLL_FRAMES; i++)
+	{
+		start = g_get_monotonic_time();
+		path = gtk_tree_path_new_from_indices(i, -1);
+		gtk_tree_view_set_cursor(GTK_TREE_VIEW(sd.view), path, NULL,
+				FALSE);
+		gtk_tree_path_free(path);
+		_scroll_frame(&sd, start);
+	}
+	_scroll_print(&sd, "scroll (cursor)");
+	for(i = 0; i < BENCH_SCROLL_FRAMES; i++)
+	{
+		start = g_get_monotonic_time();
+		path = gtk_tree_path_new_from_indices(i * (BENCH_SCROLL_ITEMS
+					/ BENCH_SCROLL_FRAMES) * 37
+				% BENCH_SCROLL_ITEMS, -1);
+		gtk_tree_view_set_cursor(GTK_TREE_VIEW(sd.view), path, NULL,
+				FALSE);
+		gtk_tree_path_free(path);
+		_scroll_frame(&sd, start);
+	}
+	_scroll_print(&sd, "scroll (cursor jumps)");
+	gtk_widget_destroy(gtk_widget_get_toplevel(sd.view));
+	g_main_loop_unref(sd.loop);
+	g_object_unref(model);
+	_bench_items_delete(items, BENCH_SCROLL_ITEMS);
+}
+
+static void _scroll_frame(struct scroll_data * sd, gint64 start)
+{
+	gint64 frame;
+
+	/* until the view is drawn again */
+	gtk_widget_queue_draw(sd->view);
+	g_main_loop_run(sd->loop);
+	frame = g_get_monotonic_time() - start;
+	sd->frames++;
+	sd->total += frame;
+	if(frame > sd->max)
+		sd->max = frame;
+}
+
+static void _scroll_print(struct scroll_data * sd, char const * name)
+{
+	printf("%-32s %8u %12.3f ms/frame (%.3f ms max)\n", name,
+			sd->frames, sd->total / 1000.0 / sd->frames,
+			sd->max / 1000.0);
+	sd->frames = 0;
+	sd->total = 0;
+	sd->max = 0;
+}
+
+/* bench_radio */
+static int _radio_walk(MenuModel * model, unsigned int row);
+
+static void _bench_radio(void)
+{
+	struct bsddialog_menuitem * items;
+	MenuModel * model;
+	GtkTreeIter iter;
+	unsigned int i, row;
+	int radio = -1;
+	gint64 start;
+
+	/* toggles spread across the list, the selection read every time */
+	items = _bench_items(BENCH_RADIO_ITEMS, FALSE);
+	model = menumodel_new(items, BENCH_RADIO_ITEMS, FALSE);
+	/* before: the other items cleared and the selection looked up by
+	 * walking the items */
+	start = g_get_monotonic_time();
+	for(i = 0; i < BENCH_RADIO_WALK; i++)
+	{
+		row = (i * 7919) % BENCH_RADIO_ITEMS;
+		radio = _radio_walk(model, row);
+	}
+	_bench_print("radio (walk)", BENCH_RADIO_WALK, start);
+	/* after: the item set tracked by the MenuModel */
+	menumodel_set_radiolist(model);
+	start = g_get_monotonic_time();
+	for(i = 0; i < BENCH_RADIO_ITEMS; i++)
+	{
+		row = (i * 7919) % BENCH_RADIO_ITEMS;
+		if(menumodel_get_iter(model, &iter, row))
+			menumodel_set_radio(model, &iter);
+		radio = menumodel_get_radio(model);
+	}
+	_bench_print("radio (MenuModel)", BENCH_RADIO_ITEMS, start);
+	if(radio != (int)row)
+		fprintf(stderr, "radio: %d instead of %u\n", radio, row);
+	g_object_unref(model);
+	_bench_items_delete(items, BENCH_RADIO_ITEMS);
+}
+
+static int _radio_walk(MenuModel * model, unsigned int row)
+{
+	struct bsddialog_menuitem * items;
+	GtkTreeIter iter;
+	unsigned int i;
+
+	items = menumodel_get_items(model);
+	for(i = 0; i < BENCH_RADIO_ITEMS; i++)
+		if(items[i].on && i != row
+				&& menumodel_get_iter(model, &iter, i))
+			menumodel_set(model, &iter, FALSE);
+	if(menumodel_get_iter(model, &iter, row))
+		menumodel_set(model, &iter, TRUE);
+	for(i = 0; i < BENCH_RADIO_ITEMS; i++)
+		if(items[i].on)
+			return i;
+	return -1;
+}
+
+
+/* bench_bulk */
+static GtkListStore * _bulk_store(struct bsddialog_menuitem * items,
+		unsigned int count);
+static void _bulk_move(struct bsddialog_menuitem * items, BulkMove move,
+		char const * name);
+static void _bulk_move_references(GtkListStore * from, GtkListStore * to,
+		unsigned int count);
+static void _bulk_views(GtkListStore * lstore, GtkListStore * rstore,
+		GtkWidget ** lview, GtkWidget ** rview);
+
+static void _bench_bulk(void)
+{
+	struct bsddialog_menuitem * items;
+	MenuModel * model;
+	GtkTreeIter iter, first, last;
+	unsigned int i;
+	gint64 start;
+
+	items = _bench_items(BENCH_BULK_ITEMS, FALSE);
+	/* before: checklist items toggled one at a time */
+	model = menumodel_new(items, BENCH_BULK_ITEMS, FALSE);
+	start = g_get_monotonic_time();
+	for(i = 0; i < BENCH_BULK_ITEMS; i++)
+		if(menumodel_get_iter(model, &iter, i))
+			menumodel_set(model, &iter, TRUE);
+	_bench_print("bulk (toggle)", BENCH_BULK_ITEMS, start);
+	/* after: every range set at once */
+	start = g_get_monotonic_time();
+	menumodel_set_range(model, NULL, NULL, MMS_UNSET);
+	_bench_print("bulk (none)", BENCH_BULK_ITEMS, start);
+	start = g_get_monotonic_time();
+	menumodel_set_range(model, NULL, NULL, MMS_SET);
+	_bench_print("bulk (all)", BENCH_BULK_ITEMS, start);
+	start = g_get_monotonic_time();
+	menumodel_set_range(model, NULL, NULL, MMS_INVERT);
+	_bench_print("bulk (invert)", BENCH_BULK_ITEMS, start);
+	menumodel_get_iter(model, &first, BENCH_BULK_ITEMS / 5);
+	menumodel_get_iter(model, &last, BENCH_BULK_ITEMS * 4 / 5);
+	start = g_get_monotonic_time();
+	menumodel_set_range(model, &first, &last, MMS_SET);
+	_bench_print("bulk (range)", BENCH_BULK_ITEMS * 3 / 5 + 1, start);
+	g_object_unref(model);
+	/* before: buildlist rows moved one at a time by reference, while
+	 * the views are attached if possible */
+	_bulk_move(items, BM_REFERENCES, "bulk (move by reference)");
+	/* after: as the buildlist, with liststore_move() */
+	_bulk_move(items, BM_SELECTED, "bulk (move selected)");
+	_bulk_move(items, BM_ALL, "bulk (move all)");
+	_bench_items_delete(items, BENCH_BULK_ITEMS);
+}
+
+static GtkListStore * _bulk_store(struct bsddialog_menuitem * items,
+		unsigned int count)
+{
+	GtkListStore * store;
+	GtkTreeIter iter;
+	unsigned int i;
+
+	store = gtk_list_store_new(MMC_COUNT, G_TYPE_STRING, G_TYPE_BOOLEAN,
+			G_TYPE_INT, G_TYPE_STRING, G_TYPE_STRING,
+			G_TYPE_STRING);
+	for(i = 0; i < count; i++)
+		gtk_list_store_insert_with_values(store, &iter, -1,
+				MMC_NAME, items[i].name,
+				MMC_DESCRIPTION, items[i].desc, -1);
+	return store;
+}
+
+static void _bulk_move(struct bsddialog_menuitem * items, BulkMove move,
+		char const * name)
+{
+	GtkListStore * lstore, * rstore;
+	GtkWidget * lview = NULL, * rview = NULL;
+	GList * rows = NULL;
+	unsigned int i;
+	gint64 start;
+
+	lstore = _bulk_store(items, BENCH_BULK_MOVE);
+	rstore = _bulk_store(NULL, 0);
+	_bulk_views(lstore, rstore, &lview, &rview);
+	/* every row selected, as obtained from the selection */
+	if(move == BM_SELECTED)
+		for(i = BENCH_BULK_MOVE; i > 0; i--)
+			rows = g_list_prepend(rows,
+					gtk_tree_path_new_from_indices(i - 1,
+						-1));
+	start = g_get_monotonic_time();
+	if(move == BM_REFERENCES)
+		_bulk_move_references(lstore, rstore, BENCH_BULK_MOVE);
+	else
+		liststore_move(lstore, rstore, rows,
+				(lview != NULL) ? GTK_TREE_VIEW(lview) : NULL,
+				(rview != NULL) ? GTK_TREE_VIEW(rview) : NULL);
+	_bench_print(name, BENCH_BULK_MOVE, start);
+	g_list_foreach(rows, (GFunc)gtk_tree_path_free, NULL);
+	g_list_free(rows);
+	if(lview != NULL)
+		gtk_widget_destroy(gtk_widget_get_toplevel(lview));
+	if(rview != NULL)
+		gtk_widget_destroy(gtk_widget_get_toplevel(rview));
+	g_object_unref(lstore);
+	g_object_unref(rstore);
+}
+
+static void _bulk_move_references(GtkListStore * from, GtkListStore * to,
+		unsigned int count)
+{
+	GList * rows = NULL, * row;
+	GtkTreePath * path;
+	GtkTreeIter iter;
+	unsigned int i;
+	gchar * name;
+	gchar * desc;
+
+	for(i = 0; i < count; i++)
+	{
+		path = gtk_tree_path_new_from_indices(i, -1);
+		rows = g_list_prepend(rows, gtk_tree_row_reference_new(
+					GTK_TREE_MODEL(from), path));
+		gtk_tree_path_free(path);
+	}
+	rows = g_list_reverse(rows);
+	for(row = rows; row != NULL; row = row->next)
+	{
+		if((path = gtk_tree_row_reference_get_path(row->data)) == NULL)
+			continue;
+		gtk_tree_model_get_iter(GTK_TREE_MODEL(from), &iter, path);
+		gtk_tree_path_free(path);
+		gtk_tree_model_get(GTK_TREE_MODEL(from), &iter,
+				MMC_NAME, &name, MMC_DESCRIPTION, &desc, -1);
+		gtk_list_store_remove(from, &iter);
+		gtk_list_store_insert_with_values(to, &iter, -1,
+				MMC_NAME, name, MMC_DESCRIPTION, desc, -1);
+		g_free(name);
+		g_free(desc);
+	}
+	g_list_foreach(rows, (GFunc)gtk_tree_row_reference_free, NULL);
+	g_list_free(rows);
+}
+
+static void _bulk_views(GtkListStore * lstore, GtkListStore * rstore,
+		GtkWidget ** lview, GtkWidget ** rview)
+{
+	if(!_bench_display())
+		return;
+	*lview = _rows_view(FALSE);
+	gtk_tree_view_set_model(GTK_TREE_VIEW(*lview), GTK_TREE_MODEL(lstore));
+	gtk_widget_show_all(gtk_widget_get_toplevel(*lview));
+	*rview = _rows_view(FALSE);
+	gtk_tree_view_set_model(GTK_TREE_VIEW(*rview), GTK_TREE_MODEL(rstore));
+	gtk_widget_show_all(gtk_widget_get_toplevel(*rview));
+}
+
+
+/* bench_gauge */
+static void _gauge_feed(GaugeParserMode mode, GString * input, size_t size,
+		char const * name);
+
+static void _bench_gauge(void)
+{
+	GString * input;
+	unsigned int i;
+
+	/* before: the classic blocks, written a line at a time (as echoed
+	 * from a shell) or in larger writes */
+	input = g_string_sized_new(BENCH_GAUGE_RECORDS * 32);
+	for(i = 0; i < BENCH_GAUGE_RECORDS; i++)
+		g_string_append_printf(input, "XXX\n%u\nRecord %u\nXXX\n",
+				i % 101, i);
+	_gauge_feed(GPM_GAUGE, input, 0, "gauge (XXX, lines)");
+	_gauge_feed(GPM_GAUGE, input, BENCH_GAUGE_WRITE, "gauge (XXX, 4 KiB)");
+	/* after: the compact records, written in batches */
+	g_string_truncate(input, 0);
+	for(i = 0; i < BENCH_GAUGE_RECORDS; i++)
+		g_string_append_printf(input, "P %u\nT Record %u\n", i % 101,
+				i);
+	_gauge_feed(GPM_GAUGE_COMPACT, input, 0, "gauge (compact, lines)");
+	_gauge_feed(GPM_GAUGE_COMPACT, input, BENCH_GAUGE_WRITE,
+			"gauge (compact, 4 KiB)");
+	g_string_free(input, TRUE);
+}
+
+static void _gauge_feed(GaugeParserMode mode, GString * input, size_t size,
+		char const * name)
+{
+	GaugeParser * parser;
+	char const * p;
+	char const * q;
+	size_t len;
+	unsigned int updates = 0;
+	gint64 start;
+
+	/* every line separately if size is 0, otherwise in writes of size
+	 * bytes; the changes are applied once per write */
+	parser = gaugeparser_new(mode, "XXX", 0);
+	start = g_get_monotonic_time();
+	for(p = input->str; p < input->str + input->len; p += len)
+	{
+		if(size == 0)
+			len = ((q = strchr(p, '\n')) != NULL) ? (size_t)(q - p)
+				+ 1 : strlen(p);
+		else
+			len = MIN(size, input->len - (size_t)(p - input->str));
+		if(gaugeparser_feed(parser, p, len) != GPC_NONE)
+			updates++;
+	}
+	_bench_print(name, BENCH_GAUGE_RECORDS, start);
+	printf("%-32s %8u updates\n", "", updates);
+	if(gaugeparser_get_percentage(parser) != (BENCH_GAUGE_RECORDS - 1)
+			% 101)
+		fprintf(stderr, "gauge: %u instead of %u\n",
+				gaugeparser_get_percentage(parser),
+				(BENCH_GAUGE_RECORDS - 1) % 101);
+	gaugeparser_delete(parser);
+}
+
+
+/* bench_reader */
+static void _pipe_run(gboolean thread, char const * name);
+
+static gboolean _pipe_on_can_read(GIOChannel * channel,
+		GIOCondition condition, gpointer data);
+static gboolean _pipe_on_read(char const * buf, size_t len,
+		GError const * error, gpointer data);
+static gboolean _pipe_on_tick(gpointer data);
+static gpointer _pipe_writer(gpointer data);
+
+static void _bench_reader(void)
+{
+	/* a slow pipe as a stand-in for slow storage */
+	_pipe_run(FALSE, "reader (watch)");
+	_pipe_run(TRUE, "reader (thread)");
+}
+
+static void _pipe_run(gboolean thread, char const * name)
+{
+	struct pipe_data pd;
+	int fds[2];
+	GThread * writer;
+	GIOChannel * channel = NULL;
+	Reader * reader = NULL;
+	guint id;
+	gint64 start;
+
+	if(pipe(fds) != 0)
+	{
+		perror("pipe");
+		return;
+	}
+	pd.loop = g_main_loop_new(NULL, FALSE);
+	pd.fd = fds[1];
+	pd.size = 0;
+	pd.stall = 0;
+	pd.tick = start = g_get_monotonic_time();
+	writer = g_thread_new("writer", _pipe_writer, &pd);
+	if(thread)
+		/* after: read in a thread of its own */
+		reader = reader_new_fd(fds[0], TRUE, _pipe_on_read, &pd);
+	else
+	{
+		/* before: read from a watch in the main loop, as the text
+		 * boxes used to */
+		channel = g_io_channel_unix_new(fds[0]);
+		g_io_channel_set_close_on_unref(channel, TRUE);
+		g_io_add_watch(channel, G_IO_IN | G_IO_HUP,
+				_pipe_on_can_read, &pd);
+	}
+	id = g_timeout_add(BENCH_READER_TICK, _pipe_on_tick, &pd);
+	g_main_loop_run(pd.loop);
+	_bench_print(name, BENCH_READER_SIZE, start);
+	printf("%-32s %8s %12.3f ms between frames at most\n", "", "",
+			pd.stall / 1000.0);
+	if(pd.size != BENCH_READER_SIZE)
+		fprintf(stderr, "reader: %lu bytes instead of %u\n",
+				(unsigned long)pd.size, BENCH_READER_SIZE);
+	g_source_remove(id);
+	g_thread_join(writer);
+	if(reader != NULL)
+		reader_delete(reader);
+	if(channel != NULL)
+		g_io_channel_unref(channel);
+	g_main_loop_unref(pd.loop);
+}
+
+static gboolean _pipe_on_can_read(GIOChannel * channel,
+		GIOCondition condition, gpointer data)
+{
+	struct pipe_data * pd = data;
+	char buf[BUFSIZ];
+	gsize r;
+	GIOStatus status;
+	(void) condition;
+
+	/* waits until the buffer is full */
+	status = g_io_channel_read_chars(channel, buf, sizeof(buf), &r, NULL);
+	if(status == G_IO_STATUS_AGAIN)
+		return TRUE;
+	pd->size += r;
+	if(status == G_IO_STATUS_NORMAL)
+		return TRUE;
+	g_main_loop_quit(pd->loop);
+	return FALSE;
+}
+
+static gboolean _pipe_on_read(char const * buf, size_t len,
+		GError const * error, gpointer data)
+{
+	struct pipe_data * pd = data;
+	(void) error;
+
+	if(buf == NULL)
+		g_main_loop_quit(pd->loop);
+	else
+		pd->size += len;
+	return TRUE;
+}
+
+static gboolean _pipe_on_tick(gpointer data)
+{
+	struct pipe_data * pd = data;
+	gint64 now;
+
+	/* the longest time without a frame */
+	now = g_get_monotonic_time();
+	pd->stall = MAX(pd->stall, now - pd->tick);
+	pd->tick = now;
+	return TRUE;
+}
+
+static gpointer _pipe_writer(gpointer data)
+{
+	struct pipe_data * pd = data;
+	char buf[BENCH_READER_WRITE];
+	size_t i;
+	ssize_t w;
+
+	for(i = 0; i < sizeof(buf); i++)
+		buf[i] = (i % 64 == 63) ? '\n' : 'a' + i % 26;
+	for(i = 0; i < BENCH_READER_SIZE; i += w)
+	{
+		if((w = write(pd->fd, buf, MIN(sizeof(buf),
+							BENCH_READER_SIZE - i)))
+				< 0)
+			break;
+		g_usleep(BENCH_READER_DELAY);
+	}
+	close(pd->fd);
+	return NULL;
+}
@@ -33,5 +33,16 @@
 #include "../src/builders.c"
 #include "../src/callbacks.c"
 #include "../src/common.c"
+#include "../src/exec.c"
+#include "../src/feed.c"
+#include "../src/gaugeparser.c"
+#include "../src/gaugepipe.c"
+#include "../src/gaugewatch.c"
 #include "../src/gbsddialog.c"
+#include "../src/library.c"
 #include "../src/main.c"
+#include "../src/menuindex.c"
+#include "../src/menumodel.c"
+#include "../src/output.c"
+#include "../src/reader.c"
+#include "../src/textmap.c"
@@ -0,0 +1,430 @@
+/* gbsddialog */
+/* units.c */
+/*-
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2023-2024 The FreeBSD Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+
+#include <sys/types.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "../src/feed.c"
+#include "../src/gaugeparser.c"
+#include "../src/textmap.c"
+
+
+/* units */
+/* private */
+/* types */
+typedef struct _Unit
+{
+	char const * name;
+	int (*callback)(void);
+} Unit;
+
+
+/* constants */
+#define UNITS_FEED_LINES	10000
+#define UNITS_FEED_APPEND	1000		/* bytes per append */
+#define UNITS_FLUSH_MAX		100000		/* guards against hangs */
+#define UNITS_TEXTMAP_LINES	200
+#define UNITS_TEXTMAP_INDEX	7		/* bytes indexed at a time */
+
+
+/* prototypes */
+static int _units_error(char const * unit, char const * format, ...);
+
+static int _unit_feed(void);
+static int _unit_gaugeparser(void);
+static int _unit_textmap(void);
+
+
+/* variables */
+static const Unit _units[] =
+{
+	{ "feed",		_unit_feed		},
+	{ "gaugeparser",	_unit_gaugeparser	},
+	{ "textmap",		_unit_textmap		}
+};
+
+
+/* functions */
+/* main */
+int main(void)
+{
+	int ret = 0;
+	int r;
+	size_t i;
+
+	for(i = 0; i < sizeof(_units) / sizeof(*_units); i++)
+	{
+		r = _units[i].callback();
+		printf("%s: %s\n", _units[i].name, (r == 0) ? "PASS" : "FAIL");
+		ret += r;
+	}
+	return (ret == 0) ? 0 : 2;
+}
+
+
+/* units_error */
+static int _units_error(char const * unit, char const * format, ...)
+{
+	va_list ap;
+
+	fprintf(stderr, "%s: ", unit);
+	va_start(ap, format);
+	vfprintf(stderr, format, ap);
+	va_end(ap);
+	fputc('\n', stderr);
+	return 1;
+}
+
+
+/* units */
+/* unit_feed */
+static int _feed_flush(Feed * feed);
+static size_t _feed_on_commit(char const * buf, size_t len, gboolean last,
+		gpointer data);
+
+static int _unit_feed(void)
+{
+	int ret = 0;
+	Feed * feed;
+	GString * input;
+	GString * output;
+	size_t i, len;
+
+	/* committed in complete lines, whatever the size of the appends */
+	input = g_string_new(NULL);
+	for(i = 0; i < UNITS_FEED_LINES; i++)
+		g_string_append_printf(input, "line %lu\n", (unsigned long)i);
+	g_string_append(input, "tail");
+	output = g_string_new(NULL);
+	feed = feed_new(_feed_on_commit, output);
+	for(i = 0; i < input->len; i += len)
+	{
+		len = MIN(UNITS_FEED_APPEND, input->len - i);
+		feed_append(feed, &input->str[i], len);
+		feed_flush(feed);
+		if(output->len > 0 && output->str[output->len - 1] != '\n')
+			ret += _units_error("feed", "incomplete line committed");
+	}
+	feed_close(feed);
+	ret += _feed_flush(feed);
+	if(output->len != input->len
+			|| memcmp(output->str, input->str, input->len) != 0)
+		ret += _units_error("feed", "%lu bytes committed out of %lu",
+				(unsigned long)output->len,
+				(unsigned long)input->len);
+	feed_delete(feed);
+	/* the backlog is full until half of it is committed */
+	g_string_truncate(input, 0);
+	while(input->len < FEED_FULL)
+		g_string_append(input, "a line of the backlog\n");
+	g_string_truncate(output, 0);
+	feed = feed_new(_feed_on_commit, output);
+	feed_append(feed, input->str, input->len);
+	if(feed_is_full(feed) == FALSE)
+		ret += _units_error("feed", "not full with %lu bytes pending",
+				(unsigned long)feed_get_pending(feed));
+	ret += _feed_flush(feed);
+	if(feed_is_full(feed) || feed_get_pending(feed) != 0)
+		ret += _units_error("feed", "%lu bytes left pending",
+				(unsigned long)feed_get_pending(feed));
+	feed_delete(feed);
+	/* even with a single line, before the end of the data */
+	g_string_truncate(input, 0);
+	while(input->len < FEED_FULL)
+		g_string_append(input, "a line without end ");
+	g_string_truncate(output, 0);
+	feed = feed_new(_feed_on_commit, output);
+	feed_append(feed, input->str, input->len);
+	ret += _feed_flush(feed);
+	if(output->len != input->len)
+		ret += _units_error("feed", "%lu bytes committed out of %lu",
+				(unsigned long)output->len,
+				(unsigned long)input->len);
+	feed_delete(feed);
+	g_string_free(input, TRUE);
+	g_string_free(output, TRUE);
+	return ret;
+}
+
+static int _feed_flush(Feed * feed)
+{
+	size_t i;
+
+	for(i = 0; i < UNITS_FLUSH_MAX && feed_get_pending(feed) > 0; i++)
+		feed_flush(feed);
+	return (i < UNITS_FLUSH_MAX) ? 0 : _units_error("feed",
+			"%lu bytes cannot be committed",
+			(unsigned long)feed_get_pending(feed));
+}
+
+static size_t _feed_on_commit(char const * buf, size_t len, gboolean last,
+		gpointer data)
+{
+	GString * output = data;
+	size_t i;
+
+	/* up to the last line, unless no more data follows */
+	for(i = len; last == FALSE && i > 0 && buf[i - 1] != '\n'; i--);
+	g_string_append_len(output, buf, i);
+	return i;
+}
+
+
+/* unit_gaugeparser */
+static gchar * _gaugeparser_state(GaugeParser * parser, unsigned int changes);
+static int _gaugeparser_split(GaugeParserMode mode, int msglen,
+		char const * input, char const * expected);
+
+static int _unit_gaugeparser(void)
+{
+	int ret = 0;
+
+	ret += _gaugeparser_split(GPM_GAUGE, 0, "XXX\n45\nHello\nworld\nXXX\n"
+			"XXX\n80\nBye\nXXX\nXXX\n90\nlast", "90|last|3");
+	ret += _gaugeparser_split(GPM_GAUGE_COMPACT, 0, "P 45\nT Hello\n"
+			"A world\nP 120\nT Bye\nA again\nD\nP 10\n",
+			"100|Bye\nagain|7");
+	ret += _gaugeparser_split(GPM_MIXEDGAUGE, 0, "I 10 one\nI 20 two\n"
+			"I 30 one\nR two\nI 40 three\nP 50\n",
+			"50||one=30|three=40|9");
+	ret += _gaugeparser_split(GPM_PROGRESS, 5, "Hello..\n12\n....\n 7",
+			"7|Hello|3");
+	return ret;
+}
+
+static gchar * _gaugeparser_state(GaugeParser * parser, unsigned int changes)
+{
+	GString * state;
+	char const * label;
+	int percentage;
+	unsigned int i;
+
+	/* the percentage, the text, the items and the changes */
+	state = g_string_new(NULL);
+	g_string_append_printf(state, "%u|%s",
+			gaugeparser_get_percentage(parser),
+			gaugeparser_get_text(parser));
+	for(i = 0; (label = gaugeparser_get_item(parser, i, &percentage))
+			!= NULL; i++)
+		g_string_append_printf(state, "|%s=%d", label, percentage);
+	g_string_append_printf(state, "|%x", changes);
+	return g_string_free(state, FALSE);
+}
+
+static int _gaugeparser_split(GaugeParserMode mode, int msglen,
+		char const * input, char const * expected)
+{
+	int ret = 0;
+	GaugeParser * parser;
+	size_t len, i, j;
+	unsigned int changes;
+	gchar * state;
+
+	/* split at every byte, then fed a byte at a time */
+	len = strlen(input);
+	for(i = 0; i <= len + 1; i++)
+	{
+		parser = gaugeparser_new(mode, NULL, msglen);
+		if(i <= len)
+		{
+			changes = gaugeparser_feed(parser, input, i);
+			changes |= gaugeparser_feed(parser, &input[i],
+					len - i);
+		}
+		else
+			for(j = 0, changes = 0; j < len; j++)
+				changes |= gaugeparser_feed(parser, &input[j],
+						1);
+		changes |= gaugeparser_flush(parser);
+		state = _gaugeparser_state(parser, changes);
+		if(strcmp(state, expected) != 0)
+			ret += _units_error("gaugeparser",
+					"mode %d split at %lu: \"%s\" instead"
+					" of \"%s\"", mode, (unsigned long)i,
+					state, expected);
+		g_free(state);
+		gaugeparser_delete(parser);
+	}
+	return ret;
+}
+
+
+/* unit_textmap */
+static int _textmap_handover(int fd);
+static int _textmap_index(int fd);
+static int _textmap_split(void);
+static int _textmap_text(TextMap * tm, size_t first, size_t last,
+		char const * expected);
+
+static int _unit_textmap(void)
+{
+	int ret = 0;
+	int fd;
+	gchar * filename;
+	GString * text;
+	size_t i;
+
+	if((fd = g_file_open_tmp(NULL, &filename, NULL)) < 0)
+		return _units_error("textmap", "could not create a file");
+	/* the last line is not terminated */
+	text = g_string_new(NULL);
+	for(i = 0; i < UNITS_TEXTMAP_LINES; i++)
+		g_string_append_printf(text, "line %lu\n", (unsigned long)i);
+	g_string_append(text, "last");
+	if(write(fd, text->str, text->len) != (ssize_t)text->len)
+		ret += _units_error("textmap", "could not write the file");
+	else
+	{
+		ret += _textmap_index(fd);
+		ret += _textmap_handover(fd);
+	}
+	g_string_free(text, TRUE);
+	close(fd);
+	unlink(filename);
+	g_free(filename);
+	ret += _textmap_split();
+	return ret;
+}
+
+static int _textmap_handover(int fd)
+{
+	int ret = 0;
+	TextMap * tm;
+	TextMap * indexer;
+
+	/* indexed by another map and handed over, as by the Reader */
+	if((tm = textmap_new(fd)) == NULL)
+		return _units_error("textmap", "could not map the file");
+	if((indexer = textmap_new(fd)) == NULL)
+	{
+		textmap_delete(tm);
+		return _units_error("textmap", "could not map the file");
+	}
+	while(textmap_index(indexer, 100) == FALSE)
+		textmap_add_index(tm, textmap_take_index(indexer),
+				textmap_get_lines(indexer));
+	textmap_add_index(tm, textmap_take_index(indexer),
+			textmap_get_lines(indexer));
+	ret += _textmap_text(tm, 127, 129, "line 127\nline 128\n");
+	ret += _textmap_text(tm, 200, 201, "last");
+	textmap_delete(indexer);
+	/* no longer accessed once truncated */
+	if(textmap_is_truncated(tm))
+		ret += _units_error("textmap", "truncated too early");
+	if(ftruncate(fd, 0) != 0 || !textmap_is_truncated(tm))
+		ret += _units_error("textmap", "truncation missed");
+	textmap_delete(tm);
+	return ret;
+}
+
+static int _textmap_index(int fd)
+{
+	int ret = 0;
+	TextMap * tm;
+
+	if((tm = textmap_new(fd)) == NULL)
+		return _units_error("textmap", "could not map the file");
+	/* a few bytes at a time */
+	while(textmap_index(tm, UNITS_TEXTMAP_INDEX) == FALSE);
+	if(textmap_get_lines(tm) != UNITS_TEXTMAP_LINES + 1)
+		ret += _units_error("textmap", "%lu lines instead of %u",
+				(unsigned long)textmap_get_lines(tm),
+				UNITS_TEXTMAP_LINES + 1);
+	ret += _textmap_text(tm, 0, 1, "line 0\n");
+	ret += _textmap_text(tm, 63, 66, "line 63\nline 64\nline 65\n");
+	ret += _textmap_text(tm, 199, 300, "line 199\nlast");
+	textmap_delete(tm);
+	return ret;
+}
+
+static int _textmap_split(void)
+{
+	int ret = 0;
+	int fd;
+	gchar * filename;
+	GString * text;
+	GString * expected;
+	TextMap * tm;
+	size_t i;
+
+	if((fd = g_file_open_tmp(NULL, &filename, NULL)) < 0)
+		return _units_error("textmap", "could not create a file");
+	/* a line of 10000 bytes is split in three */
+	text = g_string_new(NULL);
+	expected = g_string_new(NULL);
+	for(i = 0; i < 10000; i++)
+	{
+		g_string_append_c(text, 'a' + i % 26);
+		g_string_append_c(expected, 'a' + i % 26);
+		if(i + 1 == TEXTMAP_LINE_MAX || i + 1 == TEXTMAP_LINE_MAX * 2)
+			g_string_append_c(expected, '\n');
+	}
+	g_string_append(text, "\nend");
+	g_string_append(expected, "\nend");
+	if(write(fd, text->str, text->len) != (ssize_t)text->len)
+		ret += _units_error("textmap", "could not write the file");
+	else if((tm = textmap_new(fd)) == NULL)
+		ret += _units_error("textmap", "could not map the file");
+	else
+	{
+		while(textmap_index(tm, UNITS_TEXTMAP_INDEX * 1000) == FALSE);
+		if(textmap_get_lines(tm) != 4)
+			ret += _units_error("textmap", "%lu lines instead of 4",
+					(unsigned long)textmap_get_lines(tm));
+		ret += _textmap_text(tm, 0, 4, expected->str);
+		g_string_truncate(expected, expected->len - 3);
+		ret += _textmap_text(tm, 2, 3, &expected->str[
+				(TEXTMAP_LINE_MAX + 1) * 2]);
+		textmap_delete(tm);
+	}
+	g_string_free(text, TRUE);
+	g_string_free(expected, TRUE);
+	close(fd);
+	unlink(filename);
+	g_free(filename);
+	return ret;
+}
+
+static int _textmap_text(TextMap * tm, size_t first, size_t last,
+		char const * expected)
+{
+	char const * text;
+	size_t len;
+
+	text = textmap_get_text(tm, first, last, &len);
+	if(len != strlen(expected) || memcmp(text, expected, len) != 0)
+		return _units_error("textmap", "lines %lu to %lu: \"%.*s\""
+				" instead of \"%s\"", (unsigned long)first,
+				(unsigned long)last, (int)len, text, expected);
+	return 0;
+}
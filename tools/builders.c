@@ -34,6 +34,17 @@
 #endif
 
 #include "../src/callbacks.c"
+#include "../src/exec.c"
+#include "../src/feed.c"
+#include "../src/gaugeparser.c"
+#include "../src/gaugepipe.c"
+#include "../src/gaugewatch.c"
+#include "../src/liststore.c"
+#include "../src/menuindex.c"
+#include "../src/menumodel.c"
+#include "../src/output.c"
+#include "../src/reader.c"
+#include "../src/textmap.c"
 #include "../src/builders.c"
 
 
@@ -43,10 +54,12 @@ struct buildlist_data
 {
 	/* left treeview */
 	GtkListStore * lstore;
+	GtkWidget * lview;
 	GtkTreeSelection * ltreesel;
 
 	/* right treeview */
 	GtkListStore * rstore;
+	GtkWidget * rview;
 	GtkTreeSelection * rtreesel;
 };
 
@@ -57,9 +70,10 @@ struct progress_data
 	GtkWidget * label;
 	GtkWidget * widget;	/* progress bar */
 	guint id;
-	unsigned int count;
 	unsigned int maxdots;
-	int msglen;
+	GaugeParser * parser;
+	unsigned int changes;	/* not rendered yet */
+	guint frame;
 };
 
 struct logbox_data
@@ -67,12 +81,16 @@ struct logbox_data
 	struct options const * opt;
 
 	char const * filename;
-	int fd;
+	Exec * exec;
+	gboolean eof;		/* the command completed */
 	GtkWidget * dialog;
 	GtkListStore * store;
 	GtkWidget * view;
 	guint id;
-	GIOChannel * channel;
+	Reader * reader;
+	gboolean done;		/* everything was read */
+	Feed * feed;		/* read but not listed yet */
+	guint frame;
 };
 
 
@@ -188,7 +206,17 @@ int builder_2inputsbox(struct bsddialog_conf const * conf,
 	{
 		case BSDDIALOG_EXTRA:
 		case BSDDIALOG_OK:
-			dprintf(opt->output_fd, "%s%s%s\n",
+			if(opt->result != NULL)
+			{
+				output_value(opt->result,
+						gtk_entry_buffer_get_text(
+							buffer1));
+				output_value(opt->result,
+						gtk_entry_buffer_get_text(
+							buffer2));
+				break;
+			}
+			output_dprintf(opt->output_fd, "%s%s%s\n",
 					gtk_entry_buffer_get_text(buffer1), sep,
 					gtk_entry_buffer_get_text(buffer2));
 			break;
@@ -285,7 +313,13 @@ int builder_2rangesbox(struct bsddialog_conf const * conf,
 	{
 		case BSDDIALOG_EXTRA:
 		case BSDDIALOG_OK:
-			dprintf(opt->output_fd, "%d%s%d\n",
+			if(opt->result != NULL)
+			{
+				output_value_printf(opt->result, "%d", value1);
+				output_value_printf(opt->result, "%d", value2);
+				break;
+			}
+			output_dprintf(opt->output_fd, "%d%s%d\n",
 					value1, sep, value2);
 			break;
 	}
@@ -380,7 +414,13 @@ int builder_2spinsbox(struct bsddialog_conf const * conf,
 	{
 		case BSDDIALOG_EXTRA:
 		case BSDDIALOG_OK:
-			dprintf(opt->output_fd, "%d%s%d\n",
+			if(opt->result != NULL)
+			{
+				output_value_printf(opt->result, "%d", value1);
+				output_value_printf(opt->result, "%d", value2);
+				break;
+			}
+			output_dprintf(opt->output_fd, "%d%s%d\n",
 					value1, sep, value2);
 			break;
 	}
@@ -509,7 +549,20 @@ int builder_3inputsbox(struct bsddialog_conf const * conf,
 	{
 		case BSDDIALOG_EXTRA:
 		case BSDDIALOG_OK:
-			dprintf(opt->output_fd, "%s%s%s%s%s\n",
+			if(opt->result != NULL)
+			{
+				output_value(opt->result,
+						gtk_entry_buffer_get_text(
+							buffer1));
+				output_value(opt->result,
+						gtk_entry_buffer_get_text(
+							buffer2));
+				output_value(opt->result,
+						gtk_entry_buffer_get_text(
+							buffer3));
+				break;
+			}
+			output_dprintf(opt->output_fd, "%s%s%s%s%s\n",
 					gtk_entry_buffer_get_text(buffer1), sep,
 					gtk_entry_buffer_get_text(buffer2), sep,
 					gtk_entry_buffer_get_text(buffer3));
@@ -635,7 +688,14 @@ int builder_3rangesbox(struct bsddialog_conf const * conf,
 	{
 		case BSDDIALOG_EXTRA:
 		case BSDDIALOG_OK:
-			dprintf(opt->output_fd, "%d%s%d%s%d\n",
+			if(opt->result != NULL)
+			{
+				output_value_printf(opt->result, "%d", value1);
+				output_value_printf(opt->result, "%d", value2);
+				output_value_printf(opt->result, "%d", value3);
+				break;
+			}
+			output_dprintf(opt->output_fd, "%d%s%d%s%d\n",
 					value1, sep, value2, sep, value3);
 			break;
 	}
@@ -754,7 +814,14 @@ int builder_3spinsbox(struct bsddialog_conf const * conf,
 	{
 		case BSDDIALOG_EXTRA:
 		case BSDDIALOG_OK:
-			dprintf(opt->output_fd, "%d%s%d%s%d\n",
+			if(opt->result != NULL)
+			{
+				output_value_printf(opt->result, "%d", value1);
+				output_value_printf(opt->result, "%d", value2);
+				output_value_printf(opt->result, "%d", value3);
+				break;
+			}
+			output_dprintf(opt->output_fd, "%d%s%d%s%d\n",
 					value1, sep, value2, sep, value3);
 			break;
 	}
@@ -763,9 +830,12 @@ int builder_3spinsbox(struct bsddialog_conf const * conf,
 
 
 /* builder_buildlist */
-static void _buildlist_convert_rows(GtkTreeModel * model, GList * rows);
+static void _buildlist_move(struct buildlist_data * bd, gboolean add,
+		gboolean all);
 static void _buildlist_on_add(gpointer data);
+static void _buildlist_on_add_all(gpointer data);
 static void _buildlist_on_remove(gpointer data);
+static void _buildlist_on_remove_all(gpointer data);
 
 int builder_buildlist(struct bsddialog_conf const * conf,
 		char const * text, int rows, int cols,
@@ -786,6 +856,7 @@ int builder_buildlist(struct bsddialog_conf const * conf,
 	gchar * p;
 	int i, j = 3, k, n;
 	char const * sep = "";
+	Output * output;
 
 	if(opt->item_bottomdesc == true)
 		j++;
@@ -806,14 +877,26 @@ int builder_buildlist(struct bsddialog_conf const * conf,
 #else
 	hbox = gtk_hbox_new(FALSE, BORDER_WIDTH);
 #endif
-	/* left treeview */
-	window = gtk_scrolled_window_new(NULL, NULL);
+	/* fill the data before attaching the models */
 	bd.lstore = gtk_list_store_new(BLS_COUNT, G_TYPE_STRING, G_TYPE_STRING,
 			G_TYPE_STRING);
-	widget = gtk_tree_view_new();
+	bd.rstore = gtk_list_store_new(BLS_COUNT, G_TYPE_STRING, G_TYPE_STRING,
+			G_TYPE_STRING);
+	for(i = 0; (i + 1) * j < argc; i++)
+	{
+		k = i * j + 1;
+		store = (strcmp(argv[k + 2], "on") == 0)
+			? bd.rstore : bd.lstore;
+		gtk_list_store_insert_with_values(store, &iter, -1,
+				BLS_ITEM, argv[k], BLS_NAME, argv[k + 1],
+				opt->item_bottomdesc ? BLS_TOOLTIP : -1,
+				argv[k + 3], -1);
+	}
+	/* left treeview */
+	window = gtk_scrolled_window_new(NULL, NULL);
+	widget = gtk_tree_view_new_with_model(GTK_TREE_MODEL(bd.lstore));
+	bd.lview = widget;
 	gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(widget), FALSE);
-	gtk_tree_view_set_model(GTK_TREE_VIEW(widget),
-			GTK_TREE_MODEL(bd.lstore));
 	if(opt->item_bottomdesc)
 		gtk_tree_view_set_tooltip_column(GTK_TREE_VIEW(widget),
 				BLS_TOOLTIP);
@@ -839,15 +922,20 @@ int builder_buildlist(struct bsddialog_conf const * conf,
 	g_signal_connect_swapped(widget, "clicked",
 			G_CALLBACK(_buildlist_on_remove), &bd);
 	gtk_box_pack_start(GTK_BOX(vbox), widget, FALSE, TRUE, 0);
+	widget = gtk_button_new_with_label("Add all");
+	g_signal_connect_swapped(widget, "clicked",
+			G_CALLBACK(_buildlist_on_add_all), &bd);
+	gtk_box_pack_start(GTK_BOX(vbox), widget, FALSE, TRUE, 0);
+	widget = gtk_button_new_with_label("Remove all");
+	g_signal_connect_swapped(widget, "clicked",
+			G_CALLBACK(_buildlist_on_remove_all), &bd);
+	gtk_box_pack_start(GTK_BOX(vbox), widget, FALSE, TRUE, 0);
 	gtk_box_pack_start(GTK_BOX(hbox), vbox, FALSE, TRUE, 0);
 	/* right treeview */
 	window = gtk_scrolled_window_new(NULL, NULL);
-	bd.rstore = gtk_list_store_new(BLS_COUNT, G_TYPE_STRING, G_TYPE_STRING,
-			G_TYPE_STRING);
-	widget = gtk_tree_view_new();
+	widget = gtk_tree_view_new_with_model(GTK_TREE_MODEL(bd.rstore));
+	bd.rview = widget;
 	gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(widget), FALSE);
-	gtk_tree_view_set_model(GTK_TREE_VIEW(widget),
-			GTK_TREE_MODEL(bd.rstore));
 	if(opt->item_bottomdesc)
 		gtk_tree_view_set_tooltip_column(GTK_TREE_VIEW(widget),
 				BLS_TOOLTIP);
@@ -860,19 +948,6 @@ int builder_buildlist(struct bsddialog_conf const * conf,
 	gtk_container_add(GTK_CONTAINER(window), widget);
 	gtk_box_pack_start(GTK_BOX(hbox), window, TRUE, TRUE, 0);
 	gtk_box_pack_start(GTK_BOX(container), hbox, TRUE, TRUE, 0);
-	/* fill the data */
-	for(i = 0; (i + 1) * j < argc; i++)
-	{
-		k = i * j + 1;
-		store = (strcmp(argv[k + 2], "on") == 0)
-			? bd.rstore : bd.lstore;
-		gtk_list_store_append(store, &iter);
-		gtk_list_store_set(store, &iter, BLS_ITEM, argv[k],
-				BLS_NAME, argv[k + 1], -1);
-		if(opt->item_bottomdesc == true)
-			gtk_list_store_set(store, &iter,
-					BLS_TOOLTIP, argv[k + 3], -1);
-	}
 	gtk_widget_show_all(container);
 	_builder_dialog_buttons(dialog, conf, NULL);
 	ret = _builder_dialog_run(conf, dialog);
@@ -880,6 +955,7 @@ int builder_buildlist(struct bsddialog_conf const * conf,
 	{
 		case BSDDIALOG_EXTRA:
 		case BSDDIALOG_OK:
+			output = output_new(opt->output_fd);
 			for(valid = gtk_tree_model_get_iter_first(
 						GTK_TREE_MODEL(bd.rstore),
 						&iter); valid == TRUE;
@@ -889,97 +965,75 @@ int builder_buildlist(struct bsddialog_conf const * conf,
 			{
 				gtk_tree_model_get(GTK_TREE_MODEL(bd.rstore),
 						&iter, BLS_ITEM, &p, -1);
-				dprintf(opt->output_fd, "%s%s", sep, p);
+				if(opt->result != NULL)
+				{
+					output_value(opt->result, p);
+					g_free(p);
+					continue;
+				}
+				output_string(output, sep);
+				output_string(output, p);
 				sep = (opt->item_output_sep != NULL)
 					? opt->item_output_sep : "/";
 				g_free(p);
 			}
-			if(strlen(sep) > 0)
-				dprintf(opt->output_fd, "\n");
+			if(opt->result == NULL && strlen(sep) > 0)
+				output_string(output, "\n");
+			output_delete(output);
 			break;
 	}
 	gtk_widget_destroy(dialog);
 	return ret;
 }
 
-static void _buildlist_convert_rows(GtkTreeModel * model, GList * rows)
+static void _buildlist_move(struct buildlist_data * bd, gboolean add,
+		gboolean all)
 {
-	GList * row;
-	GtkTreeRowReference * ref;
+	GtkTreeSelection * treesel = add ? bd->ltreesel : bd->rtreesel;
+	GList * rows = NULL;
 
-	for(row = rows; row != NULL; row = row->next)
-	{
-		ref = gtk_tree_row_reference_new(model, row->data);
-		gtk_tree_path_free(row->data);
-		row->data = ref;
-	}
+	/* the selected rows are sorted */
+	if(all == FALSE && (rows = gtk_tree_selection_get_selected_rows(
+					treesel, NULL)) == NULL)
+		return;
+	if(add)
+		liststore_move(bd->lstore, bd->rstore, rows,
+				GTK_TREE_VIEW(bd->lview),
+				GTK_TREE_VIEW(bd->rview));
+	else
+		liststore_move(bd->rstore, bd->lstore, rows,
+				GTK_TREE_VIEW(bd->rview),
+				GTK_TREE_VIEW(bd->lview));
+	g_list_foreach(rows, (GFunc)gtk_tree_path_free, NULL);
+	g_list_free(rows);
 }
 
 static void _buildlist_on_add(gpointer data)
 {
 	struct buildlist_data * bd = data;
-	GList * rows, * row;
-	GtkTreePath * path;
-	GtkTreeIter iter;
-	gchar * item;
-	gchar * name;
-	gchar * help;
 
-	rows = gtk_tree_selection_get_selected_rows(bd->ltreesel, NULL);
-	_buildlist_convert_rows(GTK_TREE_MODEL(bd->lstore), rows);
-	for(row = rows; row != NULL; row = row->next)
-	{
-		if((path = gtk_tree_row_reference_get_path(row->data)) == NULL)
-			continue;
-		gtk_tree_model_get_iter(GTK_TREE_MODEL(bd->lstore), &iter,
-				path);
-		gtk_tree_path_free(path);
-		gtk_tree_model_get(GTK_TREE_MODEL(bd->lstore), &iter,
-				BLS_ITEM, &item, BLS_NAME, &name,
-				BLS_TOOLTIP, &help, -1);
-		gtk_list_store_remove(bd->lstore, &iter);
-		gtk_list_store_append(bd->rstore, &iter);
-		gtk_list_store_set(bd->rstore, &iter, BLS_ITEM, item,
-				BLS_NAME, name, BLS_TOOLTIP, help, -1);
-		g_free(item);
-		g_free(name);
-		g_free(help);
-	}
-	g_list_foreach(rows, (GFunc)gtk_tree_row_reference_free, NULL);
-	g_list_free(rows);
+	_buildlist_move(bd, TRUE, FALSE);
+}
+
+static void _buildlist_on_add_all(gpointer data)
+{
+	struct buildlist_data * bd = data;
+
+	_buildlist_move(bd, TRUE, TRUE);
 }
 
 static void _buildlist_on_remove(gpointer data)
 {
 	struct buildlist_data * bd = data;
-	GList * rows, * row;
-	GtkTreePath * path;
-	GtkTreeIter iter;
-	gchar * item;
-	gchar * name;
-	gchar * help;
 
-	rows = gtk_tree_selection_get_selected_rows(bd->rtreesel, NULL);
-	_buildlist_convert_rows(GTK_TREE_MODEL(bd->rstore), rows);
-	for(row = rows; row != NULL; row = row->next)
-	{
-		path = gtk_tree_row_reference_get_path(row->data);
-		gtk_tree_model_get_iter(GTK_TREE_MODEL(bd->rstore), &iter,
-				path);
-		gtk_tree_path_free(path);
-		gtk_tree_model_get(GTK_TREE_MODEL(bd->rstore), &iter,
-				BLS_ITEM, &item, BLS_NAME, &name,
-				BLS_TOOLTIP, &help, -1);
-		gtk_list_store_remove(bd->rstore, &iter);
-		gtk_list_store_append(bd->lstore, &iter);
-		gtk_list_store_set(bd->lstore, &iter, BLS_ITEM, item,
-				BLS_NAME, name, BLS_TOOLTIP, help, -1);
-		g_free(item);
-		g_free(name);
-		g_free(help);
-	}
-	g_list_foreach(rows, (GFunc)gtk_tree_row_reference_free, NULL);
-	g_list_free(rows);
+	_buildlist_move(bd, FALSE, FALSE);
+}
+
+static void _buildlist_on_remove_all(gpointer data)
+{
+	struct buildlist_data * bd = data;
+
+	_buildlist_move(bd, FALSE, TRUE);
 }
 
 
@@ -1066,15 +1120,29 @@ int builder_colorsel(struct bsddialog_conf const * conf,
 					GTK_COLOR_SELECTION(widget), &color);
 #endif
 #if GTK_CHECK_VERSION(3, 0, 0)
-			dprintf(opt->output_fd, "%.0f %.0f %.0f\n",
-					color.red * 255.0,
-					color.green * 255.0,
-					color.blue * 255.0);
+			if(opt->result != NULL)
+				output_value_printf(opt->result,
+						"%.0f %.0f %.0f",
+						color.red * 255.0,
+						color.green * 255.0,
+						color.blue * 255.0);
+			else
+				output_dprintf(opt->output_fd,
+						"%.0f %.0f %.0f\n",
+						color.red * 255.0,
+						color.green * 255.0,
+						color.blue * 255.0);
 #else
-			dprintf(opt->output_fd, "%u %u %u\n",
-					color.red / 256,
-					color.green / 256,
-					color.blue / 256);
+			if(opt->result != NULL)
+				output_value_printf(opt->result, "%u %u %u",
+						color.red / 256,
+						color.green / 256,
+						color.blue / 256);
+			else
+				output_dprintf(opt->output_fd, "%u %u %u\n",
+						color.red / 256,
+						color.green / 256,
+						color.blue / 256);
 #endif
 			break;
 	}
@@ -1121,7 +1189,10 @@ int builder_combobox(struct bsddialog_conf const * conf,
 					GTK_COMBO_BOX_TEXT(widget));
 			if(p == NULL)
 				break;
-			dprintf(opt->output_fd, "%s\n", p);
+			if(opt->result != NULL)
+				output_value(opt->result, p);
+			else
+				output_dprintf(opt->output_fd, "%s\n", p);
 			g_free(p);
 			break;
 	}
@@ -1164,6 +1235,13 @@ int builder_editbox(struct bsddialog_conf const * conf,
 	td.scroll = FALSE;
 	td.button = NULL;
 	td.filename = text;
+	td.exec = NULL;
+	td.eof = FALSE;
+	td.reader = NULL;
+	td.done = FALSE;
+	td.feed = NULL;
+	td.frame = 0;
+	td.map = NULL;
 	td.dialog = _builder_dialog(conf, opt, NULL, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	container = gtk_dialog_get_content_area(GTK_DIALOG(td.dialog));
@@ -1237,6 +1315,8 @@ int builder_editbox(struct bsddialog_conf const * conf,
 	ret = _builder_dialog_run(conf, td.dialog);
 	if(td.id != 0)
 		g_source_remove(td.id);
+	if(td.frame != 0)
+		_builder_dialog_frame_cancel(td.view, td.frame);
 	switch(ret)
 	{
 		case BSDDIALOG_EXTRA:
@@ -1244,9 +1324,15 @@ int builder_editbox(struct bsddialog_conf const * conf,
 			_editbox_print(opt, td.buffer);
 			break;
 	}
+	if(td.reader != NULL)
+		reader_delete(td.reader);
 	gtk_widget_destroy(td.dialog);
+	if(td.feed != NULL)
+		feed_delete(td.feed);
 	if(desc != NULL)
 		pango_font_description_free(desc);
+	if(td.exec != NULL)
+		ret = _builder_dialog_exec_wait(td.exec, td.eof, ret);
 	return ret;
 }
 
@@ -1259,7 +1345,10 @@ static void _editbox_print(struct options const * opt, GtkTextBuffer * buffer)
 	gtk_text_buffer_get_start_iter(buffer, &start);
 	gtk_text_buffer_get_end_iter(buffer, &end);
 	p = gtk_text_buffer_get_text(buffer, &start, &end, FALSE);
-	dprintf(opt->output_fd, "%s\n", p);
+	if(opt->result != NULL)
+		output_value(opt->result, p);
+	else
+		output_dprintf(opt->output_fd, "%s\n", p);
 	g_free(p);
 }
 
@@ -1310,7 +1399,10 @@ int builder_fontsel(struct bsddialog_conf const * conf,
 			p = gtk_font_selection_get_font_name(
 					GTK_FONT_SELECTION(widget));
 #endif
-			dprintf(opt->output_fd, "%s\n", p);
+			if(opt->result != NULL)
+				output_value(opt->result, p);
+			else
+				output_dprintf(opt->output_fd, "%s\n", p);
 			g_free(p);
 			break;
 	}
@@ -1330,10 +1422,12 @@ int builder_fselect(struct bsddialog_conf const * conf,
 
 
 /* builder_logbox */
-static gboolean _logbox_on_can_read(GIOChannel * channel,
-		GIOCondition condition, gpointer data);
-static gboolean _logbox_on_can_read_eof(gpointer data);
+static size_t _logbox_on_feed(char const * buf, size_t len, gboolean last,
+		gpointer data);
+static gboolean _logbox_on_frame(gpointer data);
 static gboolean _logbox_on_idle(gpointer data);
+static gboolean _logbox_on_read(char const * buf, size_t len,
+		GError const * error, gpointer data);
 
 int builder_logbox(struct bsddialog_conf const * conf,
 		char const * text, int rows, int cols,
@@ -1353,6 +1447,12 @@ int builder_logbox(struct bsddialog_conf const * conf,
 	}
 	ld.opt = opt;
 	ld.filename = text;
+	ld.exec = NULL;
+	ld.eof = FALSE;
+	ld.reader = NULL;
+	ld.done = FALSE;
+	ld.feed = NULL;
+	ld.frame = 0;
 	ld.dialog = _builder_dialog(conf, opt, NULL, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	container = gtk_dialog_get_content_area(GTK_DIALOG(ld.dialog));
@@ -1400,103 +1500,158 @@ int builder_logbox(struct bsddialog_conf const * conf,
 	ret = _builder_dialog_run(conf, ld.dialog);
 	if(ld.id != 0)
 		g_source_remove(ld.id);
+	if(ld.frame != 0)
+		_builder_dialog_frame_cancel(ld.view, ld.frame);
+	if(ld.reader != NULL)
+		reader_delete(ld.reader);
 	gtk_widget_destroy(ld.dialog);
+	if(ld.feed != NULL)
+		feed_delete(ld.feed);
+	if(ld.exec != NULL)
+		ret = _builder_dialog_exec_wait(ld.exec, ld.eof, ret);
 	return ret;
 }
 
-static gboolean _logbox_on_can_read(GIOChannel * channel,
-		GIOCondition condition, gpointer data)
+static size_t _logbox_on_feed(char const * buf, size_t len, gboolean last,
+		gpointer data)
 {
 	struct logbox_data * ld = data;
-	GIOStatus status;
+	char const * p;
+	char const * q;
+	size_t l;
+	size_t n;
 	gchar * line;
-	gsize r;
-	GError * error = NULL;
 	GtkTreeIter iter;
 
-#ifdef DEBUG
-	fprintf(stderr, "DEBUG: %s()\n", __func__);
-#endif
-	if(condition != G_IO_IN)
+	for(p = buf; p < &buf[len]; p += l)
 	{
-		_builder_dialog_error(ld->dialog, NULL, NULL,
-				"Unexpected condition");
-		return _logbox_on_can_read_eof(ld);
-	}
-	status = g_io_channel_read_line(channel, &line, NULL, &r, &error);
-	if(status == G_IO_STATUS_ERROR)
-	{
-		_builder_dialog_error(ld->dialog, NULL, NULL, error->message);
-		g_error_free(error);
-		return _logbox_on_can_read_eof(ld);
+		if((q = memchr(p, '\n', &buf[len] - p)) != NULL)
+			l = q - p + 1;
+		else if(last)
+			/* the last line may not be terminated */
+			l = &buf[len] - p;
+		else
+			break;
+		n = (q != NULL) ? l - 1 : l;
+		if(n > 0 && p[n - 1] == '\r')
+			n--;
+		line = g_strndup(p, n);
+		if(ld->opt->reverse)
+			gtk_list_store_insert(GTK_LIST_STORE(ld->store), &iter,
+					0);
+		else
+			gtk_list_store_append(GTK_LIST_STORE(ld->store), &iter);
+		/* FIXME determine the timestamp */
+		gtk_list_store_set(GTK_LIST_STORE(ld->store), &iter, 0, "",
+				1, line, -1);
+		g_free(line);
 	}
-	else if(status == G_IO_STATUS_AGAIN)
-		return TRUE;
-	else if(status == G_IO_STATUS_EOF)
-		return _logbox_on_can_read_eof(ld);
-	line[r] = '\0';
-	if(ld->opt->reverse)
-		gtk_list_store_insert(GTK_LIST_STORE(ld->store), &iter, 0);
-	else
-		gtk_list_store_append(GTK_LIST_STORE(ld->store), &iter);
-	/* FIXME determine the timestamp */
-	gtk_list_store_set(GTK_LIST_STORE(ld->store), &iter, 0, "", 1, line,
-			-1);
-	g_free(line);
-	return TRUE;
+	return p - buf;
 }
 
-static gboolean _logbox_on_can_read_eof(gpointer data)
+static gboolean _logbox_on_frame(gpointer data)
 {
 	struct logbox_data * ld = data;
+	gboolean more;
 
-#ifdef DEBUG
-	fprintf(stderr, "DEBUG: %s()\n", __func__);
-#endif
-	ld->id = 0;
+	more = feed_flush(ld->feed);
+	if(!ld->done && !feed_is_full(ld->feed))
+		reader_resume(ld->reader);
+	if(more)
+		return TRUE;
+	ld->frame = 0;
 	return FALSE;
 }
 
 static gboolean _logbox_on_idle(gpointer data)
 {
 	struct logbox_data * ld = data;
-	char buf[BUFSIZ];
-	gboolean close = TRUE;
+	GError * error = NULL;
 
 	ld->id = 0;
-	if(strcmp(ld->filename, "-") == 0)
+	ld->feed = feed_new(_logbox_on_feed, ld);
+	/* the file is a command to run instead */
+	if(ld->opt->textbox_exec)
 	{
-		ld->fd = STDIN_FILENO;
-		close = FALSE;
+		if((ld->exec = _builder_dialog_exec(ld->filename, TRUE, ld->opt,
+						&error)) == NULL)
+		{
+			_builder_dialog_error(ld->dialog, NULL, NULL,
+					error->message);
+			g_error_free(error);
+			gtk_dialog_response(GTK_DIALOG(ld->dialog),
+					BSDDIALOG_ERROR);
+			return FALSE;
+		}
+		ld->reader = reader_new_fd(exec_get_fd(ld->exec), TRUE,
+				_logbox_on_read, ld);
 	}
-	else if((ld->fd = open(ld->filename, O_RDONLY)) <= -1)
+	else if(strcmp(ld->filename, "-") == 0)
+		ld->reader = reader_new_fd(STDIN_FILENO, FALSE,
+				_logbox_on_read, ld);
+	else
+		/* opened and read in a thread */
+		ld->reader = reader_new_file(ld->filename, 0, _logbox_on_read,
+				NULL, ld);
+	if(ld->reader == NULL)
 	{
-		snprintf(buf, sizeof(buf), "%s: %s", ld->filename,
-				strerror(errno));
-		_builder_dialog_error(ld->dialog, NULL, NULL, buf);
+		_builder_dialog_error(ld->dialog, NULL, NULL,
+				"Could not start reading");
 		gtk_dialog_response(GTK_DIALOG(ld->dialog), BSDDIALOG_ERROR);
-		ld->id = 0;
-		return FALSE;
 	}
-	ld->channel = g_io_channel_unix_new(ld->fd);
-	g_io_channel_set_close_on_unref(ld->channel, close);
-	g_io_channel_set_encoding(ld->channel, NULL, NULL);
-	/* XXX ignore errors */
-	g_io_channel_set_flags(ld->channel, g_io_channel_get_flags(ld->channel)
-			| G_IO_FLAG_NONBLOCK, NULL);
-	ld->id = g_io_add_watch(ld->channel, G_IO_IN, _logbox_on_can_read, ld);
 	return FALSE;
 }
 
+static gboolean _logbox_on_read(char const * buf, size_t len,
+		GError const * error, gpointer data)
+{
+	struct logbox_data * ld = data;
+	char const * p = buf;
+
+	if(buf == NULL)
+	{
+		ld->done = TRUE;
+		if(error != NULL)
+		{
+			_builder_dialog_error(ld->dialog, NULL, NULL,
+					error->message);
+			/* nothing could be read at all */
+			if(gtk_tree_model_iter_n_children(GTK_TREE_MODEL(
+							ld->store), NULL) == 0
+					&& feed_get_pending(ld->feed) == 0)
+				gtk_dialog_response(GTK_DIALOG(ld->dialog),
+						BSDDIALOG_ERROR);
+		}
+		else if(ld->exec != NULL)
+		{
+			/* the last line may be incomplete */
+			if((p = exec_filter(ld->exec, NULL, 0, &len)) != NULL)
+				feed_append(ld->feed, p, len);
+			ld->eof = TRUE;
+		}
+		/* the rest is listed by the next frames */
+		feed_close(ld->feed);
+	}
+	else
+	{
+		if(ld->exec != NULL)
+			p = exec_filter(ld->exec, buf, len, &len);
+		/* listed within the time budget of the next frames */
+		feed_append(ld->feed, p, len);
+	}
+	if(ld->frame == 0)
+		ld->frame = _builder_dialog_frame(ld->view, _logbox_on_frame,
+				ld);
+	/* paused until enough is listed */
+	return feed_is_full(ld->feed) ? FALSE : TRUE;
+}
+
 
 /* builder_progress */
 static gboolean _progress_on_can_read(GIOChannel * channel,
 		GIOCondition condition, gpointer data);
-static void _progress_on_can_read_append(struct progress_data * pd, char * buf,
-		gsize * len);
 static gboolean _progress_on_can_read_eof(gpointer data);
-static void _progress_on_can_read_skip(struct progress_data * pd, char * buf,
-		gsize * len);
+static gboolean _progress_on_frame(gpointer data);
 static void _progress_set_percentage(struct progress_data * pd,
 		unsigned int perc);
 
@@ -1505,7 +1660,8 @@ int builder_progress(struct bsddialog_conf const * conf,
 		int argc, char const ** argv, struct options const * opt)
 {
 	int ret;
-	struct progress_data pd = { NULL, NULL, NULL, NULL, 0, 0, 0, 0 };
+	struct progress_data pd = { NULL, NULL, NULL, NULL, 0, 0, NULL, 0, 0 };
+	int msglen = 0;
 	GtkWidget * container;
 	GIOChannel * channel;
 
@@ -1518,10 +1674,11 @@ int builder_progress(struct bsddialog_conf const * conf,
 		return BSDDIALOG_ERROR;
 	}
 	if(argc == 2)
-		pd.msglen = strtol(argv[1], NULL, 10);
+		msglen = strtol(argv[1], NULL, 10);
 	if(argc >= 1)
 		pd.maxdots = strtoul(argv[0], NULL, 10);
 	pd.opt = opt;
+	pd.parser = gaugeparser_new(GPM_PROGRESS, NULL, msglen);
 	pd.dialog = _builder_dialog(conf, opt, NULL, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	container = gtk_dialog_get_content_area(GTK_DIALOG(pd.dialog));
@@ -1567,7 +1724,10 @@ int builder_progress(struct bsddialog_conf const * conf,
 	ret = _builder_dialog_run(conf, pd.dialog);
 	if(pd.id != 0)
 		g_source_remove(pd.id);
+	if(pd.frame != 0)
+		_builder_dialog_frame_cancel(pd.widget, pd.frame);
 	gtk_widget_destroy(pd.dialog);
+	gaugeparser_delete(pd.parser);
 	return ret;
 }
 
@@ -1576,11 +1736,8 @@ static gboolean _progress_on_can_read(GIOChannel * channel,
 {
 	struct progress_data * pd = data;
 	GIOStatus status;
-	char buf[BUFSIZ + 1];
-	gsize r;
+	unsigned int changes = GPC_NONE;
 	GError * error = NULL;
-	char * p;
-	unsigned int perc;
 
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s()\n", __func__);
@@ -1591,63 +1748,23 @@ static gboolean _progress_on_can_read(GIOChannel * channel,
 				"Unexpected condition");
 		return _progress_on_can_read_eof(pd);
 	}
-	if((status = g_io_channel_read_chars(channel, buf, sizeof(buf) - 1,
-					&r, &error)) == G_IO_STATUS_ERROR)
+	if((status = gaugeparser_read(pd->parser, channel, &changes, &error))
+			== G_IO_STATUS_ERROR)
 	{
 		_builder_dialog_error(pd->dialog, NULL, NULL, error->message);
 		g_error_free(error);
 		return _progress_on_can_read_eof(pd);
 	}
-	else if(status == G_IO_STATUS_AGAIN)
-		return TRUE;
-	else if(status == G_IO_STATUS_EOF)
+	/* the widgets are only updated once per frame */
+	pd->changes |= changes;
+	if(pd->changes != GPC_NONE && pd->frame == 0)
+		pd->frame = _builder_dialog_frame(pd->widget,
+				_progress_on_frame, pd);
+	if(status == G_IO_STATUS_EOF)
 		return _progress_on_can_read_eof(pd);
-	buf[r] = '\0';
-	_progress_on_can_read_skip(pd, buf, &r);
-	_progress_on_can_read_append(pd, buf, &r);
-#ifdef DEBUG
-	fprintf(stderr, "DEBUG: %s() buf=\"%s\"\n", __func__, buf);
-#endif
-	for(p = buf; p[0] != '\0'; p++)
-	{
-#ifdef DEBUG
-		fprintf(stderr, "DEBUG: %s() \"%s\"\n", __func__, p);
-#endif
-		if(sscanf(p, "%u", &perc) == 1)
-			/* set the current percentage */
-			_progress_set_percentage(pd, perc);
-		else
-		{
-			pd->count += r;
-			_progress_set_percentage(pd, pd->count);
-			break;
-		}
-		if((p = strchr(p, '\n')) == NULL)
-			break;
-	}
 	return TRUE;
 }
 
-static void _progress_on_can_read_append(struct progress_data * pd, char * buf,
-		gsize * len)
-{
-	gsize max;
-	char c;
-
-	if(pd->msglen <= 0)
-		return;
-	max = (*len > (gsize)pd->msglen) ? (gsize)pd->msglen : *len;
-	/* set the current text */
-	c = buf[max];
-	buf[max] = '\0';
-	/* FIXME append to the text instead */
-	gtk_label_set_text(GTK_LABEL(pd->label), buf);
-	buf[max] = c;
-	*len -= max;
-	memmove(buf, &buf[max], *len + 1);
-	pd->msglen -= max;
-}
-
 static gboolean _progress_on_can_read_eof(gpointer data)
 {
 	struct progress_data * pd = data;
@@ -1661,17 +1778,20 @@ static gboolean _progress_on_can_read_eof(gpointer data)
 	return FALSE;
 }
 
-static void _progress_on_can_read_skip(struct progress_data * pd, char * buf,
-		gsize * len)
+static gboolean _progress_on_frame(gpointer data)
 {
-	gsize max;
+	struct progress_data * pd = data;
 
-	if(pd->msglen >= 0)
-		return;
-	max = (*len > (gsize)-pd->msglen) ? (gsize)-pd->msglen : *len;
-	*len -= max;
-	memmove(buf, &buf[max], *len + 1);
-	pd->msglen += max;
+	if(pd->changes & GPC_PERCENTAGE)
+		_progress_set_percentage(pd,
+				gaugeparser_get_percentage(pd->parser));
+	/* the message is only ever appended to */
+	if((pd->changes & GPC_TEXT) && pd->label != NULL)
+		gtk_label_set_text(GTK_LABEL(pd->label),
+				gaugeparser_get_text(pd->parser));
+	pd->changes = GPC_NONE;
+	pd->frame = 0;
+	return FALSE;
 }
 
 static void _progress_set_percentage(struct progress_data * pd,
@@ -1682,9 +1802,8 @@ static void _progress_set_percentage(struct progress_data * pd,
 
 	perc = MIN(perc, pd->maxdots);
 	fraction = (gdouble)perc / (gdouble)pd->maxdots;
-	gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(pd->widget), fraction);
 	snprintf(buf, sizeof(buf), "%.0f %%", fraction * 100);
-	gtk_progress_bar_set_text(GTK_PROGRESS_BAR(pd->widget), buf);
+	_builder_dialog_progress(pd->widget, fraction, buf);
 }
 
 
@@ -1710,6 +1829,13 @@ int builder_tailbox(struct bsddialog_conf const * conf,
 	td.scroll = TRUE;
 	td.button = NULL;
 	td.filename = text;
+	td.exec = NULL;
+	td.eof = FALSE;
+	td.reader = NULL;
+	td.done = FALSE;
+	td.feed = NULL;
+	td.frame = 0;
+	td.map = NULL;
 	td.dialog = _builder_dialog(conf, opt, NULL, rows, cols);
 #if GTK_CHECK_VERSION(2, 14, 0)
 	container = gtk_dialog_get_content_area(GTK_DIALOG(td.dialog));
@@ -1780,9 +1906,17 @@ int builder_tailbox(struct bsddialog_conf const * conf,
 	ret = _builder_dialog_run(conf, td.dialog);
 	if(td.id != 0)
 		g_source_remove(td.id);
+	if(td.frame != 0)
+		_builder_dialog_frame_cancel(td.view, td.frame);
+	if(td.reader != NULL)
+		reader_delete(td.reader);
 	gtk_widget_destroy(td.dialog);
+	if(td.feed != NULL)
+		feed_delete(td.feed);
 	if(desc != NULL)
 		pango_font_description_free(desc);
+	if(td.exec != NULL)
+		ret = _builder_dialog_exec_wait(td.exec, td.eof, ret);
 	return ret;
 }
 
@@ -1827,7 +1961,11 @@ static int _builder_dialog_fselect(struct bsddialog_conf const * conf,
 		case BSDDIALOG_OK:
 			p = gtk_file_chooser_get_filename(
 					GTK_FILE_CHOOSER(widget));
-			dprintf(opt->output_fd, "%s\n", (p != NULL) ? p : "");
+			if(opt->result != NULL)
+				output_value(opt->result, (p != NULL) ? p : "");
+			else
+				output_dprintf(opt->output_fd, "%s\n",
+						(p != NULL) ? p : "");
 			g_free(p);
 			break;
 	}